@@ -0,0 +1,895 @@
+// PaperBench runs a set of parameterised micro and macro benchmarks over
+// the DOM, geometry and SVG hot paths of Paper and prints the results as JSON.
+// It does not need a window or GPU, so it can run headless on CI machines.
+//
+// usage: PaperBench [--filter <substring>] [--max-size <n>] [--min-time <ms>]
+//                   [--svg <file>]... [--out <file>] [--quick]
+
+#include <Paper/Document.hpp>
+#include <Paper/Path.hpp>
+#include <Paper/Group.hpp>
+#include <Paper/Segment.hpp>
+#include <Paper/CurveLocation.hpp>
+#include <Paper/DisplayList.hpp>
+#include <Paper/Private/Allocator.hpp>
+#include <Paper/Raster/RasterRenderer.hpp>
+
+#include <Stick/FileUtilities.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+using namespace paper;
+using namespace brick;
+using namespace crunch;
+using namespace stick;
+
+// we count every allocation that goes through the global operator new as well as
+// every allocation that goes through the allocator of the hub/document that is benchmarked.
+static std::atomic<UInt64> s_allocationCount(0);
+static std::atomic<UInt64> s_allocatedBytes(0);
+
+void * operator new(std::size_t _byteCount)
+{
+    s_allocationCount++;
+    s_allocatedBytes += _byteCount;
+    void * ret = std::malloc(_byteCount ? _byteCount : 1);
+    if (!ret)
+        std::abort();
+    return ret;
+}
+
+void * operator new[](std::size_t _byteCount)
+{
+    return operator new(_byteCount);
+}
+
+void operator delete(void * _ptr) noexcept
+{
+    std::free(_ptr);
+}
+
+void operator delete[](void * _ptr) noexcept
+{
+    std::free(_ptr);
+}
+
+namespace
+{
+    class CountingAllocator : public Allocator
+    {
+    public:
+
+        mem::Block allocate(Size _byteCount, Size _alignment) override
+        {
+            s_allocationCount++;
+            s_allocatedBytes += _byteCount;
+            return m_alloc.allocate(_byteCount, _alignment);
+        }
+
+        void deallocate(const mem::Block & _block) override
+        {
+            m_alloc.deallocate(_block);
+        }
+
+    private:
+
+        paper::detail::DefaultPaperAllocator m_alloc;
+    };
+
+    struct AllocationStats
+    {
+        UInt64 count;
+        UInt64 bytes;
+    };
+
+    AllocationStats allocationStats()
+    {
+        return {s_allocationCount.load(), s_allocatedBytes.load()};
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    UInt64 nanosecondsSince(Clock::time_point _start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+    }
+
+    // writes _str as the contents of a JSON string, names can contain file paths
+    void writeJSONEscaped(FILE * _out, const char * _str)
+    {
+        for (; *_str; ++_str)
+        {
+            unsigned char c = *_str;
+            if (c == '"' || c == '\\')
+                std::fprintf(_out, "\\%c", c);
+            else if (c < 0x20)
+                std::fprintf(_out, "\\u%04x", c);
+            else
+                std::fputc(c, _out);
+        }
+    }
+
+    // small deterministic random number generator so that runs are comparable
+    class Random
+    {
+    public:
+
+        Random(UInt32 _seed = 1) :
+            m_state(_seed)
+        {
+        }
+
+        Float randomf(Float _min, Float _max)
+        {
+            m_state = m_state * 1664525u + 1013904223u;
+            return _min + (_max - _min) * ((m_state >> 8) / (Float)(1 << 24));
+        }
+
+    private:
+
+        UInt32 m_state;
+    };
+
+    struct Settings
+    {
+        const char * filter = nullptr;
+        Size maxSize = 1000000;
+        UInt64 minTimeNs = 250000000;
+        UInt64 maxIterations = 1000000;
+        DynamicArray<String> svgFiles;
+        const char * outputPath = nullptr;
+    };
+
+    class Bench
+    {
+    public:
+
+        Bench(const Settings & _settings, FILE * _out) :
+            m_settings(_settings),
+            m_out(_out),
+            m_count(0)
+        {
+            std::fprintf(m_out, "{\n    \"benchmarks\": [");
+        }
+
+        ~Bench()
+        {
+            std::fprintf(m_out, "\n    ]\n}\n");
+        }
+
+        bool shouldRun(Size _size) const
+        {
+            return _size <= m_settings.maxSize;
+        }
+
+        bool shouldRun(const String & _name, Size _size, Size _maxSize) const
+        {
+            if (_size > m_settings.maxSize || _size > _maxSize)
+                return false;
+            return !m_settings.filter || std::strstr(_name.cString(), m_settings.filter);
+        }
+
+        // Runs _op in batches until at least the minimum time has passed. Use this for
+        // operations that can be repeated without resetting any state.
+        template<class Op>
+        void measure(const String & _name, Size _size, Size _maxSize, Op _op)
+        {
+            measureImpl(_name, _size, _maxSize, [] {}, _op, true);
+        }
+
+        // Same as measure but calls _setup (untimed) before every single invocation of _op.
+        template<class Setup, class Op>
+        void measure(const String & _name, Size _size, Size _maxSize, Setup _setup, Op _op)
+        {
+            measureImpl(_name, _size, _maxSize, _setup, _op, false);
+        }
+
+    private:
+
+        template<class Setup, class Op>
+        void measureImpl(const String & _name, Size _size, Size _maxSize, Setup _setup, Op & _op, bool _bBatch)
+        {
+            if (!shouldRun(_name, _size, _maxSize))
+                return;
+
+            UInt64 iterations = 0;
+            UInt64 ns = 0;
+            UInt64 allocs = 0;
+            UInt64 bytes = 0;
+            UInt64 batch = 1;
+
+            // warm up caches and lazily computed data
+            _setup();
+            _op();
+
+            while (ns < m_settings.minTimeNs && iterations < m_settings.maxIterations)
+            {
+                if (!_bBatch)
+                    _setup();
+
+                AllocationStats before = allocationStats();
+                auto start = Clock::now();
+                for (UInt64 i = 0; i < batch; ++i)
+                    _op();
+                ns += nanosecondsSince(start);
+                AllocationStats after = allocationStats();
+
+                allocs += after.count - before.count;
+                bytes += after.bytes - before.bytes;
+                iterations += batch;
+
+                if (_bBatch && ns < m_settings.minTimeNs / 10)
+                    batch *= 2;
+            }
+
+            std::fprintf(m_out, "%s\n        {\"name\": \"", m_count++ ? "," : "");
+            writeJSONEscaped(m_out, _name.cString());
+            std::fprintf(m_out, "\", \"size\": %llu, \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.2f}",
+                         (unsigned long long)_size,
+                         (unsigned long long)iterations,
+                         (double)ns / iterations,
+                         (double)allocs / iterations,
+                         (double)bytes / iterations);
+            std::fflush(m_out);
+        }
+
+        const Settings & m_settings;
+        FILE * m_out;
+        Size m_count;
+    };
+
+    // a closed, wavy path with curved segments roughly on a circle
+    Path createWavyPath(Document & _doc, Size _segmentCount, Random & _rnd)
+    {
+        Path ret = _doc.createPath();
+        Float step = Constants<Float>::twoPi() / _segmentCount;
+        Float rad = 500;
+        Float handleLength = rad * step * 0.33;
+        for (Size i = 0; i < _segmentCount; ++i)
+        {
+            Float angle = step * i;
+            Float r = rad + _rnd.randomf(-rad * 0.1, rad * 0.1);
+            Vec2f dir(std::cos(angle), std::sin(angle));
+            Vec2f tangent(-dir.y, dir.x);
+            ret.addSegment(dir * r, -tangent * handleLength, tangent * handleLength);
+        }
+        ret.closePath();
+        return ret;
+    }
+
+    // a closed polygon that zig zags around a circle, which intersects itself a lot
+    Path createZigZagPath(Document & _doc, Size _segmentCount, Random & _rnd)
+    {
+        Path ret = _doc.createPath();
+        Float step = Constants<Float>::twoPi() / _segmentCount;
+        for (Size i = 0; i < _segmentCount; ++i)
+        {
+            Float angle = step * i + _rnd.randomf(-step, step) * 2.0;
+            Float r = i % 2 ? 500 : 250;
+            ret.addPoint(Vec2f(std::cos(angle), std::sin(angle)) * r);
+        }
+        ret.closePath();
+        return ret;
+    }
+
+    Group createGroupWithChildren(Document & _doc, Size _childCount, Random & _rnd)
+    {
+        Group ret = _doc.createGroup();
+        for (Size i = 0; i < _childCount; ++i)
+        {
+            Vec2f pos(_rnd.randomf(0, 10000), _rnd.randomf(0, 10000));
+            ret.addChild(_doc.createRectangle(pos, pos + Vec2f(_rnd.randomf(1, 100), _rnd.randomf(1, 100))));
+        }
+        return ret;
+    }
+
+    void addScene(Document & _doc, Size _pathCount, Size _segmentsPerPath, Random & _rnd)
+    {
+        _doc.setSize(1000, 1000);
+        for (Size i = 0; i < _pathCount; ++i)
+        {
+            Path p = createWavyPath(_doc, _segmentsPerPath, _rnd);
+            p.translateTransform(_rnd.randomf(0, 1000), _rnd.randomf(0, 1000));
+            p.setFill(ColorRGBA(_rnd.randomf(0, 1), _rnd.randomf(0, 1), _rnd.randomf(0, 1), 1.0));
+            p.setStroke(ColorRGBA(0, 0, 0, 1));
+            p.setStrokeWidth(2.0);
+        }
+    }
+
+    String svgForPaths(Size _pathCount, Size _segmentsPerPath)
+    {
+        Hub hub;
+        Document doc = createDocument(hub);
+        Random rnd;
+        addScene(doc, _pathCount, _segmentsPerPath, rnd);
+        return doc.exportSVG().ensure();
+    }
+
+    void runPathBenchmarks(Bench & _bench, const DynamicArray<Size> & _sizes)
+    {
+        for (Size n : _sizes)
+        {
+            if (!_bench.shouldRun(n))
+                break;
+
+            CountingAllocator alloc;
+            Hub hub(alloc);
+            Document doc = createDocument(hub);
+            Random rnd;
+
+            Path built;
+            _bench.measure("Path.addSegment", n, 1000000, [&]
+            {
+                if (built.isValid())
+                    built.remove();
+            }, [&]
+            {
+                built = doc.createPath();
+                Float step = Constants<Float>::twoPi() / n;
+                for (Size i = 0; i < n; ++i)
+                    built.addSegment(Vec2f(std::cos(step * i), std::sin(step * i)) * 100.0f, Vec2f(-1, 0), Vec2f(1, 0));
+            });
+            if (built.isValid())
+                built.remove();
+
+            if (_bench.shouldRun("Path.addSegments", n, 1000000))
+            {
+                DynamicArray<Vec2f> positions;
+                positions.reserve(n);
+                Float step = Constants<Float>::twoPi() / n;
+                for (Size i = 0; i < n; ++i)
+                    positions.append(Vec2f(std::cos(step * i), std::sin(step * i)) * 100.0f);
+
+                _bench.measure("Path.addSegments", n, 1000000, [&]
+                {
+                    if (built.isValid())
+                        built.remove();
+                }, [&]
+                {
+                    built = doc.createPath();
+                    built.addSegments(&positions[0], n);
+                });
+                if (built.isValid())
+                    built.remove();
+            }
+
+            Path wavy = createWavyPath(doc, n, rnd);
+            Size segIndex = 0;
+            _bench.measure("Path.bounds", n, 1000000, [&]
+            {
+                // move a segment to invalidate the cached bounds
+                Segment seg = wavy.segment(segIndex++ % n);
+                seg.setPosition(seg.position() + Vec2f(0.01, 0.0));
+                wavy.bounds();
+            });
+
+            _bench.measure("Path.strokeBounds", n, 1000000, [&]
+            {
+                wavy.setStrokeWidth(segIndex++ % 2 ? 2.0 : 4.0);
+                wavy.strokeBounds();
+            });
+
+            // rotates back and forth so the path keeps its extent
+            Size turn = 0;
+            _bench.measure("Path.rotate", n, 1000000, [&]
+            {
+                wavy.rotate(turn++ % 2 ? 0.1f : -0.1f, Vec2f(0, 0));
+            });
+
+            _bench.measure("Path.length", n, 1000000, [&]
+            {
+                Segment seg = wavy.segment(segIndex++ % n);
+                seg.setPosition(seg.position() + Vec2f(0.01, 0.0));
+                wavy.length();
+            });
+
+            Float offset = 0;
+            wavy.length();
+            _bench.measure("Path.curveLocationAt", n, 1000000, [&]
+            {
+                offset += 97.0;
+                if (offset > wavy.length())
+                    offset = 0;
+                wavy.curveLocationAt(offset);
+            });
+
+            Vec2f pt(0, 0);
+            _bench.measure("Path.contains", n, 1000000, [&]
+            {
+                pt.x += 13.7;
+                if (pt.x > 600)
+                    pt.x = -600;
+                wavy.contains(pt);
+            });
+
+            // the same queries as above, 1000 points per call
+            DynamicArray<Vec2f> batch;
+            for (Size i = 0; i < 1000; ++i)
+                batch.append(Vec2f(-600 + (i * 13.7 - std::floor(i * 13.7 / 1200) * 1200), 0));
+            DynamicArray<bool> batchResults;
+            batchResults.resize(batch.count());
+            _bench.measure("Path.containsBatch1000", n, 1000000, [&]
+            {
+                wavy.contains(&batch[0], batch.count(), &batchResults[0]);
+            });
+
+            if (_bench.shouldRun("Path.containsPolygon", n, 1000000))
+            {
+                // a star shaped polyline, like a flattened or imported <polygon>
+                DynamicArray<Vec2f> star;
+                star.reserve(n);
+                Float step = Constants<Float>::twoPi() / n;
+                for (Size i = 0; i < n; ++i)
+                    star.append(Vec2f(std::cos(step * i), std::sin(step * i)) * (i % 2 ? 300.0f : 500.0f));
+                Path polygon = doc.createPath();
+                polygon.addSegments(&star[0], n);
+                polygon.closePath();
+
+                Vec2f ppt(0, 7.3);
+                _bench.measure("Path.containsPolygon", n, 1000000, [&]
+                {
+                    ppt.x += 13.7;
+                    if (ppt.x > 600)
+                        ppt.x = -600;
+                    polygon.contains(ppt);
+                });
+                polygon.remove();
+            }
+
+            if (_bench.shouldRun("Path.containsCombBatch1000", n, 1000000))
+            {
+                // a comb with n teeth, a horizontal line through it crosses about 2n edges
+                DynamicArray<Vec2f> comb;
+                comb.reserve(n * 2);
+                Float width = 1200.0f / n;
+                for (Size i = 0; i < n; ++i)
+                {
+                    comb.append(Vec2f(-600 + i * width, 300));
+                    comb.append(Vec2f(-600 + (i + 0.5f) * width, -300));
+                }
+                Path polygon = doc.createPath();
+                polygon.addSegments(&comb[0], comb.count());
+                polygon.closePath();
+
+                DynamicArray<Vec2f> line;
+                for (Size i = 0; i < 1000; ++i)
+                    line.append(Vec2f(-600 + i * 1.2f, 7.3));
+                DynamicArray<bool> lineResults;
+                lineResults.resize(line.count());
+                _bench.measure("Path.containsCombBatch1000", n, 1000000, [&]
+                {
+                    polygon.contains(&line[0], line.count(), &lineResults[0]);
+                });
+                polygon.remove();
+            }
+
+            // a compound path with one hole per iteration, every child is oriented against its parent
+            Path compound;
+            _bench.measure("Path.addCompoundChildren", n, 100000, [&]
+            {
+                if (compound.isValid())
+                    compound.remove();
+            }, [&]
+            {
+                compound = doc.createRectangle(Vec2f(0, 0), Vec2f(1000, 1000));
+                compound.setWindingRule(WindingRule::NonZero);
+                for (Size i = 0; i < n; ++i)
+                {
+                    Vec2f pos(rnd.randomf(0, 990), rnd.randomf(0, 990));
+                    compound.addChild(doc.createRectangle(pos, pos + Vec2f(5, 5)));
+                }
+            });
+            if (compound.isValid())
+                compound.remove();
+
+            wavy.setStroke(ColorRGBA(0, 0, 0, 1));
+            wavy.setStrokeWidth(4.0);
+            _bench.measure("Path.strokeToPath", n, 100000, [&]
+            {
+                wavy.strokeToPath().remove();
+            });
+
+            // the intersection finding is quadratic, keep the sizes reasonable
+            if (n > 1000)
+                continue;
+
+            Path zigZag = createZigZagPath(doc, n, rnd);
+            _bench.measure("Path.intersections", n, 1000, [&]
+            {
+                zigZag.intersections();
+            });
+
+            Path other = createWavyPath(doc, n, rnd);
+            other.translateTransform(100, 0);
+            _bench.measure("Path.intersectionsWith", n, 1000, [&]
+            {
+                wavy.intersections(other);
+            });
+
+            _bench.measure("Path.unite", n, 1000, [&]
+            {
+                wavy.unite(other).remove();
+            });
+        }
+    }
+
+    void runGroupBenchmarks(Bench & _bench, const DynamicArray<Size> & _sizes)
+    {
+        for (Size n : _sizes)
+        {
+            if (!_bench.shouldRun(n))
+                break;
+
+            CountingAllocator alloc;
+            Hub hub(alloc);
+            Document doc = createDocument(hub);
+            Random rnd;
+
+            Group built;
+            _bench.measure("Group.addChild", n, 1000000, [&]
+            {
+                if (built.isValid())
+                    built.remove();
+            }, [&]
+            {
+                built = createGroupWithChildren(doc, n, rnd);
+            });
+            if (built.isValid())
+                built.remove();
+
+            Group grp = createGroupWithChildren(doc, n, rnd);
+            const ItemArray & children = grp.children();
+            Size childIndex = 0;
+            _bench.measure("Group.bounds", n, 1000000, [&]
+            {
+                // move a child to invalidate the cached bounds
+                Item child = children[childIndex++ % n];
+                child.translateTransform(0.01, 0.0);
+                grp.bounds();
+            });
+
+            _bench.measure("Group.translateTransform", n, 1000000, [&]
+            {
+                grp.translateTransform(0.01, 0.0);
+                Item child = children[childIndex++ % n];
+                child.absoluteTransform();
+            });
+
+            _bench.measure("Group.rotate", n, 1000000, [&]
+            {
+                grp.rotate(childIndex++ % 2 ? 0.1f : -0.1f, Vec2f(0, 0));
+            });
+
+            _bench.measure("Group.clone", n, 100000, [&]
+            {
+                grp.clone().remove();
+            });
+
+            // overlapping footprints on a jittered grid
+            if (_bench.shouldRun("Group.uniteAll", n, 10000) || _bench.shouldRun("Group.uniteSequential", n, 1000))
+            {
+                Group footprints = doc.createGroup();
+                Size columns = (Size)std::ceil(std::sqrt((Float)n));
+                for (Size i = 0; i < n; ++i)
+                {
+                    Vec2f pos((i % columns) * 10 + rnd.randomf(-2, 2), (i / columns) * 10 + rnd.randomf(-2, 2));
+                    footprints.addChild(doc.createRectangle(pos, pos + Vec2f(rnd.randomf(9, 14), rnd.randomf(9, 14))));
+                }
+
+                _bench.measure("Group.uniteAll", n, 10000, [&]
+                {
+                    footprints.uniteAll().remove();
+                });
+
+                // uniting one footprint at a time, for comparison
+                _bench.measure("Group.uniteSequential", n, 1000, [&]
+                {
+                    const ItemArray & fs = footprints.children();
+                    Path result = brick::reinterpretEntity<Path>(fs[0]).clone();
+                    for (Size i = 1; i < fs.count(); ++i)
+                    {
+                        Path next = result.unite(brick::reinterpretEntity<Path>(fs[i]));
+                        result.remove();
+                        result = next;
+                    }
+                    result.remove();
+                });
+                footprints.remove();
+            }
+
+            // the first query builds the spatial index, keep it out of the measurements
+            doc.hitTest(Vec2f(0, 0));
+            _bench.measure("Document.hitTest", n, 1000000, [&]
+            {
+                doc.hitTest(Vec2f(rnd.randomf(0, 10000), rnd.randomf(0, 10000)), 2.0);
+            });
+
+            _bench.measure("Document.hitTestAfterMove", n, 1000000, [&]
+            {
+                Item child = children[childIndex++ % n];
+                child.translateTransform(rnd.randomf(-50, 50), 0.0);
+                doc.hitTest(Vec2f(rnd.randomf(0, 10000), rnd.randomf(0, 10000)), 2.0);
+            });
+
+            // two filled siblings of all the other children under the point, the paint order
+            // decides which one is hit
+            Path lower = doc.createRectangle(Vec2f(-200, -200), Vec2f(-100, -100));
+            Path upper = doc.createRectangle(Vec2f(-150, -150), Vec2f(-50, -50));
+            lower.setFill(ColorRGBA(1, 0, 0, 1));
+            upper.setFill(ColorRGBA(0, 0, 1, 1));
+            grp.addChild(lower);
+            grp.addChild(upper);
+            _bench.measure("Document.hitTestOverlapping", n, 1000000, [&]
+            {
+                doc.hitTest(Vec2f(-125, -125));
+            });
+            lower.remove();
+            upper.remove();
+
+            _bench.measure("Document.itemsIntersecting", n, 1000000, [&]
+            {
+                Vec2f pos(rnd.randomf(0, 9500), rnd.randomf(0, 9500));
+                doc.itemsIntersecting(Rect(pos, pos + Vec2f(500)));
+            });
+        }
+    }
+
+    void runHierarchyBenchmarks(Bench & _bench, const DynamicArray<Size> & _sizes)
+    {
+        for (Size depth : _sizes)
+        {
+            if (!_bench.shouldRun(depth) || depth > 10000)
+                break;
+
+            CountingAllocator alloc;
+            Hub hub(alloc);
+            Document doc = createDocument(hub);
+
+            Group root = doc.createGroup();
+            Item parent = root;
+            for (Size i = 0; i < depth; ++i)
+            {
+                Group grp = doc.createGroup();
+                parent.addChild(grp);
+                grp.translateTransform(1, 0);
+                parent = grp;
+            }
+            Path leaf = doc.createRectangle(Vec2f(0, 0), Vec2f(10, 10));
+            parent.addChild(leaf);
+
+            // deep hierarchies are walked recursively, keep the depth reasonable
+            _bench.measure("Hierarchy.absoluteTransform", depth, 10000, [&]
+            {
+                root.translateTransform(0.01, 0.0);
+                leaf.absoluteTransform();
+            });
+
+            // reads without a transform change in between don't walk up to the root
+            _bench.measure("Hierarchy.absoluteTransformRead", depth, 10000, [&]
+            {
+                leaf.absoluteTransform();
+            });
+
+            _bench.measure("Hierarchy.bounds", depth, 10000, [&]
+            {
+                leaf.translateTransform(0.01, 0.0);
+                root.bounds();
+            });
+
+            // many small edits between two reads of the bounds
+            Float x = 10;
+            _bench.measure("Hierarchy.editSegments", depth, 10000, [&]
+            {
+                for (Size i = 0; i < 100; ++i)
+                    leaf.segment(2).setPosition(Vec2f(x += 0.01, 10));
+                root.bounds();
+            });
+
+            _bench.measure("Hierarchy.editSegmentsBatched", depth, 10000, [&]
+            {
+                doc.beginBatch();
+                for (Size i = 0; i < 100; ++i)
+                    leaf.segment(2).setPosition(Vec2f(x += 0.01, 10));
+                doc.endBatch();
+                root.bounds();
+            });
+        }
+    }
+
+    void runRenderBenchmarks(Bench & _bench, const DynamicArray<Size> & _sizes)
+    {
+        for (Size n : _sizes)
+        {
+            if (!_bench.shouldRun(n) || n > 100000)
+                break;
+
+            if (n <= 1000)
+            {
+                CountingAllocator alloc;
+                Hub hub(alloc);
+                Document doc = createDocument(hub);
+                Random rnd;
+                addScene(doc, n, 16, rnd);
+
+                raster::RasterRenderer renderer;
+                renderer.init(doc);
+                renderer.setViewport(0, 0, 1000, 1000);
+                renderer.setClearColor(ColorRGBA(1, 1, 1, 1));
+                _bench.measure("Raster.draw", n, 10000, [&]
+                {
+                    renderer.draw();
+                });
+
+                renderer.setThreadCount(1);
+                _bench.measure("Raster.drawSingleThread", n, 10000, [&]
+                {
+                    renderer.draw();
+                });
+            }
+
+            // a map of small shapes that is zoomed in on a hundredth of its area, most paths get culled
+            CountingAllocator alloc;
+            Hub hub(alloc);
+            Document doc = createDocument(hub);
+            Random rnd;
+            for (Size i = 0; i < n; ++i)
+            {
+                Path p = doc.createCircle(Vec2f(rnd.randomf(0, 1000), rnd.randomf(0, 1000)), 5);
+                p.setFill(ColorRGBA(rnd.randomf(0, 1), rnd.randomf(0, 1), rnd.randomf(0, 1), 1.0));
+            }
+
+            raster::RasterRenderer renderer;
+            renderer.init(doc);
+            renderer.setViewport(0, 0, 1000, 1000);
+            renderer.setProjection(Mat4f::ortho(450, 550, 550, 450, -1, 1));
+            _bench.measure("Raster.drawZoomed", n, 10000, [&]
+            {
+                renderer.draw();
+            });
+
+            DisplayList list;
+            list.record(doc);
+            _bench.measure("Raster.drawZoomedDisplayList", n, 10000, [&]
+            {
+                renderer.draw(list);
+            });
+
+            // a single moving item per frame only patches its own command
+            Path moving = brick::reinterpretEntity<Path>(doc.children()[n / 2]);
+            _bench.measure("DisplayList.update", n, 100000, [&]
+            {
+                moving.translateTransform(Vec2f(0.01f, 0.0f));
+                list.update();
+            });
+
+            // the edits of a batch reach the list once per item
+            _bench.measure("DisplayList.updateBatched", n, 100000, [&]
+            {
+                doc.beginBatch();
+                for (Size i = 0; i < 100; ++i)
+                    moving.translateTransform(Vec2f(0.01f, 0.0f));
+                doc.endBatch();
+                list.update();
+            });
+        }
+    }
+
+    void runSVGBenchmarks(Bench & _bench, const DynamicArray<Size> & _sizes, const DynamicArray<String> & _files)
+    {
+        for (Size n : _sizes)
+        {
+            if (!_bench.shouldRun(n) || n > 100000)
+                break;
+
+            String svg = svgForPaths(n, 16);
+            CountingAllocator alloc;
+            Hub hub(alloc);
+            Document doc = createDocument(hub);
+            Group imported;
+
+            _bench.measure("SVG.parse", n, 100000, [&]
+            {
+                if (imported.isValid())
+                    imported.remove();
+            }, [&]
+            {
+                imported = doc.parseSVG(svg).group();
+            });
+
+            _bench.measure("SVG.export", n, 100000, [&]
+            {
+                doc.exportSVG();
+            });
+        }
+
+        for (const String & file : _files)
+        {
+            auto res = loadTextFile(file);
+            if (!res)
+            {
+                std::fprintf(stderr, "Could not load SVG file %s: %s\n", file.cString(), res.error().message().cString());
+                continue;
+            }
+
+            String svg = res.get();
+            CountingAllocator alloc;
+            Hub hub(alloc);
+            Document doc = createDocument(hub);
+            Group imported;
+
+            _bench.measure(String::concat("SVG.parse:", file), svg.length(), svg.length(), [&]
+            {
+                if (imported.isValid())
+                    imported.remove();
+            }, [&]
+            {
+                imported = doc.parseSVG(svg).group();
+            });
+
+            _bench.measure(String::concat("SVG.export:", file), svg.length(), svg.length(), [&]
+            {
+                doc.exportSVG();
+            });
+        }
+    }
+}
+
+int main(int _argc, const char * _args[])
+{
+    Settings settings;
+    for (int i = 1; i < _argc; ++i)
+    {
+        bool bHasValue = i + 1 < _argc;
+        if (std::strcmp(_args[i], "--filter") == 0 && bHasValue)
+            settings.filter = _args[++i];
+        else if (std::strcmp(_args[i], "--max-size") == 0 && bHasValue)
+            settings.maxSize = std::strtoull(_args[++i], nullptr, 10);
+        else if (std::strcmp(_args[i], "--min-time") == 0 && bHasValue)
+            settings.minTimeNs = std::strtoull(_args[++i], nullptr, 10) * 1000000;
+        else if (std::strcmp(_args[i], "--svg") == 0 && bHasValue)
+            settings.svgFiles.append(_args[++i]);
+        else if (std::strcmp(_args[i], "--out") == 0 && bHasValue)
+            settings.outputPath = _args[++i];
+        else if (std::strcmp(_args[i], "--quick") == 0)
+        {
+            // smoke test mode for CI, only checks that all scenarios still run
+            settings.maxSize = 1000;
+            settings.minTimeNs = 10000000;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--filter <substring>] [--max-size <n>] [--min-time <ms>] [--svg <file>]... [--out <file>] [--quick]\n", _args[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE * out = stdout;
+    if (settings.outputPath)
+    {
+        out = std::fopen(settings.outputPath, "w");
+        if (!out)
+        {
+            std::fprintf(stderr, "Could not open %s for writing\n", settings.outputPath);
+            return EXIT_FAILURE;
+        }
+    }
+
+    DynamicArray<Size> sizes = {10, 100, 1000, 10000, 100000, 1000000};
+
+    {
+        Bench bench(settings, out);
+        runPathBenchmarks(bench, sizes);
+        runGroupBenchmarks(bench, sizes);
+        runHierarchyBenchmarks(bench, sizes);
+        runRenderBenchmarks(bench, sizes);
+        runSVGBenchmarks(bench, sizes, settings.svgFiles);
+    }
+
+    if (out != stdout)
+        std::fclose(out);
+
+    return EXIT_SUCCESS;
+}
@@ -28,8 +28,102 @@ namespace paper
     using ColorHSBA = crunch::ColorHSBA;
     class Segment;
     class Curve;
-    using SegmentArray = stick::DynamicArray<stick::UniquePtr<Segment>>;
-    using CurveArray = stick::DynamicArray<stick::UniquePtr<Curve>>;
+
+    //the segments of a path are stored as a structure of arrays to keep all
+    //geometry loops on contiguous memory. Segment itself is only a lightweight
+    //view (path + index) into this storage.
+    struct SegmentArray
+    {
+        using PositionArray = stick::DynamicArray<Vec2f>;
+
+        stick::Size count() const
+        {
+            return positions.count();
+        }
+
+        void reserve(stick::Size _count)
+        {
+            positions.reserve(_count);
+            handlesIn.reserve(_count);
+            handlesOut.reserve(_count);
+        }
+
+        void append(const Vec2f & _position, const Vec2f & _handleIn, const Vec2f & _handleOut)
+        {
+            positions.append(_position);
+            handlesIn.append(_handleIn);
+            handlesOut.append(_handleOut);
+        }
+
+        void insert(stick::Size _index, const Vec2f & _position, const Vec2f & _handleIn, const Vec2f & _handleOut)
+        {
+            positions.insert(positions.begin() + _index, _position);
+            handlesIn.insert(handlesIn.begin() + _index, _handleIn);
+            handlesOut.insert(handlesOut.begin() + _index, _handleOut);
+        }
+
+        //appends _count segments from contiguous buffers. The handle buffers
+        //may be nullptr, in which case the handles are zero.
+        void append(const Vec2f * _positions, const Vec2f * _handlesIn,
+                    const Vec2f * _handlesOut, stick::Size _count)
+        {
+            reserve(count() + _count);
+            for (stick::Size i = 0; i < _count; ++i)
+            {
+                positions.append(_positions[i]);
+                handlesIn.append(_handlesIn ? _handlesIn[i] : Vec2f(0.0));
+                handlesOut.append(_handlesOut ? _handlesOut[i] : Vec2f(0.0));
+            }
+        }
+
+        void remove(stick::Size _from, stick::Size _to)
+        {
+            positions.remove(positions.begin() + _from, positions.begin() + _to);
+            handlesIn.remove(handlesIn.begin() + _from, handlesIn.begin() + _to);
+            handlesOut.remove(handlesOut.begin() + _from, handlesOut.begin() + _to);
+        }
+
+        void removeLast()
+        {
+            positions.removeLast();
+            handlesIn.removeLast();
+            handlesOut.removeLast();
+        }
+
+        void clear()
+        {
+            positions.clear();
+            handlesIn.clear();
+            handlesOut.clear();
+        }
+
+        PositionArray positions;
+        PositionArray handlesIn;
+        PositionArray handlesOut;
+    };
+
+    //curves are not stored, but computed on demand from the adjacent segments.
+    //A path only keeps this compact array of cached per curve values around,
+    //indexed by curve index.
+    struct CurveData
+    {
+        CurveData() :
+            length(0),
+            endOffset(0),
+            bLengthCached(false),
+            bBoundsCached(false)
+        {
+        }
+
+        Float length;
+        //the summed length of all curves up to and including this one
+        Float endOffset;
+        Rect bounds;
+        bool bLengthCached;
+        bool bBoundsCached;
+    };
+
+    using CurveArray = stick::DynamicArray<CurveData>;
     using DashArray = stick::DynamicArray<Float>;
 }
 
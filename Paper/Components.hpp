@@ -12,6 +12,8 @@ namespace paper
     class Document;
     class Item;
     using ItemArray = stick::DynamicArray<Item>;
+    struct ItemChange;
+    using ItemChangeArray = stick::DynamicArray<ItemChange>;
 
     namespace comps
     {
@@ -24,9 +26,28 @@ namespace paper
         using Parent = brick::Component<ComponentName("Parent"), Item>;
         using Name = brick::Component<ComponentName("Name"), stick::String>;
         using Children = brick::Component<ComponentName("Children"), ItemArray>;
+        //cached position of the item in the children of its parent. It is only valid as long
+        //as the children of the parent still hold the item at that position.
+        using SiblingIndex = brick::Component<ComponentName("SiblingIndex"), stick::Size>;
         using Transform = brick::Component<ComponentName("Transform"), Mat3f>;
-        using AbsoluteTransform = brick::Component<ComponentName("AbsoluteTransform"), Mat3f>;
-        using AbsoluteTransformDirtyFlag = brick::Component<ComponentName("AbsoluteTransformDirtyFlag"), bool>;
+        //bumped whenever the transform of the item changes or it is moved to a different parent.
+        //Versions are taken from one global, atomic counter, so they never repeat.
+        using TransformVersion = brick::Component<ComponentName("TransformVersion"), stick::UInt64>;
+        //bumped whenever the fill geometry of the item gets marked dirty, taken from the same counter.
+        using GeometryVersion = brick::Component<ComponentName("GeometryVersion"), stick::UInt64>;
+
+        struct AbsoluteTransformData
+        {
+            Mat3f transform;
+            //the highest transform version of the item and its ancestors at the time transform
+            //was computed. If any of them changes, the highest version changes, too.
+            stick::UInt64 version;
+            //the transform version of the document (see DocumentStateData) when version was last
+            //checked against the ancestors. As long as it is the same, the cache is up to date.
+            stick::UInt64 documentVersion;
+        };
+
+        using AbsoluteTransform = brick::Component<ComponentName("AbsoluteTransform"), AbsoluteTransformData>;
         using Fill = brick::Component<ComponentName("Fill"), Paint>;
         using Stroke = brick::Component<ComponentName("Stroke"), Paint>;
         using StrokeWidth = brick::Component<ComponentName("StrokeWidth"), Float>;
@@ -43,12 +64,36 @@ namespace paper
         using VisibilityFlag = brick::Component<ComponentName("VisibilityFlag"), bool>;
         using RemeshOnTransformChange = brick::Component<ComponentName("RemeshOnTransformChange"), bool>;
 
+        struct ResolvedStyleData
+        {
+            bool bDirty;
+            PathStyle style;
+            //assigned from the same counter as TransformVersion whenever style is resolved
+            stick::UInt64 version;
+        };
+
+        using ResolvedStyle = brick::Component<ComponentName("ResolvedStyle"), ResolvedStyleData>;
+
         struct BoundsData
         {
             bool bDirty;
             Rect bounds;
+            //the absolute transform version the bounds were computed for, not used by LocalBounds
+            stick::UInt64 transformVersion;
+        };
+
+        struct BoundsPropagationData
+        {
+            //the bounds epoch of the document (see DocumentStateData) at the time the stroke / fill
+            //bounds of the parents were marked dirty by this item
+            stick::UInt64 strokeEpoch;
+            stick::UInt64 fillEpoch;
+            //set while the item waits for the end of a batch to mark its parents dirty
+            bool bStrokePending;
+            bool bFillPending;
         };
 
+        using BoundsPropagation = brick::Component<ComponentName("BoundsPropagation"), BoundsPropagationData>;
         using HandleBounds = brick::Component<ComponentName("HandleBounds"), BoundsData>;
         using StrokeBounds = brick::Component<ComponentName("StrokeBounds"), BoundsData>;
         using Bounds = brick::Component<ComponentName("Bounds"), BoundsData>;
@@ -62,12 +107,59 @@ namespace paper
             Vec2f scaling;
         };
 
+        struct AbsoluteDecomposedData
+        {
+            DecomposedData decomposed;
+            //the absolute transform version this was decomposed from
+            stick::UInt64 version;
+        };
+
         using DecomposedTransform = brick::Component<ComponentName("DecomposedTransform"), DecomposedData>;
-        using AbsoluteDecomposedTransform = brick::Component<ComponentName("AbsoluteDecomposedTransform"), DecomposedData>;
+        using AbsoluteDecomposedTransform = brick::Component<ComponentName("AbsoluteDecomposedTransform"), AbsoluteDecomposedData>;
 
         //document specific components
         using DocumentSize = brick::Component<ComponentName("DocumentSize"), Vec2f>;
 
+        //counters shared by all items of one document
+        struct DocumentStateData
+        {
+            //bumped whenever a dirty bounds cache of an item gets recomputed. As long as it does
+            //not change, the parents of an item that marked them dirty are still dirty.
+            stick::UInt64 boundsEpoch;
+            //the latest transform version handed to an item of the document
+            stick::UInt64 transformVersion;
+            //true while the document has a comps::Batch, so edits only need one lookup to find out
+            bool bBatchOpen;
+        };
+
+        using DocumentState = brick::Component<ComponentName("DocumentState"), DocumentStateData>;
+
+        struct BatchData
+        {
+            //number of nested beginBatch() calls
+            stick::Size depth;
+            //items that still need to mark the bounds of their parents dirty
+            ItemArray pendingBounds;
+            //the journal, one entry per item that changed during the batch
+            ItemChangeArray changes;
+            //indices of the entries in changes that were not dispatched yet
+            stick::DynamicArray<stick::Size> pendingChanges;
+        };
+
+        //only present while a batch is open
+        using Batch = brick::Component<ComponentName("Batch"), BatchData>;
+
+        struct BatchEntryData
+        {
+            //index of the item in BatchData::changes
+            stick::Size index;
+            //the changes that were not dispatched yet
+            stick::UInt32 pendingFlags;
+        };
+
+        //only present while the item is part of the journal of an open batch
+        using BatchEntry = brick::Component<ComponentName("BatchEntry"), BatchEntryData>;
+
         //group specific components
         using ClippedFlag = brick::Component<ComponentName("ClippedFlag"), bool>;
 
@@ -79,8 +171,17 @@ namespace paper
         {
             bool bDirty;
             Float length;
+            //number of leading curves with an up to date CurveData::endOffset
+            stick::Size validOffsetCount;
         };
         using PathLength = brick::Component<ComponentName("PathLength"), PathLengthData>;
+        struct PathAreaData
+        {
+            bool bDirty;
+            //includes the area of all children
+            Float area;
+        };
+        using PathArea = brick::Component<ComponentName("PathArea"), PathAreaData>;
 
         //type list of all components. Because C++ is shit, we need to manually maintain it
         //as there is no decent way to my knowledge to automatically generate this at compile time.
@@ -91,9 +192,11 @@ namespace paper
                                   Parent,
                                   Name,
                                   Children,
+                                  SiblingIndex,
                                   Transform,
+                                  TransformVersion,
+                                  GeometryVersion,
                                   AbsoluteTransform,
-                                  AbsoluteTransformDirtyFlag,
                                   Fill,
                                   Stroke,
                                   StrokeWidth,
@@ -109,6 +212,8 @@ namespace paper
                                   BoundsGeometryDirtyFlag,
                                   VisibilityFlag,
                                   RemeshOnTransformChange,
+                                  ResolvedStyle,
+                                  BoundsPropagation,
                                   HandleBounds,
                                   StrokeBounds,
                                   Bounds,
@@ -117,11 +222,13 @@ namespace paper
                                   DecomposedTransform,
                                   AbsoluteDecomposedTransform,
                                   DocumentSize,
+                                  DocumentState,
                                   ClippedFlag,
                                   Segments,
                                   Curves,
                                   ClosedFlag,
-                                  PathLength
+                                  PathLength,
+                                  PathArea
                                   >::List;
     }
 }
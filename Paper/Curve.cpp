@@ -5,20 +5,26 @@
 
 namespace paper
 {
-    Curve::Curve()
+    Curve::Curve() :
+        m_index(0)
     {
 
     }
 
-    Curve::Curve(const Path & _path, stick::Size _segmentA, stick::Size _segmentB) :
+    Curve::Curve(const Path & _path, stick::Size _index) :
         m_path(_path),
-        m_segmentA(_segmentA),
-        m_segmentB(_segmentB),
-        m_bLengthCached(false),
-        m_bBoundsCached(false),
-        m_length(0)
+        m_index(_index)
     {
-        m_curve = Bezier(positionOne(), handleOneAbsolute(), handleTwoAbsolute(), positionTwo());
+    }
+
+    bool Curve::operator == (const Curve & _other) const
+    {
+        return m_path == _other.m_path && m_index == _other.m_index;
+    }
+
+    bool Curve::operator != (const Curve & _other) const
+    {
+        return !(*this == _other);
     }
 
     Path Curve::path() const
@@ -26,6 +32,37 @@ namespace paper
         return m_path;
     }
 
+    stick::Size Curve::index() const
+    {
+        return m_index;
+    }
+
+    bool Curve::isValid() const
+    {
+        return m_path.isValid() && m_index < m_path.curveCount();
+    }
+
+    Curve::operator bool() const
+    {
+        return isValid();
+    }
+
+    stick::Size Curve::segmentIndexOne() const
+    {
+        return m_index;
+    }
+
+    stick::Size Curve::segmentIndexTwo() const
+    {
+        //the closing curve of a closed path ends in the first segment
+        return m_index + 1 < m_path.segmentArray().count() ? m_index + 1 : 0;
+    }
+
+    CurveData & Curve::data() const
+    {
+        return const_cast<Path &>(m_path).curveArray()[m_index];
+    }
+
     void Curve::setPositionOne(const Vec2f & _vec)
     {
         segmentOne().setPosition(_vec);
@@ -46,226 +83,178 @@ namespace paper
         segmentTwo().setHandleIn(_vec);
     }
 
-    Segment & Curve::segmentOne()
+    Segment Curve::segmentOne()
     {
-        return *m_path.segmentArray()[m_segmentA];
+        return Segment(m_path, segmentIndexOne());
     }
 
-    const Segment & Curve::segmentOne() const
+    const Segment Curve::segmentOne() const
     {
-        return *m_path.segmentArray()[m_segmentA];
+        return Segment(m_path, segmentIndexOne());
     }
 
-    Segment & Curve::segmentTwo()
+    Segment Curve::segmentTwo()
     {
-        return *m_path.segmentArray()[m_segmentB];
+        return Segment(m_path, segmentIndexTwo());
     }
 
-    const Segment & Curve::segmentTwo() const
+    const Segment Curve::segmentTwo() const
     {
-        return *m_path.segmentArray()[m_segmentB];
+        return Segment(m_path, segmentIndexTwo());
     }
 
-    const Vec2f & Curve::positionOne() const
+    Vec2f Curve::positionOne() const
     {
-        return segmentOne().position();
+        return m_path.segmentArray().positions[segmentIndexOne()];
     }
 
-    const Vec2f & Curve::positionTwo() const
+    Vec2f Curve::positionTwo() const
     {
-        return segmentTwo().position();
+        return m_path.segmentArray().positions[segmentIndexTwo()];
     }
 
-    const Vec2f & Curve::handleOne() const
+    Vec2f Curve::handleOne() const
     {
-        return segmentOne().handleOut();
+        return m_path.segmentArray().handlesOut[segmentIndexOne()];
     }
 
     Vec2f Curve::handleOneAbsolute() const
     {
-        return segmentOne().handleOutAbsolute();
+        const SegmentArray & segs = m_path.segmentArray();
+        return segs.positions[segmentIndexOne()] + segs.handlesOut[segmentIndexOne()];
     }
 
-    const Vec2f & Curve::handleTwo() const
+    Vec2f Curve::handleTwo() const
     {
-        return segmentTwo().handleIn();
+        return m_path.segmentArray().handlesIn[segmentIndexTwo()];
     }
 
     Vec2f Curve::handleTwoAbsolute() const
     {
-        return segmentTwo().handleInAbsolute();
+        const SegmentArray & segs = m_path.segmentArray();
+        return segs.positions[segmentIndexTwo()] + segs.handlesIn[segmentIndexTwo()];
     }
 
     Vec2f Curve::positionAt(Float _offset) const
     {
-        return m_curve.positionAt(parameterAtOffset(_offset));
+        return bezier().positionAt(parameterAtOffset(_offset));
     }
 
     Vec2f Curve::normalAt(Float _offset) const
     {
-        return m_curve.normalAt(parameterAtOffset(_offset));
+        return bezier().normalAt(parameterAtOffset(_offset));
     }
 
     Vec2f Curve::tangentAt(Float _offset) const
     {
-        return m_curve.tangentAt(parameterAtOffset(_offset));
+        return bezier().tangentAt(parameterAtOffset(_offset));
     }
 
     Float Curve::curvatureAt(Float _offset) const
     {
-        return m_curve.curvatureAt(parameterAtOffset(_offset));
+        return bezier().curvatureAt(parameterAtOffset(_offset));
     }
 
     Float Curve::angleAt(Float _offset) const
     {
-        return m_curve.angleAt(parameterAtOffset(_offset));
+        return bezier().angleAt(parameterAtOffset(_offset));
     }
 
-    stick::Maybe<Curve &> Curve::divideAt(Float _offset)
+    stick::Maybe<Curve> Curve::divideAt(Float _offset)
     {
         return divideAtParameter(parameterAtOffset(_offset));
     }
 
     Vec2f Curve::positionAtParameter(Float _t) const
     {
-        return m_curve.positionAt(_t);
+        return bezier().positionAt(_t);
     }
 
     Vec2f Curve::normalAtParameter(Float _t) const
     {
-        return m_curve.normalAt(_t);
+        return bezier().normalAt(_t);
     }
 
     Vec2f Curve::tangentAtParameter(Float _t) const
     {
-        return m_curve.tangentAt(_t);
+        return bezier().tangentAt(_t);
     }
 
     Float Curve::curvatureAtParameter(Float _t) const
     {
-        return m_curve.curvatureAt(_t);
+        return bezier().curvatureAt(_t);
     }
 
     Float Curve::angleAtParameter(Float _t) const
     {
-        return m_curve.angleAt(_t);
+        return bezier().angleAt(_t);
     }
 
-    stick::Maybe<Curve &> Curve::divideAtParameter(Float _t)
+    stick::Maybe<Curve> Curve::divideAtParameter(Float _t)
     {
         // return empty maybe if _t is out of range
         if (_t >= 1 || _t <= 0)
-            return stick::Maybe<Curve &>();
+            return stick::Maybe<Curve>();
 
         // split the bezier
-        auto splitResult = m_curve.subdivide(_t);
+        auto splitResult = bezier().subdivide(_t);
 
         //adjust the exiting segments of this curve
-        segmentOne().m_handleOut = splitResult.first.handleOne() - splitResult.first.positionOne();
-        segmentTwo().m_handleIn = splitResult.second.handleTwo() - splitResult.second.positionTwo();
-        segmentTwo().m_position = splitResult.second.positionTwo();
-
-        // create the new segment
-        stick::Size sindex = segmentOne().m_index + 1;
-        auto it = m_segmentB != 0 ? m_path.segmentArray().begin() + m_segmentB : m_path.segmentArray().end();
-        // m_path.segmentArray().insert(it,
-        //                              stick::UniquePtr<Segment>(m_path.document().allocator().create<Segment>(m_path, splitResult.first.positionTwo(),
-        //                                      splitResult.first.handleTwo() - splitResult.first.positionTwo(),
-        //                                      splitResult.second.handleOne() - splitResult.second.positionOne(), sindex)));
-
-        m_path.segmentArray().insert(it, stick::makeUnique<Segment>(m_path.document().allocator(), m_path, splitResult.first.positionTwo(),
-                                             splitResult.first.handleTwo() - splitResult.first.positionTwo(),
-                                             splitResult.second.handleOne() - splitResult.second.positionOne(), sindex));
-
-
-        // adjust the segment indices
-        auto & segs = m_path.get<comps::Segments>();
-        for (stick::Size i = sindex + 1; i < segs.count(); ++i)
-        {
-            segs[i]->m_index += 1;
-        }
-
-        // create the new curve in the correct index
-        auto cit = sindex < m_path.curveArray().count() ? m_path.curveArray().begin() + sindex : m_path.curveArray().end();
-        stick::Size sindex2 = cit == m_path.curveArray().end() ? 0 : sindex + 1;
-        Curve * c = m_path.document().allocator().create<Curve>(m_path, sindex, sindex2);
-        auto rit = m_path.curveArray().insert(cit, stick::UniquePtr<Curve>(c, m_path.document().allocator()));
-
-        // update curve segment indices
-        auto & curves = m_path.curveArray();
-        if (sindex2 != 0)
-        {
-            for (stick::Size i = m_segmentB + 1; i < curves.count(); ++i)
-            {
-                curves[i]->m_segmentA += 1;
-                if (curves[i]->m_segmentB != 0 || i < curves.count() - 1)
-                    curves[i]->m_segmentB = curves[i]->m_segmentA + 1;
-            }
-        }
-        else
-        {
-            //only update the previous closing curves indices
-            curves[curves.count() - 2]->m_segmentB = sindex;
-        }
-
-        //mark the affected curves dirty
-        m_segmentB = sindex;
-        markDirty();
-        c->markDirty();
+        auto & segs = m_path.segmentArray();
+        stick::Size a = segmentIndexOne();
+        stick::Size b = segmentIndexTwo();
+        segs.handlesOut[a] = splitResult.first.handleOne() - splitResult.first.positionOne();
+        segs.handlesIn[b] = splitResult.second.handleTwo() - splitResult.second.positionTwo();
+
+        // insert the new segment. This shifts the segment and curve data after it and marks
+        // the affected curves dirty, so this curve becomes the first part of the split.
+        m_path.insertSegment(a + 1, splitResult.first.positionTwo(),
+                             splitResult.first.handleTwo() - splitResult.first.positionTwo(),
+                             splitResult.second.handleOne() - splitResult.second.positionOne());
 
         // return the new curve
-        return *c;
+        return Curve(m_path, m_index + 1);
     }
 
     Float Curve::parameterAtOffset(Float _offset) const
     {
-        return m_curve.parameterAtOffset(_offset);
+        return bezier().parameterAtOffset(_offset);
     }
 
     Float Curve::closestParameter(const Vec2f & _point) const
     {
-        return m_curve.closestParameter(_point);
+        return bezier().closestParameter(_point);
     }
 
     Float Curve::closestParameter(const Vec2f & _point, Float & _outDistance) const
     {
-        return m_curve.closestParameter(_point, _outDistance, 0, 1, 0);
+        return bezier().closestParameter(_point, _outDistance, 0, 1, 0);
     }
 
     Float Curve::lengthBetween(Float _tStart, Float _tEnd) const
     {
-        return m_curve.lengthBetween(_tStart, _tEnd);
+        return bezier().lengthBetween(_tStart, _tEnd);
     }
 
     Float Curve::pathOffset() const
     {
-        //calculate the offset from the start to the curve location
-        Float offset = 0;
-        for (const auto & c : m_path.curveArray())
-        {
-            if (c.get() != this)
-                offset += c->length();
-            else
-                break;
-        }
-
-        return offset;
+        return m_path.curveOffset(m_index);
     }
 
     CurveLocation Curve::closestCurveLocation(const Vec2f & _point) const
     {
         Float t = closestParameter(_point);
-        return CurveLocation(const_cast<Curve &>(*this), t, pathOffset() + lengthBetween(0, t));
+        return CurveLocation(*this, t, pathOffset() + lengthBetween(0, t));
     }
 
     CurveLocation Curve::curveLocationAt(Float _offset) const
     {
-        return CurveLocation(const_cast<Curve &>(*this), parameterAtOffset(_offset), pathOffset() + _offset);
+        return CurveLocation(*this, parameterAtOffset(_offset), pathOffset() + _offset);
     }
 
     CurveLocation Curve::curveLocationAtParameter(Float _t) const
     {
-        return CurveLocation(const_cast<Curve &>(*this), _t, pathOffset() + lengthBetween(0, _t));
+        return CurveLocation(*this, _t, pathOffset() + lengthBetween(0, _t));
     }
 
     bool Curve::isLinear() const
@@ -344,56 +333,63 @@ namespace paper
 
     Float Curve::length() const
     {
-        if (!m_bLengthCached)
+        CurveData & d = data();
+        if (!d.bLengthCached)
         {
-            m_length = m_curve.length();
-            m_bLengthCached = true;
+            d.length = bezier().length();
+            d.bLengthCached = true;
         }
-        return m_length;
+        return d.length;
     }
 
     Float Curve::area() const
     {
-        return m_curve.area();
+        return bezier().area();
     }
 
-    const Rect & Curve::bounds() const
+    Rect Curve::bounds() const
     {
-        if (!m_bBoundsCached)
+        CurveData & d = data();
+        if (!d.bBoundsCached)
         {
-            m_bounds = m_curve.bounds();
-            m_bBoundsCached = true;
+            d.bounds = bezier().bounds();
+            d.bBoundsCached = true;
         }
-        return m_bounds;
+        return d.bounds;
     }
 
     Rect Curve::bounds(Float _padding) const
     {
-        return m_curve.bounds(_padding);
+        return bezier().bounds(_padding);
     }
 
     void Curve::markDirty()
     {
-        m_bLengthCached = false;
-        m_bBoundsCached = false;
-        m_curve = Bezier(positionOne(), handleOneAbsolute(), handleTwoAbsolute(), positionTwo());
+        CurveData & d = data();
+        d.bLengthCached = false;
+        d.bBoundsCached = false;
+        m_path.markCurveOffsetsDirty(m_index);
     }
 
-    const Bezier & Curve::bezier() const
+    Bezier Curve::bezier() const
     {
-        return m_curve;
+        const SegmentArray & segs = m_path.segmentArray();
+        stick::Size a = segmentIndexOne();
+        stick::Size b = segmentIndexTwo();
+        return Bezier(segs.positions[a], segs.positions[a] + segs.handlesOut[a],
+                      segs.positions[b] + segs.handlesIn[b], segs.positions[b]);
     }
 
     void Curve::peaks(stick::DynamicArray<Float> & _peaks) const
     {
-        auto peaks = m_curve.peaks();
+        auto peaks = bezier().peaks();
         for (stick::Int32 i = 0; i < peaks.count; ++i)
             _peaks.append(peaks.values[i]);
     }
 
     void Curve::extrema(stick::DynamicArray<Float> & _extrema) const
     {
-        auto ex = m_curve.extrema2D();
+        auto ex = bezier().extrema2D();
         for (stick::Int32 i = 0; i < ex.count; ++i)
             _extrema.append(ex.values[i]);
     }
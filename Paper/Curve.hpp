@@ -8,6 +8,9 @@ namespace paper
     class CurveLocation;
     class Segment;
 
+    //Curve is a lightweight, non-owning view of the curve between two adjacent
+    //segments of a path. All geometric data is computed on demand from the
+    //segments, only the length and bounds are cached per curve index in the path.
     class STICK_API Curve
     {
         friend class Path;
@@ -17,10 +20,20 @@ namespace paper
 
         Curve();
 
-        Curve(const Path & _path, stick::Size _segmentA, stick::Size _segmentB);
+        Curve(const Path & _path, stick::Size _index);
+
+        bool operator == (const Curve & _other) const;
+
+        bool operator != (const Curve & _other) const;
 
         Path path() const;
 
+        stick::Size index() const;
+
+        bool isValid() const;
+
+        explicit operator bool() const;
+
         void setPositionOne(const Vec2f & _vec);
 
         void setHandleOne(const Vec2f & _vec);
@@ -29,25 +42,25 @@ namespace paper
 
         void setHandleTwo(const Vec2f & _vec);
 
-        const Vec2f & positionOne() const;
+        Vec2f positionOne() const;
 
-        const Vec2f & positionTwo() const;
+        Vec2f positionTwo() const;
 
-        const Vec2f & handleOne() const;
+        Vec2f handleOne() const;
 
         Vec2f handleOneAbsolute() const;
 
-        const Vec2f & handleTwo() const;
+        Vec2f handleTwo() const;
 
         Vec2f handleTwoAbsolute() const;
 
-        Segment & segmentOne();
+        Segment segmentOne();
 
-        const Segment & segmentOne() const;
+        const Segment segmentOne() const;
 
-        Segment & segmentTwo();
+        Segment segmentTwo();
 
-        const Segment & segmentTwo() const;
+        const Segment segmentTwo() const;
 
 
         Vec2f positionAt(Float _offset) const;
@@ -60,7 +73,7 @@ namespace paper
 
         Float angleAt(Float _offset) const;
 
-        stick::Maybe<Curve&> divideAt(Float _offset);
+        stick::Maybe<Curve> divideAt(Float _offset);
 
         Vec2f positionAtParameter(Float _t) const;
 
@@ -72,7 +85,7 @@ namespace paper
 
         Float angleAtParameter(Float _t) const;
 
-        stick::Maybe<Curve&> divideAtParameter(Float _t);
+        stick::Maybe<Curve> divideAtParameter(Float _t);
 
         Float parameterAtOffset(Float _offset) const;
 
@@ -110,26 +123,26 @@ namespace paper
 
         Float area() const;
 
-        const Rect & bounds() const;
+        Rect bounds() const;
 
         Rect bounds(Float _padding) const;
 
-        const Bezier & bezier() const;
+        Bezier bezier() const;
 
 
     private:
 
         void markDirty();
 
+        stick::Size segmentIndexOne() const;
+
+        stick::Size segmentIndexTwo() const;
+
+        CurveData & data() const;
+
 
         Path m_path;
-        stick::Size m_segmentA;
-        stick::Size m_segmentB;
-        Bezier m_curve;
-        mutable bool m_bLengthCached;
-        mutable bool m_bBoundsCached;
-        mutable Float m_length;
-        mutable Rect m_bounds;
+        stick::Size m_index;
     };
 }
 
@@ -4,13 +4,14 @@
 namespace paper
 {
     CurveLocation::CurveLocation() :
-        m_curve(nullptr)
+        m_parameter(0),
+        m_offset(0)
     {
 
     }
 
-    CurveLocation::CurveLocation(Curve & _c, Float _parameter, Float _offset) :
-        m_curve(&_c),
+    CurveLocation::CurveLocation(const Curve & _c, Float _parameter, Float _offset) :
+        m_curve(_c),
         m_parameter(_parameter),
         m_offset(_offset)
     {
@@ -19,7 +20,7 @@ namespace paper
 
     CurveLocation::operator bool() const
     {
-        return m_curve;
+        return isValid();
     }
 
     bool CurveLocation::operator == (const CurveLocation & _other) const
@@ -38,12 +39,10 @@ namespace paper
         {
             if (_other.curve().path() == curve().path())
             {
-                printf("SAME PATH\n");
                 Float diff = std::abs(m_offset - _other.m_offset);
                 if (diff < detail::PaperConstants::geometricEpsilon() ||
                         std::abs(curve().path().length() - diff) < detail::PaperConstants::geometricEpsilon())
                 {
-                    printf("SYNOONONASIOGHAKSH\n");
                     return true;
                 }
             }
@@ -53,32 +52,32 @@ namespace paper
 
     Vec2f CurveLocation::position() const
     {
-        STICK_ASSERT(m_curve);
-        return m_curve->positionAtParameter(m_parameter);
+        STICK_ASSERT(isValid());
+        return m_curve.positionAtParameter(m_parameter);
     }
 
     Vec2f CurveLocation::normal() const
     {
-        STICK_ASSERT(m_curve);
-        return m_curve->normalAtParameter(m_parameter);
+        STICK_ASSERT(isValid());
+        return m_curve.normalAtParameter(m_parameter);
     }
 
     Vec2f CurveLocation::tangent() const
     {
-        STICK_ASSERT(m_curve);
-        return m_curve->tangentAtParameter(m_parameter);
+        STICK_ASSERT(isValid());
+        return m_curve.tangentAtParameter(m_parameter);
     }
 
     Float CurveLocation::curvature() const
     {
-        STICK_ASSERT(m_curve);
-        return m_curve->curvatureAtParameter(m_parameter);
+        STICK_ASSERT(isValid());
+        return m_curve.curvatureAtParameter(m_parameter);
     }
 
     Float CurveLocation::angle() const
     {
-        STICK_ASSERT(m_curve);
-        return m_curve->angleAtParameter(m_parameter);
+        STICK_ASSERT(isValid());
+        return m_curve.angleAtParameter(m_parameter);
     }
 
     Float CurveLocation::parameter() const
@@ -93,12 +92,12 @@ namespace paper
 
     bool CurveLocation::isValid() const
     {
-        return m_curve;
+        return m_curve.isValid();
     }
 
     const Curve & CurveLocation::curve() const
     {
-        STICK_ASSERT(m_curve);
-        return *m_curve;
+        STICK_ASSERT(isValid());
+        return m_curve;
     }
 }
@@ -1,12 +1,10 @@
 #ifndef PAPER_CURVELOCATION_HPP
 #define PAPER_CURVELOCATION_HPP
 
-#include <Paper/BasicTypes.hpp>
+#include <Paper/Curve.hpp>
 
 namespace paper
 {
-    class Curve;
-
     class STICK_API CurveLocation
     {
         friend class Curve;
@@ -43,9 +41,9 @@ namespace paper
 
     private:
 
-        CurveLocation(Curve & _c, Float _parameter, Float _offset);
+        CurveLocation(const Curve & _c, Float _parameter, Float _offset);
 
-        Curve * m_curve;
+        Curve m_curve;
         Float m_parameter;
         Float m_offset;
     };
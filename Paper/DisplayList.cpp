@@ -0,0 +1,324 @@
+#include <Paper/DisplayList.hpp>
+#include <Paper/Document.hpp>
+#include <Paper/Path.hpp>
+#include <Paper/Group.hpp>
+#include <Paper/PlacedSymbol.hpp>
+
+#include <algorithm>
+
+namespace paper
+{
+    using namespace stick;
+
+    static detail::comps::DisplayListArray * documentLists(const Item & _item)
+    {
+        if (!_item.hasComponent<comps::Doc>())
+            return nullptr;
+
+        Document doc = _item.get<comps::Doc>();
+        if (!doc.isValid())
+            return nullptr;
+
+        auto maybe = doc.maybe<detail::comps::DisplayLists>();
+        return maybe && (*maybe).count() ? &(*maybe) : nullptr;
+    }
+
+    DisplayList::DisplayList() :
+        m_bNeedsRecord(false),
+        m_bRecordingNodes(false),
+        m_bHasSymbols(false),
+        m_recordCount(0)
+    {
+    }
+
+    DisplayList::~DisplayList()
+    {
+        if (m_document.isValid() && m_document.hasComponent<detail::comps::DisplayLists>())
+        {
+            auto & lists = m_document.get<detail::comps::DisplayLists>();
+            auto it = stick::find(lists.begin(), lists.end(), this);
+            if (it != lists.end())
+                lists.remove(it);
+        }
+    }
+
+    void DisplayList::record(Document _doc)
+    {
+        STICK_ASSERT(_doc.isValid());
+        if (!(m_document == _doc))
+        {
+            if (m_document.isValid() && m_document.hasComponent<detail::comps::DisplayLists>())
+            {
+                auto & lists = m_document.get<detail::comps::DisplayLists>();
+                auto it = stick::find(lists.begin(), lists.end(), this);
+                if (it != lists.end())
+                    lists.remove(it);
+            }
+
+            m_document = _doc;
+            if (!m_document.hasComponent<detail::comps::DisplayLists>())
+                m_document.set<detail::comps::DisplayLists>(detail::comps::DisplayListArray());
+            m_document.get<detail::comps::DisplayLists>().append(this);
+        }
+
+        rerecord();
+    }
+
+    void DisplayList::update()
+    {
+        if (!m_document.isValid())
+            return;
+
+        if (m_bNeedsRecord)
+        {
+            rerecord();
+            return;
+        }
+
+        if (!m_queue.count())
+            return;
+
+        //node ranges are either nested or disjoint. Visiting them by their start (outer
+        //ranges first) lets us skip everything inside of a range that was patched already.
+        std::sort(m_queue.begin(), m_queue.end(), [this](Int32 _a, Int32 _b)
+        {
+            const Node & a = m_nodes[_a];
+            const Node & b = m_nodes[_b];
+            return a.begin < b.begin || (a.begin == b.begin && a.end > b.end);
+        });
+
+        bool bPatched = true;
+        Size coveredEnd = 0;
+        for (Int32 idx : m_queue)
+        {
+            Node & n = m_nodes[idx];
+            n.bQueued = false;
+            if (!bPatched || n.begin < coveredEnd)
+                continue;
+
+            bPatched = patch(n);
+            coveredEnd = n.end;
+        }
+        m_queue.clear();
+
+        if (!bPatched)
+            rerecord();
+    }
+
+    const DisplayList::CommandArray & DisplayList::commands() const
+    {
+        return m_commands;
+    }
+
+    Document DisplayList::document() const
+    {
+        return m_document;
+    }
+
+    Size DisplayList::recordCount() const
+    {
+        return m_recordCount;
+    }
+
+    void DisplayList::itemChanged(const Item & _item)
+    {
+        if (detail::comps::DisplayListArray * lists = documentLists(_item))
+        {
+            for (DisplayList * list : *lists)
+                list->queue(_item);
+        }
+    }
+
+    void DisplayList::structureChanged(const Item & _item)
+    {
+        if (detail::comps::DisplayListArray * lists = documentLists(_item))
+        {
+            for (DisplayList * list : *lists)
+            {
+                //we can't tell if a detached item is part of a symbol, so any change
+                //possibly affects the lists that contain symbols.
+                if (!list->m_bNeedsRecord && (list->m_bHasSymbols || list->isRecorded(_item)))
+                    list->m_bNeedsRecord = true;
+            }
+        }
+    }
+
+    void DisplayList::rerecord()
+    {
+        m_commands.clear();
+        m_nodes.clear();
+        m_queue.clear();
+        m_bHasSymbols = false;
+        m_bRecordingNodes = true;
+        recordItem(m_document, nullptr, nullptr, false, m_commands, 0);
+        m_bRecordingNodes = false;
+        m_bNeedsRecord = false;
+        ++m_recordCount;
+    }
+
+    void DisplayList::recordItem(const Item & _item, const Mat3f * _transform, const Rect * _symbolBounds,
+                                 bool _bMask, CommandArray & _out, Size _base)
+    {
+        //items inside of symbols don't get a node, changing them re-records the list.
+        Int32 node = -1;
+        if (m_bRecordingNodes && !_transform)
+        {
+            node = m_nodes.count();
+            m_nodes.append({_item, _base + _out.count(), 0, _bMask, false});
+
+            Item item = _item;
+            if (!item.hasComponent<detail::comps::DisplayListNodes>())
+                item.set<detail::comps::DisplayListNodes>(detail::comps::DisplayListNodeRefArray());
+            auto & refs = item.get<detail::comps::DisplayListNodes>();
+            auto it = std::find_if(refs.begin(), refs.end(), [this](const detail::comps::DisplayListNodeRef & _ref) { return _ref.list == this; });
+            if (it != refs.end())
+                (*it).node = node;
+            else
+                refs.append({this, node});
+        }
+
+        //the same transforms that RenderInterface::drawItem computes
+        Mat3f tmp;
+        if (_transform)
+            tmp = _item.absoluteTransform() * *_transform;
+
+        EntityType et = _item.itemType();
+        if (et == EntityType::Document)
+        {
+            for (const Item & c : _item.children())
+                recordItem(c, _transform, _symbolBounds, false, _out, _base);
+        }
+        else if (et == EntityType::Group)
+        {
+            Group grp = brick::reinterpretEntity<Group>(_item);
+            if (grp.isVisible())
+            {
+                const auto & cs = grp.children();
+                if (grp.isClipped())
+                {
+                    STICK_ASSERT(cs.first().itemType() == EntityType::Path);
+                    Size begin = _out.count();
+                    recordItem(cs.first(), _transform ? &tmp : nullptr, _symbolBounds, true, _out, _base);
+                    for (auto it = cs.begin() + 1; it != cs.end(); ++it)
+                        recordItem(*it, _transform, _symbolBounds, false, _out, _base);
+
+                    Command end;
+                    end.type = CommandType::EndClipping;
+                    end.bDrawable = false;
+                    end.scopeEnd = 0;
+                    _out.append(end);
+                    _out[begin].scopeEnd = _base + _out.count() - 1;
+                }
+                else
+                {
+                    for (const Item & c : cs)
+                        recordItem(c, _transform, _symbolBounds, false, _out, _base);
+                }
+            }
+        }
+        else if (et == EntityType::Path)
+        {
+            //paths are recorded even if they are hidden or empty, so that their changes
+            //never change the number of commands.
+            Path p = brick::reinterpretEntity<Path>(_item);
+            Command cmd;
+            cmd.type = _bMask ? CommandType::BeginClipping : CommandType::DrawPath;
+            cmd.path = p;
+            cmd.transform = _transform ? tmp : p.absoluteTransform();
+            cmd.bounds = _symbolBounds ? *_symbolBounds : p.strokeBounds();
+            cmd.bDrawable = _bMask || (p.isVisible() && p.segmentArray().count() > 1);
+            cmd.scopeEnd = 0;
+            if (!_bMask)
+                cmd.style = p.style();
+            _out.append(cmd);
+        }
+        else if (et == EntityType::PlacedSymbol)
+        {
+            m_bHasSymbols = true;
+            PlacedSymbol ps = brick::reinterpretEntity<PlacedSymbol>(_item);
+
+            //everything inside of the symbol is culled with the outermost placed symbol
+            Rect bounds = _symbolBounds ? *_symbolBounds : ps.strokeBounds();
+            Mat3f transform = _transform ? tmp : ps.absoluteTransform();
+            recordItem(ps.symbol().item(), &transform, &bounds, false, _out, _base);
+        }
+
+        if (node != -1)
+            m_nodes[node].end = _base + _out.count();
+    }
+
+    bool DisplayList::patch(const Node & _node)
+    {
+        if (!_node.item.isValid())
+            return false;
+
+        m_scratch.clear();
+        recordItem(_node.item, nullptr, nullptr, _node.bMask, m_scratch, _node.begin);
+        if (m_scratch.count() != _node.end - _node.begin)
+            return false;
+
+        //the end of a clipping scope is recorded by the group, not by its mask
+        if (_node.bMask)
+            m_scratch[0].scopeEnd = m_commands[_node.begin].scopeEnd;
+
+        for (Size i = 0; i < m_scratch.count(); ++i)
+            m_commands[_node.begin + i] = m_scratch[i];
+        return true;
+    }
+
+    Int32 DisplayList::nodeIndex(const Item & _item) const
+    {
+        Item item = _item;
+        auto maybe = item.maybe<detail::comps::DisplayListNodes>();
+        if (!maybe)
+            return -1;
+
+        for (const detail::comps::DisplayListNodeRef & ref : *maybe)
+        {
+            //the reference might be left over from a previous recording
+            if (ref.list == this)
+                return ref.node < (Int32)m_nodes.count() && m_nodes[ref.node].item == _item ? ref.node : -1;
+        }
+        return -1;
+    }
+
+    void DisplayList::queue(const Item & _item)
+    {
+        if (m_bNeedsRecord)
+            return;
+
+        //compound path children and the children of hidden groups don't have a node,
+        //the closest recorded parent takes care of them.
+        Item item = _item;
+        while (item.isValid())
+        {
+            Int32 idx = nodeIndex(item);
+            if (idx != -1)
+            {
+                if (!m_nodes[idx].bQueued)
+                {
+                    m_nodes[idx].bQueued = true;
+                    m_queue.append(idx);
+                }
+                return;
+            }
+            item = item.parent();
+        }
+
+        //the item is either not part of the document or inside of a symbol
+        if (m_bHasSymbols)
+            m_bNeedsRecord = true;
+    }
+
+    bool DisplayList::isRecorded(const Item & _item) const
+    {
+        Item item = _item;
+        while (item.isValid())
+        {
+            if (item == m_document)
+                return true;
+            item = item.parent();
+        }
+        return false;
+    }
+}
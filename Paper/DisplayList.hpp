@@ -0,0 +1,141 @@
+#ifndef PAPER_DISPLAYLIST_HPP
+#define PAPER_DISPLAYLIST_HPP
+
+#include <Paper/RenderInterface.hpp>
+
+namespace paper
+{
+    //Flattened sequence of the draw calls a RenderInterface issues for a document,
+    //with transforms and styles already resolved. Recording walks the document once,
+    //afterwards item changes only queue the affected parts of the list which update()
+    //re-records in place. Changes to the hierarchy (adding, removing or reordering
+    //items, visibility and clipping) re-record the whole list. Changes made while a batch
+    //of the document is open are queued when the batch ends, see Document::beginBatch().
+    //Use RenderInterface::draw(const DisplayList &) to replay it.
+    class STICK_API DisplayList
+    {
+        friend class Item;
+        friend class Group;
+
+    public:
+
+        enum class CommandType
+        {
+            DrawPath,
+            BeginClipping,
+            EndClipping
+        };
+
+        struct Command
+        {
+            CommandType type;
+            Path path;
+            Mat3f transform;
+            //only set for DrawPath
+            PathStyle style;
+            //stroke bounds in document space, used for culling
+            Rect bounds;
+            //false for paths with less than two segments
+            bool bDrawable;
+            //for BeginClipping, the index of the matching EndClipping command
+            stick::Size scopeEnd;
+        };
+
+        using CommandArray = stick::DynamicArray<Command>;
+
+
+        DisplayList();
+
+        ~DisplayList();
+
+        //the list registers itself with the document, so it can't be copied or moved
+        DisplayList(const DisplayList &) = delete;
+
+        DisplayList & operator = (const DisplayList &) = delete;
+
+
+        //records all draw calls of _doc.
+        void record(Document _doc);
+
+        //brings the list up to date with the changes made since the last update.
+        void update();
+
+        const CommandArray & commands() const;
+
+        Document document() const;
+
+        //the number of complete recordings, including the ones update() fell back to.
+        stick::Size recordCount() const;
+
+
+    private:
+
+        struct Node
+        {
+            Item item;
+            //the range of commands recorded for item
+            stick::Size begin;
+            stick::Size end;
+            bool bMask;
+            bool bQueued;
+        };
+
+        using NodeArray = stick::DynamicArray<Node>;
+        using NodeIndexArray = stick::DynamicArray<stick::Int32>;
+
+        //called from the item invalidation code, these don't do anything if the
+        //document of _item is not recorded by any list.
+        static void itemChanged(const Item & _item);
+
+        static void structureChanged(const Item & _item);
+
+
+        void rerecord();
+
+        void recordItem(const Item & _item, const Mat3f * _transform, const Rect * _symbolBounds,
+                        bool _bMask, CommandArray & _out, stick::Size _base);
+
+        bool patch(const Node & _node);
+
+        stick::Int32 nodeIndex(const Item & _item) const;
+
+        void queue(const Item & _item);
+
+        //true if _item is part of what this list records
+        bool isRecorded(const Item & _item) const;
+
+
+        Document m_document;
+        CommandArray m_commands;
+        CommandArray m_scratch;
+        NodeArray m_nodes;
+        NodeIndexArray m_queue;
+        bool m_bNeedsRecord;
+        bool m_bRecordingNodes;
+        bool m_bHasSymbols;
+        stick::Size m_recordCount;
+    };
+
+    namespace detail
+    {
+        namespace comps
+        {
+            struct DisplayListNodeRef
+            {
+                const DisplayList * list;
+                stick::Int32 node;
+            };
+
+            using DisplayListNodeRefArray = stick::DynamicArray<DisplayListNodeRef>;
+            using DisplayListArray = stick::DynamicArray<DisplayList *>;
+
+            //the lists recording a document
+            using DisplayLists = brick::Component<ComponentName("DisplayLists"), DisplayListArray>;
+            //the node of an item in each list that recorded it. Entries of lists that
+            //don't record the item anymore are detected by comparing the node item.
+            using DisplayListNodes = brick::Component<ComponentName("DisplayListNodes"), DisplayListNodeRefArray>;
+        }
+    }
+}
+
+#endif //PAPER_DISPLAYLIST_HPP
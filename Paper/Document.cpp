@@ -1,8 +1,12 @@
 #include <Paper/Document.hpp>
 #include <Paper/Constants.hpp>
 #include <Paper/Private/Allocator.hpp>
+#include <Paper/Private/BooleanOperations.hpp>
+#include <Paper/Private/ThreadPool.hpp>
+#include <Paper/Private/SpatialIndex.hpp>
 #include <Paper/SVG/SVGExport.hpp>
 #include <Paper/SVG/SVGImport.hpp>
+#include <Crunch/MatrixFunc.hpp>
 #include <Crunch/StringConversion.hpp>
 #include <Stick/FileUtilities.hpp>
 
@@ -44,6 +48,18 @@ namespace paper
         return ret;
     }
 
+    RadialGradient Document::createRadialGradient(const Vec2f & _origin, const Vec2f & _destination,
+            const ColorStopArray & _stops)
+    {
+        STICK_ASSERT(Entity::hub());
+        RadialGradient ret = brick::createEntity<RadialGradient>(hub());
+        ret.set<comps::Origin>(_origin);
+        ret.set<comps::Destination>(_destination);
+        ret.set<comps::ColorStops>(_stops);
+        ret.set<comps::GradientDirtyFlags>(true, true);
+        return ret;
+    }
+
     Symbol Document::createSymbol(const Item & _item)
     {
         if (_item.parent().isValid())
@@ -77,7 +93,8 @@ namespace paper
         ret.set<comps::Segments>(SegmentArray());
         ret.set<comps::Curves>(CurveArray());
         ret.set<comps::ClosedFlag>(false);
-        ret.set<comps::PathLength>((comps::PathLengthData) {true, 0.0});
+        ret.set<comps::PathLength>((comps::PathLengthData) {true, 0.0, 0});
+        ret.set<comps::PathArea>((comps::PathAreaData) {true, 0.0});
         addChild(ret);
         return ret;
     }
@@ -194,6 +211,265 @@ namespace paper
         return res.error();
     }
 
+    namespace detail
+    {
+        static bool isVisibleInHierarchy(const Item & _item)
+        {
+            Item i = _item;
+            while (i.isValid())
+            {
+                if (!i.isVisible())
+                    return false;
+                i = i.parent();
+            }
+            return true;
+        }
+
+        static bool strokeHit(const Path & _path, const Vec2f & _point, Float _maxDistance)
+        {
+            Vec2f local = crunch::inverse(_path.absoluteTransform()) * _point;
+            Vec2f pad(_maxDistance);
+            for (const Curve & c : _path.curves())
+            {
+                // skip the expensive projection for curves that are too far away
+                Rect b = c.bounds();
+                if (!Rect(b.min() - pad, b.max() + pad).contains(local))
+                    continue;
+
+                Float dist;
+                c.closestParameter(local, dist);
+                if (dist <= _maxDistance)
+                    return true;
+            }
+
+            for (const Item & child : _path.children())
+            {
+                if (strokeHit(brick::reinterpretEntity<Path>(child), _point, _maxDistance))
+                    return true;
+            }
+            return false;
+        }
+
+        static bool hitTestSymbolItem(const Item & _item, const Mat3f & _transform, const Vec2f & _point, Float _tolerance);
+
+        static bool hitTestItem(const Item & _item, const Vec2f & _point, Float _tolerance)
+        {
+            if (_item.itemType() == EntityType::PlacedSymbol)
+            {
+                PlacedSymbol ps = brick::reinterpretEntity<PlacedSymbol>(_item);
+                Vec2f local = crunch::inverse(ps.absoluteTransform()) * _point;
+                return hitTestSymbolItem(ps.symbol().item(), Mat3f::identity(), local, _tolerance);
+            }
+
+            Path p = brick::reinterpretEntity<Path>(_item);
+            if (p.hasFill() && p.contains(_point))
+                return true;
+
+            Float maxDist = _tolerance;
+            if (p.hasStroke())
+                maxDist += p.strokeWidth() * 0.5f;
+            return strokeHit(p, _point, maxDist);
+        }
+
+        // tests the item of a symbol like it is drawn by a placed symbol, i.e. _transform
+        // (the transform of its parent inside of the symbol) replaces its absolute transform.
+        // _point is in the space of the placed symbol.
+        static bool hitTestSymbolItem(const Item & _item, const Mat3f & _transform, const Vec2f & _point, Float _tolerance)
+        {
+            if (!_item.isValid() || !_item.isVisible())
+                return false;
+
+            Mat3f transform = _transform * _item.transform();
+            EntityType et = _item.itemType();
+            if (et == EntityType::Path)
+            {
+                // contains() and strokeHit() expect document coordinates, so move the point to
+                // where it is relative to the path in the document.
+                Path p = brick::reinterpretEntity<Path>(_item);
+                return hitTestItem(p, p.absoluteTransform() * (crunch::inverse(transform) * _point), _tolerance);
+            }
+            else if (et == EntityType::PlacedSymbol)
+            {
+                PlacedSymbol ps = brick::reinterpretEntity<PlacedSymbol>(_item);
+                return hitTestSymbolItem(ps.symbol().item(), transform, _point, _tolerance);
+            }
+
+            for (const Item & child : _item.children())
+            {
+                if (hitTestSymbolItem(child, transform, _point, _tolerance))
+                    return true;
+            }
+            return false;
+        }
+
+        static Size depth(const Item & _item)
+        {
+            Size ret = 0;
+            for (Item i = _item.parent(); i.isValid(); i = i.parent())
+                ++ret;
+            return ret;
+        }
+
+        // returns the index of _item in the children of _parent. The index is cached on the
+        // item, so it only has to be looked up again after the order of the children changed.
+        static Size siblingIndex(const Item & _item, const Item & _parent)
+        {
+            const ItemArray & siblings = _parent.children();
+            auto mindex = _item.maybe<paper::comps::SiblingIndex>();
+            if (mindex && *mindex < siblings.count() && siblings[*mindex] == _item)
+                return *mindex;
+
+            // all siblings are likely to be out of date, too
+            for (Size i = 0; i < siblings.count(); ++i)
+            {
+                Item sibling = siblings[i];
+                sibling.set<paper::comps::SiblingIndex>(i);
+            }
+            return _item.get<paper::comps::SiblingIndex>();
+        }
+
+        //true if _a is painted on top of _b
+        static bool isAbove(const Item & _a, const Item & _b)
+        {
+            // bring both to the same depth, children are painted on top of their parents
+            Size depthA = depth(_a);
+            Size depthB = depth(_b);
+            Item a = _a;
+            Item b = _b;
+            for (Size i = depthA; i > depthB; --i)
+                a = a.parent();
+            for (Size i = depthB; i > depthA; --i)
+                b = b.parent();
+            if (a == b)
+                return depthA > depthB;
+
+            // walk up to the children of the common ancestor
+            while (a.parent() != b.parent())
+            {
+                a = a.parent();
+                b = b.parent();
+            }
+
+            Item common = a.parent();
+            if (!common.isValid())
+                return false;
+            return siblingIndex(a, common) > siblingIndex(b, common);
+        }
+    }
+
+    Item Document::hitTest(const Vec2f & _point, Float _tolerance) const
+    {
+        const_cast<Document *>(this)->flushBatch();
+        detail::SpatialIndex & index = detail::SpatialIndex::indexFor(*this);
+        Rect area(_point - Vec2f(_tolerance), _point + Vec2f(_tolerance));
+
+        Item ret;
+        index.query(area, [&](const Item & _item, const Rect & _bounds)
+        {
+            if (!detail::rectsOverlap(_bounds, area) ||
+                    !detail::isVisibleInHierarchy(_item) ||
+                    !detail::hitTestItem(_item, _point, _tolerance))
+                return;
+
+            if (!ret || detail::isAbove(_item, ret))
+                ret = _item;
+        });
+        return ret;
+    }
+
+    static void collectUnionOperands(const Item & _item, detail::BooleanOperandArray & _outOperands, Path & _outStyleSource)
+    {
+        EntityType et = _item.itemType();
+        if (et == EntityType::Path)
+        {
+            Path p = brick::reinterpretEntity<Path>(_item);
+            if (!_outStyleSource.isValid())
+                _outStyleSource = p;
+            _outOperands.append(detail::booleanOperand(p));
+        }
+        else if (et == EntityType::Group)
+        {
+            for (const Item & c : _item.children())
+                collectUnionOperands(c, _outOperands, _outStyleSource);
+        }
+    }
+
+    Path Document::uniteAll(const ItemArray & _items, Size _threadCount)
+    {
+        //the geometry of the items is read on this thread, the workers only see plain curves
+        detail::BooleanOperandArray operands;
+        Path styleSource;
+        for (const Item & item : _items)
+            collectUnionOperands(item, operands, styleSource);
+
+        if (!styleSource.isValid())
+            return Path();
+
+        detail::BezierLoopArray loops;
+        detail::ThreadPool pool(operands.count() > 2 ? _threadCount : 1);
+        detail::uniteAll(operands, pool, loops);
+        return detail::createBooleanResult(styleSource, loops);
+    }
+
+    void Document::beginBatch()
+    {
+        openBatch();
+    }
+
+    ItemChangeArray Document::endBatch()
+    {
+        return closeBatch();
+    }
+
+    Document Document::clone() const
+    {
+        return brick::reinterpretEntity<Document>(Item::clone());
+    }
+
+    DocumentBatch::DocumentBatch(Document _doc) :
+        m_document(_doc),
+        m_bOpen(true)
+    {
+        m_document.beginBatch();
+    }
+
+    DocumentBatch::~DocumentBatch()
+    {
+        if (m_bOpen)
+            m_document.endBatch();
+    }
+
+    ItemChangeArray DocumentBatch::end()
+    {
+        STICK_ASSERT(m_bOpen);
+        m_bOpen = false;
+        return m_document.endBatch();
+    }
+
+    ItemArray Document::itemsIntersecting(const Rect & _rect) const
+    {
+        const_cast<Document *>(this)->flushBatch();
+        ItemArray ret;
+        detail::SpatialIndex::indexFor(*this).query(_rect, [&](const Item & _item, const Rect & _bounds)
+        {
+            if (detail::rectsOverlap(_bounds, _rect))
+                ret.append(_item);
+        });
+        return ret;
+    }
+
+    ItemArray Document::itemsContainedIn(const Rect & _rect) const
+    {
+        const_cast<Document *>(this)->flushBatch();
+        ItemArray ret;
+        detail::SpatialIndex::indexFor(*this).query(_rect, [&](const Item & _item, const Rect & _bounds)
+        {
+            if (detail::rectContains(_rect, _bounds))
+                ret.append(_item);
+        });
+        return ret;
+    }
+
     brick::Hub & defaultHub()
     {
         static detail::DefaultPaperAllocator s_alloc;
@@ -219,6 +495,7 @@ namespace paper
         doc.set<comps::ItemType>(EntityType::Document);
         doc.set<comps::HubPointer>(&_hub);
         doc.set<comps::DocumentSize>(Vec2f(800, 600));
+        doc.set<comps::DocumentState>((comps::DocumentStateData) {1, 0, false});
         // doc.set<comps::NoPaintHolder>(doc.createNoPaint());
         //doc.set<comps::NoPaintHolder>(doc.createNoPaint());
         return doc;
@@ -38,6 +38,10 @@ namespace paper
         LinearGradient createLinearGradient(const Vec2f & _origin, const Vec2f & _destination,
                                             const ColorStopArray & _stops = ColorStopArray());
 
+        //_origin is the center, the gradient ends at the distance of _destination from it
+        RadialGradient createRadialGradient(const Vec2f & _origin, const Vec2f & _destination,
+                                            const ColorStopArray & _stops = ColorStopArray());
+
         Symbol createSymbol(const Item & _item);
 
         Group createGroup(const stick::String & _name = "");
@@ -73,6 +77,67 @@ namespace paper
         stick::TextResult exportSVG() const;
 
         stick::Error saveSVG(const stick::String & _uri) const;
+
+        //unites all paths in _items (and inside of the groups in _items) in document
+        //coordinates. The paths are combined in a balanced tree of pairwise unions, the
+        //independent unions run on _threadCount threads (0 uses one per hardware thread).
+        //Only the resulting path is added to the document, it gets the style that is set on the first path.
+        //If there are no paths in _items, nothing is added and an invalid path is returned.
+        Path uniteAll(const ItemArray & _items, stick::Size _threadCount = 0);
+
+        //Edits made between beginBatch() and endBatch() still mark the caches of the edited
+        //items dirty, but the bounds of their parents only get marked once per item, when the
+        //outermost batch ends. Reading any bounds while a batch is open propagates the
+        //pending changes first, so the results are the same as without a batch.
+        //The spatial index and display lists are notified once per changed item, too,
+        //either when the batch ends or right before the next query of the document.
+        //Batches can be nested, see DocumentBatch for a scoped version.
+        void beginBatch();
+
+        //returns every item that changed since the outermost beginBatch() once, together
+        //with what changed about it. Nested calls return an empty array. Items that got
+        //removed during the batch are not part of it.
+        ItemChangeArray endBatch();
+
+        //returns a new document holding copies of all items of this document.
+        //Placed symbols keep referring to the symbols created with this document.
+        Document clone() const;
+
+        //The following queries are backed by a spatial index that is built on first use
+        //and kept up to date incrementally as items change.
+
+        //returns the topmost visible item at _point (in document coordinates) or an
+        //invalid item if there is none. _tolerance extends the hit area of fills and strokes.
+        Item hitTest(const Vec2f & _point, Float _tolerance = 0) const;
+
+        //returns all paths and placed symbols whose stroke bounds overlap _rect, in no particular order.
+        ItemArray itemsIntersecting(const Rect & _rect) const;
+
+        //returns all paths and placed symbols whose stroke bounds lie inside _rect, in no particular order.
+        ItemArray itemsContainedIn(const Rect & _rect) const;
+    };
+
+    //calls beginBatch() on construction and endBatch() when it goes out of scope, unless
+    //the batch was ended already.
+    class STICK_API DocumentBatch
+    {
+    public:
+
+        explicit DocumentBatch(Document _doc);
+
+        ~DocumentBatch();
+
+        DocumentBatch(const DocumentBatch &) = delete;
+
+        DocumentBatch & operator = (const DocumentBatch &) = delete;
+
+        //ends the batch before it goes out of scope, see Document::endBatch()
+        ItemChangeArray end();
+
+    private:
+
+        Document m_document;
+        bool m_bOpen;
     };
 
     STICK_API brick::Hub & defaultHub();
@@ -1,4 +1,6 @@
 #include <Paper/Group.hpp>
+#include <Paper/Document.hpp>
+#include <Paper/Path.hpp>
 #include <Paper/Components.hpp>
 
 namespace paper
@@ -11,6 +13,7 @@ namespace paper
     void Group::setClipped(bool _b)
     {
         set<comps::ClippedFlag>(_b);
+        notifyChange(ItemChange::Structure);
     }
 
     bool Group::isClipped() const
@@ -22,4 +25,9 @@ namespace paper
     {
         return brick::reinterpretEntity<Group>(Item::clone());
     }
+
+    Path Group::uniteAll(stick::Size _threadCount) const
+    {
+        return document().uniteAll(children(), _threadCount);
+    }
 }
@@ -7,6 +7,7 @@
 namespace paper
 {
     class Document;
+    class Path;
 
     class STICK_API Group : public Item
     {
@@ -24,6 +25,9 @@ namespace paper
         bool isClipped() const;
 
         Group clone() const;
+
+        //same as document().uniteAll(children(), _threadCount)
+        Path uniteAll(stick::Size _threadCount = 0) const;
     };
 }
 
@@ -4,14 +4,129 @@
 #include <Paper/Group.hpp>
 #include <Paper/Document.hpp>
 #include <Paper/PlacedSymbol.hpp>
+#include <Paper/Symbol.hpp>
+#include <Paper/DisplayList.hpp>
 #include <Paper/Private/BooleanOperations.hpp> //for removing the mono curve component in markGeometryDirty
+#include <Paper/Private/SpatialIndex.hpp>
 
 #include <Crunch/MatrixFunc.hpp>
 
 #include <Crunch/StringConversion.hpp>
 
+#include <atomic>
+
 namespace paper
 {
+    //the area of a compound path includes its children, so changes propagate to the parent paths.
+    static void markAreaDirty(Item _item)
+    {
+        while (_item.isValid() && _item.itemType() == EntityType::Path)
+        {
+            auto maybe = _item.maybe<comps::PathArea>();
+            if (maybe)
+            {
+                //the parents of a path with a dirty area are dirty, too
+                if ((*maybe).bDirty)
+                    return;
+                (*maybe).bDirty = true;
+            }
+            _item = _item.parent();
+        }
+    }
+
+    //source of all item versions, see comps::TransformVersion, comps::GeometryVersion
+    //and comps::ResolvedStyleData
+    static std::atomic<stick::UInt64> s_version(0);
+
+    //see comps::DocumentStateData
+    static comps::DocumentStateData & documentState(const Item & _item)
+    {
+        Document doc = _item.document();
+        return doc.get<comps::DocumentState>();
+    }
+
+    static void propagateBoundsDirty(Item _item, bool _bStroke, stick::UInt64 _epoch)
+    {
+        while (true)
+        {
+            if (!_item.hasComponent<comps::BoundsPropagation>())
+                _item.set<comps::BoundsPropagation>((comps::BoundsPropagationData) {0, 0, false, false});
+
+            auto & prop = _item.get<comps::BoundsPropagation>();
+            stick::UInt64 & epoch = _bStroke ? prop.strokeEpoch : prop.fillEpoch;
+            //stop at the first item that already marked its parents dirty since nothing got recomputed
+            if (epoch == _epoch)
+                return;
+            epoch = _epoch;
+
+            Item p = _item.parent();
+            if (!p.isValid())
+                return;
+
+            if (_bStroke)
+                p.markStrokeBoundsDirty(false);
+            else
+                p.markFillBoundsDirty(false);
+            _item = p;
+        }
+    }
+
+    //brings the cached absolute transform of _item up to date, given the up to date absolute
+    //transform of its parent _p (nullptr if _p has none). Instead of marking the whole subtree
+    //dirty when a transform changes, the cache is compared against the highest transform
+    //version of the item and its ancestors. Items that never had their transform set and were
+    //never added to a parent don't have a cache, in which case nullptr is returned. _latest is
+    //the transform version of the document, see comps::AbsoluteTransformData::documentVersion.
+    static const comps::AbsoluteTransformData * updateAbsoluteTransform(Item _item, const Item & _p,
+            const comps::AbsoluteTransformData * _parentData, stick::UInt64 _latest)
+    {
+        auto mversion = _item.maybe<comps::TransformVersion>();
+        if (!mversion)
+            return nullptr;
+
+        stick::UInt64 version = *mversion;
+        if (_parentData)
+            version = std::max(version, _parentData->version);
+
+        auto mcache = _item.maybe<comps::AbsoluteTransform>();
+        if (mcache && (*mcache).version == version)
+        {
+            (*mcache).documentVersion = _latest;
+            return &(*mcache);
+        }
+
+        Mat3f transform;
+        if (_parentData)
+            transform = _parentData->transform * _item.transform();
+        else if (_p.isValid())
+            transform = _p.transform() * _item.transform();
+        else
+            transform = _item.transform();
+
+        _item.set<comps::AbsoluteTransform>((comps::AbsoluteTransformData) {transform, version, _latest});
+        return &_item.get<comps::AbsoluteTransform>();
+    }
+
+    static const comps::AbsoluteTransformData * updateAbsoluteTransform(Item _item, stick::UInt64 _latest)
+    {
+        //no transform in the document changed since the cache was checked, so there is no need
+        //to walk up to the root
+        auto mcache = _item.maybe<comps::AbsoluteTransform>();
+        if (mcache && (*mcache).documentVersion == _latest)
+            return &(*mcache);
+
+        if (!_item.hasComponent<comps::TransformVersion>())
+            return nullptr;
+
+        Item p = _item.parent();
+        return updateAbsoluteTransform(_item, p, p.isValid() ? updateAbsoluteTransform(p, _latest) : nullptr, _latest);
+    }
+
+    static const comps::AbsoluteTransformData * updateAbsoluteTransform(Item _item)
+    {
+        return updateAbsoluteTransform(_item, documentState(_item).transformVersion);
+    }
+
     Item::Item()
     {
 
@@ -54,6 +169,20 @@ namespace paper
         e2.removeFromParent();
         get<comps::Children>().append(e2);
         _e.set<comps::Parent>(*this);
+        _e.markStyleDirty();
+
+        //the area of the compound path can be updated without summing up all children again
+        if (get<comps::ItemType>() == EntityType::Path)
+        {
+            auto area = maybe<comps::PathArea>();
+            if (area && !(*area).bDirty)
+            {
+                Float childArea = brick::reinterpretEntity<Path>(_e).area();
+                get<comps::PathArea>().area += childArea;
+                markAreaDirty(parent());
+            }
+        }
+        notifyChange(ItemChange::Structure);
 
         //the bounds are dirty now
         markBoundsDirty(true);
@@ -70,6 +199,10 @@ namespace paper
         STICK_ASSERT(it != children.end());
         children.insert(it + 1, *this);
         set<comps::Parent>(p);
+        markAbsoluteTransformDirty();
+        markStyleDirty();
+        markAreaDirty(p);
+        p.notifyChange(ItemChange::Structure);
 
         //the new parent bounds are dirty now
         p.markBoundsDirty(true);
@@ -86,6 +219,10 @@ namespace paper
         STICK_ASSERT(it != children.end());
         children.insert(it, *this);
         set<comps::Parent>(p);
+        markAbsoluteTransformDirty();
+        markStyleDirty();
+        markAreaDirty(p);
+        p.notifyChange(ItemChange::Structure);
 
         //the new parent bounds are dirty now
         p.markBoundsDirty(true);
@@ -101,6 +238,7 @@ namespace paper
 
         p.get<comps::Children>().append(*this);
         set<comps::Parent>(p);
+        p.notifyChange(ItemChange::Structure);
 
         //the new parent bounds are dirty now
         p.markBoundsDirty(true);
@@ -116,6 +254,7 @@ namespace paper
 
         p.get<comps::Children>().insert(p.get<comps::Children>().begin(), *this);
         set<comps::Parent>(p);
+        p.notifyChange(ItemChange::Structure);
 
         //the new parent bounds are dirty now
         p.markBoundsDirty(true);
@@ -125,6 +264,7 @@ namespace paper
     {
         auto & cs = get<comps::Children>();
         std::reverse(cs.begin(), cs.end());
+        notifyChange(ItemChange::Structure);
     }
 
     void Item::remove()
@@ -136,6 +276,7 @@ namespace paper
     void Item::removeImpl(bool _bRemoveFromParent)
     {
         removeChildren();
+        detail::SpatialIndex::itemRemoved(*this);
 
         if (_bRemoveFromParent)
             removeFromParent();
@@ -150,8 +291,12 @@ namespace paper
             auto it = stick::find(cs.begin(), cs.end(), _item);
             if (it != cs.end())
             {
+                notifyChange(ItemChange::Structure);
                 _item.removeComponent<comps::Parent>();
+                _item.markAbsoluteTransformDirty();
+                _item.markStyleDirty();
                 cs.remove(it);
+                markAreaDirty(*this);
                 return true;
             }
         }
@@ -162,6 +307,7 @@ namespace paper
     {
         if (hasComponent<comps::Children>())
         {
+            notifyChange(ItemChange::Structure);
             auto & cs = get<comps::Children>();
             for (Item child : cs)
                 child.removeImpl(false);
@@ -201,8 +347,12 @@ namespace paper
                 auto & children = p.get<comps::Children>();
                 auto it = stick::find(children.begin(), children.end(), *this);
                 STICK_ASSERT(it != children.end());
+                p.notifyChange(ItemChange::Structure);
                 children.remove(it);
                 set<comps::Parent>(Item());
+                markAbsoluteTransformDirty();
+                markStyleDirty();
+                markAreaDirty(p);
                 p.markBoundsDirty(true);
             }
         }
@@ -211,23 +361,18 @@ namespace paper
     void Item::setTransform(const Mat3f & _transform, bool _bIncludesScaling)
     {
         set<comps::Transform>(_transform);
-        recursivePostTransform(_bIncludesScaling);
         if (hasComponent<comps::DecomposedTransform>())
             removeComponent<comps::DecomposedTransform>();
-    }
 
-    void Item::recursivePostTransform(bool _bIncludesScaling)
-    {
+        //everything in the subtree that depends on the absolute transform (the absolute
+        //transform itself, bounds, decomposition and mono curves) checks the transform
+        //versions when it is requested, so only this item needs to be touched here.
+        markAbsoluteTransformDirty();
         markBoundsDirty(true);
-        set<comps::AbsoluteTransformDirtyFlag>(true);
-        if (hasComponent<comps::AbsoluteDecomposedTransform>())
-            removeComponent<comps::AbsoluteDecomposedTransform>();
         if (_bIncludesScaling && remeshOnTransformChange())
         {
             markGeometryDirty(false);
         }
-        for (Item c : children())
-            c.recursivePostTransform(_bIncludesScaling);
     }
 
     void Item::setPosition(const Vec2f & _position)
@@ -428,29 +573,38 @@ namespace paper
 
     const Mat3f & Item::absoluteTransform() const
     {
-        if (hasComponent<comps::AbsoluteTransformDirtyFlag>())
-        {
-            if (get<comps::AbsoluteTransformDirtyFlag>())
-            {
-                Item p = parent();
-                if (!p.isValid())
-                {
-                    const_cast<Item *>(this)->set<comps::AbsoluteTransform>(transform());
-                }
-                else
-                {
-                    const_cast<Item *>(this)->set<comps::AbsoluteTransform>(p.absoluteTransform() * transform());
-                }
-                const_cast<Item *>(this)->set<comps::AbsoluteTransformDirtyFlag>(false);
-            }
-
-            return get<comps::AbsoluteTransform>();
-        }
+        if (const comps::AbsoluteTransformData * data = updateAbsoluteTransform(*this))
+            return data->transform;
 
         // return the proxy identity
         return transform();
     }
 
+    stick::UInt64 Item::absoluteTransformVersion() const
+    {
+        const comps::AbsoluteTransformData * data = updateAbsoluteTransform(*this);
+        return data ? data->version : 0;
+    }
+
+    stick::UInt64 Item::transformVersion() const
+    {
+        auto mversion = maybe<comps::TransformVersion>();
+        return mversion ? *mversion : 0;
+    }
+
+    stick::UInt64 Item::geometryVersion() const
+    {
+        auto mversion = maybe<comps::GeometryVersion>();
+        return mversion ? *mversion : 0;
+    }
+
+    stick::UInt64 Item::styleVersion() const
+    {
+        //resolving the style assigns a new version if anything it depends on changed
+        style();
+        return get<comps::ResolvedStyle>().version;
+    }
+
     void Item::decomposeIfNeeded() const
     {
         if (hasComponent<comps::DecomposedTransform>())
@@ -464,13 +618,15 @@ namespace paper
 
     void Item::decomposeAbsoluteIfNeeded() const
     {
-        if (hasComponent<comps::AbsoluteDecomposedTransform>())
+        stick::UInt64 version = absoluteTransformVersion();
+        auto maybe = this->maybe<comps::AbsoluteDecomposedTransform>();
+        if (maybe && (*maybe).version == version)
             return;
 
         Float rotation;
         Vec2f scaling, translation;
         crunch::decompose(absoluteTransform(), translation, rotation, scaling);
-        const_cast<Item *>(this)->set<comps::AbsoluteDecomposedTransform>((comps::DecomposedData) {translation, rotation, scaling});
+        const_cast<Item *>(this)->set<comps::AbsoluteDecomposedTransform>((comps::AbsoluteDecomposedData) {{translation, rotation, scaling}, version});
     }
 
     stick::Float32 Item::rotation() const
@@ -494,19 +650,19 @@ namespace paper
     const Vec2f & Item::absoluteScaling() const
     {
         decomposeAbsoluteIfNeeded();
-        return get<comps::AbsoluteDecomposedTransform>().scaling;
+        return get<comps::AbsoluteDecomposedTransform>().decomposed.scaling;
     }
 
     const Vec2f & Item::absoluteTranslation() const
     {
         decomposeAbsoluteIfNeeded();
-        return get<comps::AbsoluteDecomposedTransform>().translation;
+        return get<comps::AbsoluteDecomposedTransform>().decomposed.translation;
     }
 
     Float Item::absoluteRotation() const
     {
         decomposeAbsoluteIfNeeded();
-        return get<comps::AbsoluteDecomposedTransform>().rotation;
+        return get<comps::AbsoluteDecomposedTransform>().decomposed.rotation;
     }
 
     Vec2f Item::strokePadding(Float _strokeWidth, const Mat3f & _mat) const
@@ -574,13 +730,15 @@ namespace paper
         ret = {true, Rect(0, 0, 0, 0)};
         if (itemType == EntityType::Path)
         {
+            //in absolute mode, _transform is the absolute transform of this item if the caller knows it already
+            const Mat3f * transform = _bAbsolute && !_transform ? &absoluteTransform() : _transform;
             Path p = brick::reinterpretEntity<Path>(*this);
             if (_type == BoundsType::Fill)
-                ret = p.computeBounds(_bAbsolute ? &absoluteTransform() : _transform);
+                ret = p.computeBounds(transform);
             else if (_type == BoundsType::Stroke)
-                ret = p.computeStrokeBounds(_bAbsolute ? &absoluteTransform() : _transform);
+                ret = p.computeStrokeBounds(transform);
             else if (_type == BoundsType::Handle)
-                ret = p.computeHandleBounds(_bAbsolute ? &absoluteTransform() : _transform);
+                ret = p.computeHandleBounds(transform);
         }
         else if (itemType == EntityType::Group)
         {
@@ -589,7 +747,7 @@ namespace paper
             if (grp.isClipped())
             {
                 if (grp.children().count())
-                    return grp.children()[0].computeBounds(_transform, _type, _bAbsolute);
+                    return grp.children()[0].computeBounds(_bAbsolute ? nullptr : _transform, _type, _bAbsolute);
                 else
                     return {true, Rect(0, 0, 0, 0)};
             }
@@ -599,7 +757,7 @@ namespace paper
             //for placed symbols, compute the bounds of the referenced item
             //with the placed symbols transform.
             PlacedSymbol s = brick::reinterpretEntity<PlacedSymbol>(*this);
-            return s.symbol().item().computeBounds(_bAbsolute ? &s.absoluteTransform() : _transform, _type, false);
+            return s.symbol().item().computeBounds(_bAbsolute && !_transform ? &s.absoluteTransform() : _transform, _type, false);
         }
 
         // simply merge the children bounds recursively
@@ -613,13 +771,28 @@ namespace paper
                 return ret;
         }
 
+        //the children compute their absolute transforms from ours, instead of walking up to the root each
+        comps::AbsoluteTransformData parentData;
+        const comps::AbsoluteTransformData * pd = nullptr;
+        stick::UInt64 latest = 0;
+        if (_bAbsolute)
+        {
+            latest = documentState(*this).transformVersion;
+            if ((pd = updateAbsoluteTransform(*this, latest)))
+            {
+                parentData = *pd;
+                pd = &parentData;
+            }
+        }
+
         Mat3f tmpMat;
         auto it = cs.begin();
         for (; it !=  cs.end(); ++it)
         {
             if (_bAbsolute)
             {
-                tmp = (*it).computeBounds(&(*it).absoluteTransform(), _type, true);
+                const comps::AbsoluteTransformData * cd = updateAbsoluteTransform(*it, *this, pd, latest);
+                tmp = (*it).computeBounds(cd ? &cd->transform : &(*it).transform(), _type, true);
             }
             else
             {
@@ -660,12 +833,14 @@ namespace paper
     void Item::setVisible(bool _b)
     {
         set<comps::VisibilityFlag>(_b);
+        notifyChange(ItemChange::Structure);
     }
 
     void Item::setStrokeJoin(StrokeJoin _join)
     {
         set<comps::StrokeJoin>(_join);
         removeComponentFromChildren<comps::StrokeJoin>(*this);
+        markStyleDirty();
         markStrokeBoundsDirty(true);
         markStrokeGeometryDirty();
     }
@@ -674,6 +849,7 @@ namespace paper
     {
         set<comps::StrokeCap>(_cap);
         removeComponentFromChildren<comps::StrokeCap>(*this);
+        markStyleDirty();
         markStrokeBoundsDirty(true);
         markStrokeGeometryDirty();
     }
@@ -681,6 +857,7 @@ namespace paper
     void Item::setStrokeScaling(bool _b)
     {
         set<comps::ScalingStrokeFlag>(_b);
+        markStyleDirty();
         markStrokeBoundsDirty(true);
         markStrokeGeometryDirty();
     }
@@ -689,6 +866,7 @@ namespace paper
     {
         set<comps::MiterLimit>(_limit);
         removeComponentFromChildren<comps::MiterLimit>(*this);
+        markStyleDirty();
         markStrokeBoundsDirty(true);
         markStrokeGeometryDirty();
     }
@@ -697,6 +875,7 @@ namespace paper
     {
         set<comps::StrokeWidth>(_width);
         removeComponentFromChildren<comps::StrokeWidth>(*this);
+        markStyleDirty();
         markStrokeBoundsDirty(true);
         markStrokeGeometryDirty();
     }
@@ -705,6 +884,7 @@ namespace paper
     {
         set<comps::DashArray>(_arr);
         removeComponentFromChildren<comps::DashArray>(*this);
+        markStyleDirty();
         markStrokeBoundsDirty(true);
         markStrokeGeometryDirty();
     }
@@ -713,6 +893,7 @@ namespace paper
     {
         set<comps::DashOffset>(_offset);
         removeComponentFromChildren<comps::DashOffset>(*this);
+        markStyleDirty();
         markStrokeGeometryDirty();
     }
 
@@ -726,6 +907,7 @@ namespace paper
 
         set<comps::Stroke>(_color);
         removeComponentFromChildren<comps::Stroke>(*this);
+        markStyleDirty();
     }
 
     void Item::setStroke(const stick::String & _name)
@@ -735,19 +917,41 @@ namespace paper
 
     void Item::setStroke(LinearGradient _gradient)
     {
+        if (!hasStroke())
+        {
+            markStrokeGeometryDirty();
+            markStrokeBoundsDirty(true);
+        }
+
+        set<comps::Stroke>(_gradient);
+        removeComponentFromChildren<comps::Stroke>(*this);
+        markStyleDirty();
+    }
+
+    void Item::setStroke(RadialGradient _gradient)
+    {
+        if (!hasStroke())
+        {
+            markStrokeGeometryDirty();
+            markStrokeBoundsDirty(true);
+        }
+
         set<comps::Stroke>(_gradient);
         removeComponentFromChildren<comps::Stroke>(*this);
+        markStyleDirty();
     }
 
     void Item::setNoStroke()
     {
         set<comps::Stroke>(NoPaint());
         removeComponentFromChildren<comps::Stroke>(*this);
+        markStyleDirty();
     }
 
     void Item::removeStroke()
     {
         removeComponent<comps::Stroke>();
+        markStyleDirty();
         markStrokeBoundsDirty(true);
     }
 
@@ -755,12 +959,14 @@ namespace paper
     {
         set<comps::Fill>(NoPaint());
         removeComponentFromChildren<comps::Fill>(*this);
+        markStyleDirty();
     }
 
     void Item::setFill(const ColorRGBA & _color)
     {
         set<comps::Fill>(_color);
         removeComponentFromChildren<comps::Fill>(*this);
+        markStyleDirty();
     }
 
     void Item::setFill(const stick::String & _name)
@@ -772,11 +978,20 @@ namespace paper
     {
         set<comps::Fill>(_gradient);
         removeComponentFromChildren<comps::Fill>(*this);
+        markStyleDirty();
+    }
+
+    void Item::setFill(RadialGradient _gradient)
+    {
+        set<comps::Fill>(_gradient);
+        removeComponentFromChildren<comps::Fill>(*this);
+        markStyleDirty();
     }
 
     void Item::removeFill()
     {
         removeComponent<comps::Fill>();
+        markStyleDirty();
     }
 
     void Item::setRemeshOnTransformChange(bool _b)
@@ -788,63 +1003,86 @@ namespace paper
     void Item::setWindingRule(WindingRule _rule)
     {
         set<comps::WindingRule>(_rule);
+        markStyleDirty();
     }
 
-    Paint Item::fill() const
+    const PathStyle & Item::style() const
     {
-        auto ret = findComponent<comps::Fill>();
-        if (ret)
+        Item self = *this;
+        if (!self.hasComponent<comps::ResolvedStyle>())
+            self.set<comps::ResolvedStyle>((comps::ResolvedStyleData) {true, PathStyle(), 0});
+
+        auto & rs = self.get<comps::ResolvedStyle>();
+        if (rs.bDirty)
         {
-            return *ret;
+            //resolving the parent first ensures that the parents of a clean item are clean, too.
+            Item p = parent();
+            if (p.isValid())
+                rs.style = p.style();
+            else
+                rs.style = PathStyle();
+
+            PathStyle & style = rs.style;
+            if (auto m = self.maybe<comps::Fill>())
+                style.fill = *m;
+            if (auto m = self.maybe<comps::Stroke>())
+                style.stroke = *m;
+            if (auto m = self.maybe<comps::StrokeWidth>())
+                style.strokeWidth = *m;
+            if (auto m = self.maybe<comps::MiterLimit>())
+                style.miterLimit = *m;
+            if (auto m = self.maybe<comps::StrokeJoin>())
+                style.join = *m;
+            if (auto m = self.maybe<comps::StrokeCap>())
+                style.cap = *m;
+            if (auto m = self.maybe<comps::DashArray>())
+                style.dashArray = *m;
+            if (auto m = self.maybe<comps::DashOffset>())
+                style.dashOffset = *m;
+            if (auto m = self.maybe<comps::WindingRule>())
+                style.windingRule = *m;
+            if (auto m = self.maybe<comps::ScalingStrokeFlag>())
+                style.bScalingStroke = *m;
+            rs.bDirty = false;
+            rs.version = ++s_version;
         }
-        return NoPaint();
+        return rs.style;
+    }
+
+    const Paint & Item::fill() const
+    {
+        return style().fill;
     }
 
     Float Item::fillOpacity() const
     {
-        Paint s = fill();
-        if (auto mb = s.maybe<ColorRGBA>())
-            return (*mb).a;
+        const Paint & s = fill();
+        if (s.is<ColorRGBA>())
+            return s.get<ColorRGBA>().a;
         return 1.0; //should this be zero?
     }
 
     Float Item::strokeOpacity() const
     {
-        Paint s = stroke();
-        if (auto mb = s.maybe<ColorRGBA>())
-            return (*mb).a;
+        const Paint & s = stroke();
+        if (s.is<ColorRGBA>())
+            return s.get<ColorRGBA>().a;
         return 1.0; //should this be zero?
     }
 
-    Paint Item::stroke() const
+    const Paint & Item::stroke() const
     {
-        auto ret = findComponent<comps::Stroke>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return NoPaint();
+        return style().stroke;
     }
 
     const DashArray & Item::dashArray() const
     {
-        auto ret = findComponent<comps::DashArray>();
-        if (ret)
-        {
-            return *ret;
-        }
-        static DashArray s_proxy;
-        return s_proxy;
+        return style().dashArray;
     }
 
     Float Item::dashOffset() const
     {
-        auto ret = findComponent<comps::DashOffset>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return 0.0;
+        return style().dashOffset;
     }
 
     bool Item::remeshOnTransformChange() const
@@ -860,124 +1098,102 @@ namespace paper
 
     bool Item::hasStroke() const
     {
-        auto maybe = findComponent<comps::Stroke>();
-        if (maybe)
-        {
-            return !(*maybe).is<NoPaint>();
-        }
-        return false;
+        return !style().stroke.is<NoPaint>();
     }
 
     bool Item::hasFill() const
     {
-        auto maybe = findComponent<comps::Fill>();
-        if (maybe)
-        {
-            return !(*maybe).is<NoPaint>();
-        }
-        return false;
+        return !style().fill.is<NoPaint>();
     }
 
     StrokeJoin Item::strokeJoin() const
     {
-        auto ret = findComponent<comps::StrokeJoin>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return StrokeJoin::Miter;
+        return style().join;
     }
 
     StrokeCap Item::strokeCap() const
     {
-        auto ret = findComponent<comps::StrokeCap>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return StrokeCap::Butt;
+        return style().cap;
     }
 
     Float Item::strokeWidth() const
     {
-        auto ret = findComponent<comps::StrokeWidth>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return (Float)1.0;
+        return style().strokeWidth;
     }
 
     Float Item::miterLimit() const
     {
-        auto ret = findComponent<comps::MiterLimit>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return (Float)10.0;
+        return style().miterLimit;
     }
 
     bool Item::isScalingStroke() const
     {
-        auto ret = findComponent<comps::ScalingStrokeFlag>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return true;
+        return style().bScalingStroke;
     }
 
     WindingRule Item::windingRule() const
     {
-        auto ret = findComponent<comps::WindingRule>();
-        if (ret)
-        {
-            return *ret;
-        }
-        return WindingRule::EvenOdd;
+        return style().windingRule;
     }
 
     const Rect & Item::bounds() const
     {
+        if (documentState(*this).bBatchOpen)
+            document().propagateBatchedBounds();
+        stick::UInt64 version = absoluteTransformVersion();
         auto & b = const_cast<Item *>(this)->get<comps::Bounds>();
-        if (b.bDirty)
+        if (b.bDirty || b.transformVersion != version)
         {
             b.bounds = computeBounds(nullptr, BoundsType::Fill, true).rect;
             b.bDirty = false;
+            b.transformVersion = version;
+            ++documentState(*this).boundsEpoch;
         }
         return b.bounds;
     }
 
     const Rect & Item::localBounds() const
     {
+        if (documentState(*this).bBatchOpen)
+            document().propagateBatchedBounds();
         auto & b = const_cast<Item *>(this)->get<comps::LocalBounds>();
         if (b.bDirty)
         {
             b.bounds = computeBounds(nullptr, BoundsType::Fill, false).rect;
             b.bDirty = false;
+            ++documentState(*this).boundsEpoch;
         }
         return b.bounds;
     }
 
     const Rect & Item::strokeBounds() const
     {
+        if (documentState(*this).bBatchOpen)
+            document().propagateBatchedBounds();
+        stick::UInt64 version = absoluteTransformVersion();
         auto & b = const_cast<Item *>(this)->get<comps::StrokeBounds>();
-        if (b.bDirty)
+        if (b.bDirty || b.transformVersion != version)
         {
             b.bounds = computeBounds(nullptr, BoundsType::Stroke, true).rect;
             b.bDirty = false;
+            b.transformVersion = version;
+            ++documentState(*this).boundsEpoch;
         }
         return b.bounds;
     }
 
     const Rect & Item::handleBounds() const
     {
+        if (documentState(*this).bBatchOpen)
+            document().propagateBatchedBounds();
+        stick::UInt64 version = absoluteTransformVersion();
         auto & b = const_cast<Item *>(this)->get<comps::HandleBounds>();
-        if (b.bDirty)
+        if (b.bDirty || b.transformVersion != version)
         {
             b.bounds = computeBounds(nullptr, BoundsType::Handle, true).rect;
             b.bDirty = false;
+            b.transformVersion = version;
+            ++documentState(*this).boundsEpoch;
         }
         return b.bounds;
     }
@@ -1009,29 +1225,26 @@ namespace paper
 
     void Item::markBoundsDirty(bool _bNotifyParent)
     {
-        markStrokeBoundsDirty(false);
-        markFillBoundsDirty(false);
-        if (_bNotifyParent)
-        {
-            Item p = parent();
-            if (p.isValid())
-            {
-                p.markBoundsDirty(true);
-            }
-        }
+        markStrokeBoundsDirty(_bNotifyParent);
+        markFillBoundsDirty(_bNotifyParent);
     }
 
     void Item::markStrokeBoundsDirty(bool _bNotifyParent)
     {
         auto & sbounds = get<comps::StrokeBounds>();
         sbounds.bDirty = true;
+        //the handle bounds contain the stroke bounds
+        auto & hbounds = get<comps::HandleBounds>();
+        hbounds.bDirty = true;
         if (_bNotifyParent)
         {
-            Item p = parent();
-            if (p.isValid())
-            {
-                p.markStrokeBoundsDirty(true);
-            }
+            notifyChange(ItemChange::Bounds);
+            markParentBoundsDirty(true);
+        }
+        else
+        {
+            //this is a parent of the item that changed, see propagateBoundsDirty()
+            detail::SpatialIndex::itemChanged(*this);
         }
     }
 
@@ -1041,27 +1254,184 @@ namespace paper
         bounds.bDirty = true;
         auto & lbounds = get<comps::LocalBounds>();
         lbounds.bDirty = true;
+        auto & hbounds = get<comps::HandleBounds>();
+        hbounds.bDirty = true;
         set<comps::BoundsGeometryDirtyFlag>(true);
         if (_bNotifyParent)
         {
-            Item p = parent();
-            if (p.isValid())
-            {
-                p.markFillBoundsDirty(true);
-            }
+            notifyChange(ItemChange::Bounds);
+            markParentBoundsDirty(false);
+        }
+        else
+        {
+            detail::SpatialIndex::itemChanged(*this);
+        }
+    }
+
+    void Item::markParentBoundsDirty(bool _bStroke)
+    {
+        auto & state = documentState(*this);
+        if (!state.bBatchOpen)
+        {
+            propagateBoundsDirty(*this, _bStroke, state.boundsEpoch);
+            return;
+        }
+
+        auto mbatch = document().maybe<comps::Batch>();
+
+        if (!hasComponent<comps::BoundsPropagation>())
+            set<comps::BoundsPropagation>((comps::BoundsPropagationData) {0, 0, false, false});
+
+        auto & prop = get<comps::BoundsPropagation>();
+        if (!prop.bStrokePending && !prop.bFillPending)
+            (*mbatch).pendingBounds.append(*this);
+        if (_bStroke)
+            prop.bStrokePending = true;
+        else
+            prop.bFillPending = true;
+    }
+
+    void Item::propagateBatchedBounds()
+    {
+        auto mbatch = maybe<comps::Batch>();
+        if (!mbatch)
+            return;
+
+        //marking the parents dirty does not queue anything, so the array stays the same
+        ItemArray & pending = (*mbatch).pendingBounds;
+        stick::UInt64 epoch = documentState(*this).boundsEpoch;
+        for (Item & item : pending)
+        {
+            auto mprop = item.isValid() ? item.maybe<comps::BoundsPropagation>() : stick::Maybe<comps::BoundsPropagationData &>();
+            if (!mprop)
+                continue;
+
+            bool bStroke = (*mprop).bStrokePending;
+            bool bFill = (*mprop).bFillPending;
+            (*mprop).bStrokePending = false;
+            (*mprop).bFillPending = false;
+            if (bStroke)
+                propagateBoundsDirty(item, true, epoch);
+            if (bFill)
+                propagateBoundsDirty(item, false, epoch);
+        }
+        pending.clear();
+    }
+
+    void Item::notifyChange(stick::UInt32 _flags)
+    {
+        if (!documentState(*this).bBatchOpen)
+        {
+            dispatchChange(_flags);
+            return;
+        }
+
+        Document doc = document();
+
+        if (!hasComponent<comps::BatchEntry>())
+        {
+            auto & changes = doc.get<comps::Batch>().changes;
+            set<comps::BatchEntry>((comps::BatchEntryData) {changes.count(), 0});
+            changes.append({*this, 0});
+        }
+
+        auto & batch = doc.get<comps::Batch>();
+        auto & entry = get<comps::BatchEntry>();
+        batch.changes[entry.index].flags |= _flags;
+        if (!entry.pendingFlags)
+            batch.pendingChanges.append(entry.index);
+        entry.pendingFlags |= _flags;
+    }
+
+    void Item::dispatchChange(stick::UInt32 _flags)
+    {
+        //a list that gets re-recorded picks up all other changes, too
+        if (_flags & ItemChange::Structure)
+            DisplayList::structureChanged(*this);
+        else if (_flags & (ItemChange::FillGeometry | ItemChange::StrokeGeometry | ItemChange::Style | ItemChange::Transform))
+            DisplayList::itemChanged(*this);
+
+        if (_flags & ItemChange::Transform)
+            detail::SpatialIndex::subtreeChanged(*this);
+        else if (_flags & ItemChange::Bounds)
+            detail::SpatialIndex::itemChanged(*this);
+    }
+
+    void Item::flushBatch()
+    {
+        propagateBatchedBounds();
+
+        auto mbatch = maybe<comps::Batch>();
+        if (!mbatch)
+            return;
+
+        //dispatching does not add to the journal, so the arrays stay the same
+        auto & batch = *mbatch;
+        for (stick::Size idx : batch.pendingChanges)
+        {
+            Item item = batch.changes[idx].item;
+            //the item was removed during the batch
+            if (!item.isValid())
+                continue;
+
+            auto & entry = item.get<comps::BatchEntry>();
+            stick::UInt32 flags = entry.pendingFlags;
+            entry.pendingFlags = 0;
+            item.dispatchChange(flags);
+        }
+        batch.pendingChanges.clear();
+    }
+
+    void Item::openBatch()
+    {
+        if (!hasComponent<comps::Batch>())
+        {
+            set<comps::Batch>((comps::BatchData) {0, ItemArray(), ItemChangeArray(), stick::DynamicArray<stick::Size>()});
+            documentState(*this).bBatchOpen = true;
         }
+        ++get<comps::Batch>().depth;
+    }
+
+    ItemChangeArray Item::closeBatch()
+    {
+        STICK_ASSERT(hasComponent<comps::Batch>());
+        auto & batch = get<comps::Batch>();
+        STICK_ASSERT(batch.depth > 0);
+        if (--batch.depth)
+            return ItemChangeArray();
+
+        flushBatch();
+
+        ItemChangeArray ret;
+        auto & changes = get<comps::Batch>().changes;
+        ret.reserve(changes.count());
+        for (ItemChange & change : changes)
+        {
+            if (!change.item.isValid())
+                continue;
+            change.item.removeComponent<comps::BatchEntry>();
+            ret.append(change);
+        }
+        removeComponent<comps::Batch>();
+        documentState(*this).bBatchOpen = false;
+        return ret;
     }
 
     void Item::markAbsoluteTransformDirty()
     {
-        set<comps::AbsoluteTransformDirtyFlag>(true);
-        for (Item c : children())
-            c.markAbsoluteTransformDirty();
+        //the caches of the children pick this up through updateAbsoluteTransform()
+        stick::UInt64 version = ++s_version;
+        set<comps::TransformVersion>(version);
+        documentState(*this).transformVersion = version;
+        notifyChange(ItemChange::Transform);
     }
 
     void Item::markFillGeometryDirty()
     {
         set<comps::FillGeometryDirtyFlag>(true);
+        set<comps::GeometryVersion>(++s_version);
+        markAreaDirty(*this);
+        notifyChange(ItemChange::FillGeometry);
         if (hasComponent<detail::comps::MonoCurves>())
             removeComponent<detail::comps::MonoCurves>();
     }
@@ -1069,6 +1439,25 @@ namespace paper
     void Item::markStrokeGeometryDirty()
     {
         set<comps::StrokeGeometryDirtyFlag>(true);
+        notifyChange(ItemChange::StrokeGeometry);
+    }
+
+    static void markResolvedStyleDirty(Item _item)
+    {
+        auto maybe = _item.maybe<comps::ResolvedStyle>();
+        //a dirty item can't have clean children, see style()
+        if (!maybe || (*maybe).bDirty)
+            return;
+
+        (*maybe).bDirty = true;
+        for (Item c : _item.children())
+            markResolvedStyleDirty(c);
+    }
+
+    void Item::markStyleDirty()
+    {
+        notifyChange(ItemChange::Style);
+        markResolvedStyleDirty(*this);
     }
 
     void Item::markGeometryDirty(bool _bMarkLengthDirty)
@@ -1076,79 +1465,130 @@ namespace paper
         markFillGeometryDirty();
         markStrokeGeometryDirty();
         if (_bMarkLengthDirty)
-            set<comps::PathLength>((comps::PathLengthData) {true, 0.0f});
+            set<comps::PathLength>((comps::PathLengthData) {true, 0.0f, 0});
     }
 
-    static Item cloneImpl(const Item & _item);
+    //clones are built bottom up without going through addChild() or addSegment(), so none
+    //of the caches of the copied items are invalidated on the way. Items that are cloned
+    //into a new document (_doc) get moved over to it.
+    static Item cloneImpl(const Item & _item, const Document * _doc);
 
-    static Item cloneGroup(const Item & _grp)
+    static void cloneChildren(const Item & _from, Item & _copy, const Document * _doc)
     {
-        STICK_ASSERT(_grp.isValid());
-        Group copy = brick::reinterpretEntity<Group>(_grp.cloneWithout<comps::Parent, comps::Children>());
-        STICK_ASSERT(copy);
-        STICK_ASSERT(copy.isValid());
-        for (const Item & child : _grp.children())
+        const ItemArray & children = _from.children();
+        _copy.set<comps::Children>(ItemArray());
+        ItemArray & copies = _copy.get<comps::Children>();
+        copies.reserve(children.count());
+        for (const Item & child : children)
         {
-            copy.addChild(cloneImpl(child));
+            Item c = cloneImpl(child, _doc);
+            c.set<comps::Parent>(_copy);
+            copies.append(c);
         }
-
-        return copy;
     }
 
-    static Item clonePath(const Item & _path)
+    //copies all components of _item except the ones that tie it to its place in the hierarchy,
+    //its batch or the caches of its document. C names additional ones to leave out.
+    template<class...C>
+    static Item cloneEntity(const Item & _item)
     {
-        Path from = brick::reinterpretEntity<Path>(_path);
-        Path copy = brick::reinterpretEntity<Path>(from.cloneWithout<comps::Parent,
-                    comps::Segments,
-                    comps::Curves,
-                    comps::ClosedFlag>());
+        return brick::reinterpretEntity<Item>(_item.cloneWithout<comps::Parent,
+                                              comps::Children,
+                                              comps::BoundsPropagation,
+                                              comps::BatchEntry,
+                                              detail::comps::SpatialIndexNode,
+                                              detail::comps::DisplayListNodes,
+                                              C...>());
+    }
 
-        // @TODO: Move this default comp stuff for path into a separate function
-        // shared with createPath().
-        copy.set<comps::Segments>(SegmentArray());
-        copy.set<comps::Curves>(CurveArray());
-        copy.set<comps::Children>(ItemArray());
-        copy.set<comps::ClosedFlag>(false);
+    static Item cloneGroup(const Item & _grp, const Document * _doc)
+    {
+        STICK_ASSERT(_grp.isValid());
+        Item copy = cloneEntity(_grp);
+        STICK_ASSERT(copy.isValid());
+        cloneChildren(_grp, copy, _doc);
+        return copy;
+    }
 
-        for (const auto & seg : from.segmentArray())
-        {
-            copy.addSegment(seg->position(), seg->handleIn(), seg->handleOut());
-        }
+    static Item clonePath(const Item & _path, const Document * _doc)
+    {
+        //the segment and curve arrays are copied in one go, together with the cached
+        //bounds, length, area and mono curves which are all still valid for the copy.
+        Item copy = cloneEntity(_path);
+        STICK_ASSERT(copy.isValid());
+        cloneChildren(_path, copy, _doc);
+        return copy;
+    }
 
-        if (from.isClosed())
-        {
-            copy.closePath();
-        }
+    static Item clonePlacedSymbol(const Item & _ps)
+    {
+        Item copy = cloneEntity(_ps);
+        STICK_ASSERT(copy.isValid());
 
-        for (Item child : from.children())
+        //the symbol keeps track of all of its placed instances
+        Symbol & s = copy.get<comps::ReferencedSymbol>();
+        if (s.isValid())
         {
-            copy.addChild(cloneImpl(child));
+            if (!s.hasComponent<comps::PlacedSymbols>())
+                s.set<comps::PlacedSymbols>(PlacedSymbolArray());
+            s.get<comps::PlacedSymbols>().append(brick::reinterpretEntity<PlacedSymbol>(copy));
         }
+        return copy;
+    }
 
-        copy.markGeometryDirty(false);
-
+    static Item cloneDocument(const Item & _doc)
+    {
+        //the spatial index and display lists refer to the items of the original document
+        Document copy = brick::reinterpretEntity<Document>(cloneEntity<comps::Batch,
+                        detail::comps::SpatialIndexHolder,
+                        detail::comps::DisplayLists>(_doc));
+        STICK_ASSERT(copy.isValid());
+        //the copy starts out without a batch
+        copy.get<comps::DocumentState>().bBatchOpen = false;
+        cloneChildren(_doc, copy, &copy);
         return copy;
     }
 
-    static Item cloneImpl(const Item & _item)
+    static Item cloneImpl(const Item & _item, const Document * _doc)
     {
-        //@TODO: add clone functions for symbols and documents
-        if (_item.get<comps::ItemType>() == EntityType::Group)
-        {
-            return cloneGroup(_item);
-        }
-        else if (_item.get<comps::ItemType>() == EntityType::Path)
+        Item ret;
+        switch (_item.get<comps::ItemType>())
         {
-            return clonePath(_item);
+        case EntityType::Group:
+            ret = cloneGroup(_item, _doc);
+            break;
+        case EntityType::Path:
+            ret = clonePath(_item, _doc);
+            break;
+        case EntityType::PlacedSymbol:
+            ret = clonePlacedSymbol(_item);
+            break;
+        case EntityType::Document:
+            return cloneDocument(_item);
+        default:
+            return Item();
         }
+
+        if (_doc)
+            ret.set<comps::Doc>(*_doc);
+        return ret;
     }
 
     Item Item::clone() const
     {
-        Item ret = cloneImpl(*this);
-        if (ret)
+        //the copies have to start out with up to date bounds
+        if (documentState(*this).bBatchOpen)
+            document().propagateBatchedBounds();
+        Item ret = cloneImpl(*this, nullptr);
+        //documents don't have a parent to be added to
+        if (ret && hasComponent<comps::Parent>() && parent().isValid())
         {
             ret.insertAbove(*this);
+            //the copy sits next to the original, so the absolute transforms (and all the
+            //caches that depend on them) copied over from it are still valid.
+            if (auto version = maybe<comps::TransformVersion>())
+                ret.set<comps::TransformVersion>(*version);
+            detail::SpatialIndex::subtreeChanged(ret);
         }
         return ret;
     }
@@ -1156,9 +1596,10 @@ namespace paper
     Document Item::document() const
     {
         //the only item without this component is the root, document object
-        if (!hasComponent<comps::Doc>())
+        auto mdoc = maybe<comps::Doc>();
+        if (!mdoc)
             return static_cast<const Document &>(*this);
-        return get<comps::Doc>();
+        return *mdoc;
     }
 
     EntityType Item::itemType() const
@@ -1170,9 +1611,10 @@ namespace paper
     {
         if (_doc)
             _item.set<comps::Doc>(*_doc);
-        _item.set<comps::StrokeBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
-        _item.set<comps::Bounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
-        _item.set<comps::LocalBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
-        _item.set<comps::HandleBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
+        _item.set<comps::StrokeBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        _item.set<comps::Bounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        _item.set<comps::LocalBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        _item.set<comps::HandleBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        _item.set<comps::ResolvedStyle>((comps::ResolvedStyleData) {true, PathStyle(), 0});
     }
 }
@@ -10,6 +10,8 @@ namespace paper
 
     class Item;
     using ItemArray = stick::DynamicArray<Item>;
+    struct ItemChange;
+    using ItemChangeArray = stick::DynamicArray<ItemChange>;
 
     class STICK_API Item : public brick::TypedEntity
     {
@@ -113,6 +115,23 @@ namespace paper
 
         const Mat3f & absoluteTransform() const;
 
+        //changes whenever the absolute transform possibly changed, i.e. if the transform of this
+        //item or one of its ancestors changed or any of them got moved to a different parent.
+        stick::UInt64 absoluteTransformVersion() const;
+
+        //versions for external caches (i.e. meshes of a renderer). Each of them changes whenever
+        //the respective data of the item possibly changed and is zero if it was never set. They
+        //are never reused, so a cache only needs to compare them to the ones it was built with.
+
+        //changes when the transform of this item is set or it is moved to a different parent.
+        stick::UInt64 transformVersion() const;
+
+        //changes when the segments of this path (or its remeshed transform) change.
+        stick::UInt64 geometryVersion() const;
+
+        //changes when a style setter of this item or one of its parents ran, see style().
+        stick::UInt64 styleVersion() const;
+
         stick::Float32 rotation() const;
 
         const Vec2f & translation() const;
@@ -158,6 +177,8 @@ namespace paper
 
         void setStroke(LinearGradient _gradient);
 
+        void setStroke(RadialGradient _gradient);
+
         void setDashArray(const DashArray & _arr);
 
         void setDashOffset(Float _f);
@@ -176,6 +197,8 @@ namespace paper
 
         void setFill(LinearGradient _gradient);
 
+        void setFill(RadialGradient _gradient);
+
         void setRemeshOnTransformChange(bool _b);
 
         void removeFill();
@@ -204,9 +227,13 @@ namespace paper
 
         bool isScalingStroke() const;
 
-        Paint fill() const;
+        const Paint & fill() const;
+
+        const Paint & stroke() const;
 
-        Paint stroke() const;
+        //all style values of this item, inherited values included. The result is
+        //cached until a style setter of this item or one of its parents runs.
+        const PathStyle & style() const;
 
         bool hasStroke() const;
 
@@ -235,6 +262,8 @@ namespace paper
 
         void markFillBoundsDirty(bool _bNotifyParent);
 
+        void markStyleDirty();
+
 
         static Mat3f strokeTransform(const Mat3f * _transform, Float _strokeWidth, bool _bIsScalingStroke);
 
@@ -257,8 +286,6 @@ namespace paper
 
     protected:
 
-        void recursivePostTransform(bool _bIncludesScaling);
-
         void removeFromParent();
 
         void removeImpl(bool _bRemoveFromParent);
@@ -269,6 +296,27 @@ namespace paper
 
         void decomposeAbsoluteIfNeeded() const;
 
+        //marks the stroke (_bStroke) or fill bounds of all parents dirty, deferred to the
+        //end of the batch if one is open.
+        void markParentBoundsDirty(bool _bStroke);
+
+        //called on a document, marks the parents of the items edited during the batch dirty
+        void propagateBatchedBounds();
+
+        //lets the spatial index and display lists know that this item changed (_flags are
+        //ItemChange::Flags). If a batch is open, the change is added to its journal instead.
+        void notifyChange(stick::UInt32 _flags);
+
+        void dispatchChange(stick::UInt32 _flags);
+
+        //called on a document, propagates the bounds and dispatches the changes of the open batch
+        void flushBatch();
+
+        //called on a document, see Document::beginBatch() and Document::endBatch()
+        void openBatch();
+
+        ItemChangeArray closeBatch();
+
         struct BoundsResult
         {
             bool bEmpty;
@@ -277,6 +325,29 @@ namespace paper
 
         BoundsResult computeBounds(const Mat3f * _transform, BoundsType _type, bool _bAbsolute) const;
     };
+
+    //an item that changed during a batch and what changed about it, see Document::endBatch()
+    struct STICK_API ItemChange
+    {
+        enum Flags
+        {
+            //the segments of a path or whether it is closed
+            FillGeometry = 1 << 0,
+            //anything that changes the outline of the stroke
+            StrokeGeometry = 1 << 1,
+            //paints and the other style attributes, including the ones inherited from the parents
+            Style = 1 << 2,
+            //the absolute transform of the item and its children
+            Transform = 1 << 3,
+            //the bounds of the item. Parents that are only dirty because of their children are not listed.
+            Bounds = 1 << 4,
+            //children were added, removed or reordered, or the visibility or clipping changed
+            Structure = 1 << 5
+        };
+
+        Item item;
+        stick::UInt32 flags;
+    };
 }
 
 #endif //PAPER_ITEM_HPP
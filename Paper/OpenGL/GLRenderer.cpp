@@ -397,6 +397,24 @@ namespace paper
             }
 
             RenderCacheData & cache = p.get<RenderCache>();
+
+            //the geometry depends on the scaling (and for non scaling strokes, the rotation)
+            //of the absolute transform. Moving a parent doesn't mark the geometry of its
+            //children dirty, so compare against the transform it was built for instead.
+            UInt64 transformVersion = p.absoluteTransformVersion();
+            if (cache.meshTransformVersion != transformVersion)
+            {
+                const Mat3f & m = p.absoluteTransform();
+                if (!(m[0] == cache.meshTransform[0] && m[1] == cache.meshTransform[1]) && p.remeshOnTransformChange())
+                {
+                    if (p.hasComponent<comps::FillGeometryDirtyFlag>())
+                        p.set<comps::FillGeometryDirtyFlag>(true);
+                    p.set<comps::StrokeGeometryDirtyFlag>(true);
+                }
+                cache.meshTransform = m;
+                cache.meshTransformVersion = transformVersion;
+            }
+
             if (_bIsClipping || _style.bHasFill || _style.strokeWidth > 0)
             {
                 cache.transformProjection = m_transformProjection * crunch::to3DTransform(p.absoluteTransform());
@@ -98,6 +98,9 @@ namespace paper
                 PathGeometryArray strokeVertices;
                 PathGeometryArray strokeBoundsVertices;
                 crunch::Mat4f transformProjection;
+                //the absolute transform the geometry was built for and its version
+                Mat3f meshTransform;
+                stick::UInt64 meshTransformVersion;
                 stick::UInt32 strokeVertexDrawMode;
                 TextureGeometryArray textureVertices;
             };
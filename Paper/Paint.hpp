@@ -120,6 +120,34 @@ namespace paper
 
     struct STICK_API NoPaint {};
     using Paint = stick::Variant<NoPaint, ColorRGBA, LinearGradient, RadialGradient>;
+
+    //the style of an item with all inherited values resolved, see Item::style().
+    struct STICK_API PathStyle
+    {
+        PathStyle() :
+            fill(NoPaint()),
+            stroke(NoPaint()),
+            strokeWidth(1),
+            miterLimit(10),
+            join(StrokeJoin::Miter),
+            cap(StrokeCap::Butt),
+            dashOffset(0),
+            windingRule(WindingRule::EvenOdd),
+            bScalingStroke(true)
+        {
+        }
+
+        Paint fill;
+        Paint stroke;
+        Float strokeWidth;
+        Float miterLimit;
+        StrokeJoin join;
+        StrokeCap cap;
+        DashArray dashArray;
+        Float dashOffset;
+        WindingRule windingRule;
+        bool bScalingStroke;
+    };
 }
 
 #endif //PAPER_PAINT_HPP
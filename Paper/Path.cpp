@@ -5,14 +5,51 @@
 #include <Paper/Private/JoinAndCap.hpp>
 #include <Paper/Private/PathFlattener.hpp>
 #include <Paper/Private/PathFitter.hpp>
+#include <Paper/Private/SegmentTransform.hpp>
+#include <Paper/Private/StrokeOutliner.hpp>
 #include <Crunch/Line.hpp>
 #include <Crunch/StringConversion.hpp>
 #include <Crunch/MatrixFunc.hpp>
 
+#include <algorithm>
+
 namespace paper
 {
     using namespace stick;
 
+    Path::Builder::Builder(const Path & _path, Size _reserve) :
+        m_path(_path),
+        m_firstIndex(_path.segmentCount()),
+        m_bFinished(false)
+    {
+        if (_reserve)
+            m_path.segmentArray().reserve(m_firstIndex + _reserve);
+    }
+
+    Path::Builder::~Builder()
+    {
+        finish();
+    }
+
+    void Path::Builder::addPoint(const Vec2f & _to)
+    {
+        addSegment(_to, Vec2f(0.0), Vec2f(0.0));
+    }
+
+    void Path::Builder::addSegment(const Vec2f & _point, const Vec2f & _handleIn, const Vec2f & _handleOut)
+    {
+        STICK_ASSERT(!m_bFinished);
+        m_path.segmentArray().append(_point, _handleIn, _handleOut);
+    }
+
+    void Path::Builder::finish()
+    {
+        if (m_bFinished)
+            return;
+        m_bFinished = true;
+        m_path.segmentsAppended(m_firstIndex);
+    }
+
     Path::Path()
     {
 
@@ -26,7 +63,7 @@ namespace paper
     void Path::cubicCurveTo(const Vec2f & _handleOne, const Vec2f & _handleTwo, const Vec2f & _to)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
 
         //make relative
         current.setHandleOut(_handleOne - current.position());
@@ -36,7 +73,7 @@ namespace paper
     void Path::quadraticCurveTo(const Vec2f & _handle, const Vec2f & _to)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
 
         // Comment from paper.js Path.js:
         // This is exact:
@@ -51,7 +88,7 @@ namespace paper
     void Path::curveTo(const Vec2f & _through, const Vec2f & _to, Float32 _parameter)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
 
         Float t1 = 1 - _parameter;
         Float tt = _parameter * _parameter;
@@ -63,9 +100,9 @@ namespace paper
     Error Path::arcTo(const Vec2f & _through, const Vec2f & _to)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
 
-        const Vec2f & from = current.position();
+        Vec2f from = current.position();
 
         Vec2f lineOneStart = (from + _through) * 0.5;
         crunch::Line<Vec2f> lineOne(lineOneStart, crunch::rotate(_through - from, crunch::Constants<Float>::halfPi()));
@@ -145,9 +182,9 @@ namespace paper
     Error Path::arcTo(const Vec2f & _to, bool _bClockwise)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
 
-        const Vec2f & from = current.position();
+        Vec2f from = current.position();
 
         Vec2f mid = (from + _to) * 0.5;
         Vec2f dir = (mid - from);
@@ -164,7 +201,7 @@ namespace paper
             return Error();
         }
 
-        Vec2f from = segmentArray().last()->position();
+        Vec2f from = segmentArray().positions.last();
         Vec2f middle = (from + _to) * 0.5;
         Vec2f pt = crunch::rotate(from - middle, -_rotation);
         Float rx = crunch::abs(_radii.x);
@@ -213,10 +250,10 @@ namespace paper
         else if (_bClockwise && extent < 0)
             extent += crunch::Constants<Float>::twoPi();
 
-        return arcHelper(crunch::toDegrees(extent), *segmentArray().last(), vect, _to, center, &matrix);
+        return arcHelper(crunch::toDegrees(extent), segment(segmentCount() - 1), vect, _to, center, &matrix);
     }
 
-    Error Path::arcHelper(Float _extentDeg, Segment & _segment, const Vec2f & _direction, const Vec2f & _to, const Vec2f & _center, const Mat3f * _transform)
+    Error Path::arcHelper(Float _extentDeg, Segment _segment, const Vec2f & _direction, const Vec2f & _to, const Vec2f & _center, const Mat3f * _transform)
     {
         Float ext = crunch::abs(_extentDeg);
         Int32 count = ext >= 360.0 ? 4 : crunch::ceil(ext / 90.0);
@@ -269,35 +306,35 @@ namespace paper
     void Path::cubicCurveBy(const Vec2f & _handleOne, const Vec2f & _handleTwo, const Vec2f & _by)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
         cubicCurveTo(current.position() + _handleOne, current.position() + _handleTwo, current.position() + _by);
     }
 
     void Path::quadraticCurveBy(const Vec2f & _handle, const Vec2f & _by)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
         quadraticCurveTo(current.position() + _handle, current.position() + _by);
     }
 
     void Path::curveBy(const Vec2f & _through, const Vec2f & _by, Float32 _parameter)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
         curveTo(current.position() + _through, current.position() + _by, _parameter);
     }
 
     Error Path::arcBy(const Vec2f & _through, const Vec2f & _by)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
         return arcTo(current.position() + _through, current.position() + _by);
     }
 
     Error Path::arcBy(const Vec2f & _to, bool _bClockwise)
     {
         STICK_ASSERT(segmentArray().count());
-        Segment & current = *segmentArray().last();
+        Segment current = segment(segmentCount() - 1);
         return arcTo(current.position() + _to, _bClockwise);
     }
 
@@ -306,20 +343,19 @@ namespace paper
         if (isClosed())
             return;
 
-        if (segmentArray().count() > 1)
+        auto & segs = segmentArray();
+        if (segs.count() > 1)
         {
-            Segment & first = *segmentArray()[0];
-            Segment & last = *segmentArray().last();
-
-            if (crunch::isClose(first.position(), last.position(), detail::PaperConstants::tolerance()))
+            if (crunch::isClose(segs.positions.first(), segs.positions.last(), detail::PaperConstants::tolerance()))
             {
-                first.setHandleIn(last.handleIn());
-                curveArray().last()->m_segmentB = first.m_index;
-                segmentArray().removeLast();
+                segs.handlesIn.first() = segs.handlesIn.last();
+                segs.removeLast();
+                //the last curve now ends in the first segment
+                Curve(*this, curveArray().count() - 1).markDirty();
             }
             else
             {
-                curveArray().append(stick::makeUnique<Curve>(document().allocator(), *this, last.m_index, first.m_index));
+                curveArray().append(CurveData());
             }
 
             set<comps::ClosedFlag>(true);
@@ -403,7 +439,7 @@ namespace paper
 
             for (Int64 i = 0, j = _from - paddingLeft; i <= n; i++, j++)
             {
-                knots[i] = segs[(j < 0 ? j + segs.count() : j) % segs.count()]->position();
+                knots[i] = segs.positions[(j < 0 ? j + segs.count() : j) % segs.count()];
             }
 
             // In the algorithm we treat these 3 cases:
@@ -471,16 +507,15 @@ namespace paper
             for (Int64 i = paddingLeft, max = n - paddingRight, j = _from; i <= max; i++, j++)
             {
                 Int64 index = j < 0 ? j + segs.count() : j;
-                Segment & segment = *segs[index];
-                Float hx = px[i] - segment.position().x;
-                Float hy = py[i] - segment.position().y;
+                Float hx = px[i] - segs.positions[index].x;
+                Float hy = py[i] - segs.positions[index].y;
                 if (bLoop || i < max)
                 {
-                    segment.setHandleOut(Vec2f(hx, hy));
+                    segs.handlesOut[index] = Vec2f(hx, hy);
                 }
                 if (bLoop || i > paddingLeft)
                 {
-                    segment.setHandleIn(Vec2f(-hx, -hy));
+                    segs.handlesIn[index] = Vec2f(-hx, -hy);
                 }
             }
 
@@ -501,70 +536,95 @@ namespace paper
         createSegment(_point, _handleIn, _handleOut);
     }
 
-    Segment & Path::insertSegment(Size _index, const Vec2f & _pos,
-                                  const Vec2f & _handleIn,
-                                  const Vec2f & _handleOut)
+    void Path::addSegments(const Vec2f * _positions, Size _count)
+    {
+        addSegments(_positions, nullptr, nullptr, _count);
+    }
+
+    void Path::addSegments(const Vec2f * _positions, const Vec2f * _handlesIn,
+                           const Vec2f * _handlesOut, Size _count)
+    {
+        if (!_count)
+            return;
+
+        Size first = segmentArray().count();
+        segmentArray().append(_positions, _handlesIn, _handlesOut, _count);
+        segmentsAppended(first);
+    }
+
+    void Path::setSegments(const Vec2f * _positions, Size _count)
+    {
+        setSegments(_positions, nullptr, nullptr, _count);
+    }
+
+    void Path::setSegments(const Vec2f * _positions, const Vec2f * _handlesIn,
+                           const Vec2f * _handlesOut, Size _count)
+    {
+        auto & segs = segmentArray();
+        segs.clear();
+        segs.append(_positions, _handlesIn, _handlesOut, _count);
+        rebuildCurves();
+        markBoundsDirty(true);
+        markGeometryDirty(true);
+    }
+
+    Segment Path::insertSegment(Size _index, const Vec2f & _pos,
+                                const Vec2f & _handleIn,
+                                const Vec2f & _handleOut)
     {
         auto & segs = segmentArray();
-        auto seg = document().allocator().create<Segment>(*this, _pos, _handleIn, _handleOut, _index);
         //append case
         if (_index >= segs.count())
         {
-            segs.append(stick::UniquePtr<Segment>(seg, document().allocator()));
+            _index = segs.count();
+            segs.append(_pos, _handleIn, _handleOut);
             if (segs.count() > 1)
             {
                 auto & curves = curveArray();
 
-                // possibly remove the last closing curve
-                if (isClosed() && curves.count() && curves.last()->m_segmentB == 0)
-                    curves.removeLast();
+                // the old closing curve now ends in the new segment
+                if (isClosed() && curves.count())
+                    Curve(*this, curves.count() - 1).markDirty();
 
                 // add the new curve
-                curves.append(stick::makeUnique<Curve>(document().allocator(), *this, segs.count() - 2, segs.count() - 1));
+                curves.append(CurveData());
 
                 // possibly add the new closing curve
-                if (isClosed())
-                    curves.append(stick::makeUnique<Curve>(document().allocator(), *this, segs.count() - 1, 0));
+                if (isClosed() && segs.count() == 2)
+                    curves.append(CurveData());
             }
         }
         //insert case
         else
         {
-            auto sit = segs.insert(segs.begin() + _index, stick::UniquePtr<Segment>(seg, document().allocator()));
+            segs.insert(_index, _pos, _handleIn, _handleOut);
 
-            //insert the new curve created by due to the segment insertion
+            //insert the new curve created by due to the segment insertion.
+            //curves are identified by index, so the cached data of all the
+            //curves after it simply shifts along.
             auto & curves = curveArray();
-            auto cit = curves.begin() + _index;
-            cit = curves.insert(cit, stick::makeUnique<Curve>(document().allocator(), *this, seg->m_index , seg->m_index + 1));
-
-            //iterate over all the segments after the new one and update their indices
-            ++sit;
-            for (; sit != segs.end(); ++sit)
-            {
-                (*sit)->m_index++;
-            }
-            ++cit;
-            for (; cit != curves.end(); ++cit)
-            {
-                (*cit)->markDirty();
-                (*cit)->m_segmentA++;
-                if ((*cit)->m_segmentB != 0)
-                    (*cit)->m_segmentB++;
-            }
+            curves.insert(curves.begin() + _index, CurveData());
+            markCurveOffsetsDirty(_index);
+
+            //the curve ending in the new segment changed, too
+            if (_index > 0)
+                Curve(*this, _index - 1).markDirty();
+            else if (isClosed())
+                Curve(*this, curves.count() - 1).markDirty();
         }
 
-        //rebuildCurves();
+        //the cumulative curve offsets were invalidated above, no need to
+        //mark the whole path length dirty.
         markBoundsDirty(true);
-        markGeometryDirty(true);
-        return *seg;
+        markGeometryDirty(false);
+        return Segment(*this, _index);
     }
 
     void Path::removeSegment(Size _index)
     {
         auto & segs = segmentArray();
         STICK_ASSERT(_index < segs.count());
-        segs.remove(segs.begin() + _index);
-        updateSegmentIndices(_index, segmentArray().count());
+        segs.remove(_index, _index + 1);
         rebuildCurves();
         markGeometryDirty(true);
     }
@@ -573,7 +633,7 @@ namespace paper
     {
         auto & segs = segmentArray();
         STICK_ASSERT(_from < segs.count());
-        segs.remove(segs.begin() + _from, segs.end());
+        segs.remove(_from, segs.count());
         rebuildCurves();
         markGeometryDirty(true);
     }
@@ -583,8 +643,7 @@ namespace paper
         auto & segs = segmentArray();
         STICK_ASSERT(_from < segs.count());
         STICK_ASSERT(_to < segs.count());
-        segs.remove(segs.begin() + _from, segs.begin() + _to);
-        updateSegmentIndices(_from, _to);
+        segs.remove(_from, _to);
         rebuildCurves();
         markGeometryDirty(true);
     }
@@ -596,27 +655,26 @@ namespace paper
         markGeometryDirty(true);
     }
 
-    Segment & Path::createSegment(const Vec2f & _pos, const Vec2f & _handleIn, const Vec2f & _handleOut)
+    Segment Path::createSegment(const Vec2f & _pos, const Vec2f & _handleIn, const Vec2f & _handleOut)
     {
         return insertSegment(segmentArray().count(), _pos, _handleIn, _handleOut);
     }
 
     void Path::reverse()
     {
-        //TODO: Can be optimized
+        //reversing flips the sign of the area, no need to compute it again
+        auto maybe = this->maybe<comps::PathArea>();
+        bool bAreaKnown = maybe && !(*maybe).bDirty;
+        Float area = bAreaKnown ? (*maybe).area : 0;
+
+        //reversing swaps the in and out handles of every segment
         auto & segs = get<comps::Segments>();
-        std::reverse(segs.begin(), segs.end());
-        Size i = 0;
-        Vec2f tmp;
-        for (; i < segs.count(); ++i)
-        {
-            segs[i]->m_index = i;
-            tmp = segs[i]->m_handleOut;
-            segs[i]->m_handleOut = segs[i]->m_handleIn;
-            segs[i]->m_handleIn = tmp;
-        }
+        std::reverse(segs.positions.begin(), segs.positions.end());
+        std::reverse(segs.handlesIn.begin(), segs.handlesIn.end());
+        std::reverse(segs.handlesOut.begin(), segs.handlesOut.end());
+        std::swap(segs.handlesIn, segs.handlesOut);
 
-        for (auto & c : get<comps::Children>())
+        for (const Item & c : children())
         {
             Path p = brick::reinterpretEntity<Path>(c);
             p.reverse();
@@ -624,6 +682,9 @@ namespace paper
 
         rebuildCurves();
         markGeometryDirty(true);
+
+        if (bAreaKnown)
+            set<comps::PathArea>((comps::PathAreaData) {false, -area});
     }
 
     void Path::setClockwise(bool _b)
@@ -639,10 +700,10 @@ namespace paper
         detail::PathFlattener::flatten(*this, newSegmentPositions, nullptr, _angleTolerance, _minDistance, _maxRecursion);
         auto & segs = segmentArray();
         segs.clear();
-
+        segs.reserve(newSegmentPositions.count());
         for (const auto & pos : newSegmentPositions)
         {
-            segs.append(stick::makeUnique<Segment>(document().allocator(), *this, pos, Vec2f(0.0f), Vec2f(0.0f), segs.count()));
+            segs.append(pos, Vec2f(0.0f), Vec2f(0.0f));
         }
 
         //make sure to possibly remove duplicate closing segments again
@@ -695,9 +756,10 @@ namespace paper
 
         auto & segs = get<comps::Segments>();
         segs.clear();
+        segs.reserve(tmp.count());
         for (const Vec2f & p : tmp)
         {
-            segs.append(stick::makeUnique<Segment>(document().allocator(), *this, p, Vec2f(0), Vec2f(0), segs.count()));
+            segs.append(p, Vec2f(0), Vec2f(0));
         }
 
         //printf("NUM NEW SEGS %lu\n", segs.count());
@@ -730,26 +792,25 @@ namespace paper
     Path::SegmentViewConst Path::segments() const
     {
         STICK_ASSERT(hasComponent<comps::Segments>());
-        return SegmentViewConst(segmentArray().begin(), segmentArray().end());
+        return SegmentViewConst(*this, 0, segmentArray().count());
     }
 
     Path::SegmentView Path::segments()
     {
         STICK_ASSERT(hasComponent<comps::Segments>());
-        //return get<comps::Segments>();
-        return SegmentView(segmentArray().begin(), segmentArray().end());
+        return SegmentView(*this, 0, segmentArray().count());
     }
 
     Path::CurveViewConst Path::curves() const
     {
         STICK_ASSERT(hasComponent<comps::Curves>());
-        return CurveViewConst(curveArray().begin(), curveArray().end());
+        return CurveViewConst(*this, 0, curveArray().count());
     }
 
     Path::CurveView Path::curves()
     {
         STICK_ASSERT(hasComponent<comps::Curves>());
-        return CurveView(curveArray().begin(), curveArray().end());
+        return CurveView(*this, 0, curveArray().count());
     }
 
     SegmentArray & Path::segmentArray()
@@ -841,27 +902,28 @@ namespace paper
         ret.addSegment(bez.positionOne(), Vec2f(0.0), bez.handleOne() - bez.positionOne());
 
         //add all the segments inbetween
-        for (stick::Size i = _from.curve().segmentTwo().m_index; i <= _to.curve().segmentOne().m_index; ++i)
+        Size fromIndex = _from.curve().segmentIndexTwo();
+        Size toIndex = _to.curve().segmentIndexOne();
+        for (stick::Size i = fromIndex; i <= toIndex; ++i)
         {
-            auto & seg = segs[i];
-            Vec2f handleIn = seg->handleIn();
-            Vec2f handleOut = seg->handleOut();
+            Vec2f handleIn = segs.handlesIn[i];
+            Vec2f handleOut = segs.handlesOut[i];
 
-            if (i == _from.curve().segmentTwo().m_index && i == _to.curve().segmentOne().m_index)
+            if (i == fromIndex && i == toIndex)
             {
                 handleIn = bez.handleTwo() - bez.positionTwo();
                 handleOut = bez2.handleOne() - bez2.positionOne();
             }
-            else if (i == _from.curve().segmentTwo().m_index)
+            else if (i == fromIndex)
             {
                 handleIn = bez.handleTwo() - bez.positionTwo();
             }
-            else if (i == _to.curve().segmentOne().m_index)
+            else if (i == toIndex)
             {
                 handleOut = bez2.handleOne() - bez2.positionOne();
             }
 
-            ret.addSegment(seg->position(),
+            ret.addSegment(segs.positions[i],
                            handleIn,
                            handleOut);
         }
@@ -879,25 +941,23 @@ namespace paper
         Float currentDist;
         Float closestParameter;
         Float currentParameter;
-        auto closestCurve = curveArray().end();
-
-        auto it = curveArray().begin();
+        Curve closestCurve;
 
-        for (; it != curveArray().end(); ++it)
+        for (const Curve & c : curves())
         {
-            currentParameter = (*it)->closestParameter(_point, currentDist);
+            currentParameter = c.closestParameter(_point, currentDist);
             if (currentDist < minDist)
             {
                 minDist = currentDist;
                 closestParameter = currentParameter;
-                closestCurve = it;
+                closestCurve = c;
             }
         }
 
-        if (closestCurve != curveArray().end())
+        if (closestCurve)
         {
             _outDistance = minDist;
-            return (*closestCurve)->curveLocationAtParameter(closestParameter);
+            return closestCurve.curveLocationAtParameter(closestParameter);
         }
 
         return CurveLocation();
@@ -911,73 +971,95 @@ namespace paper
 
     CurveLocation Path::curveLocationAt(Float _offset) const
     {
-        Float len = 0;
-        Float start;
-
-        auto it = curveArray().begin();
-
-        for (; it != curveArray().end(); ++it)
-        {
-            start = len;
-            len += (*it)->length();
-
-            //we found the curve
-            if (len >= _offset)
-            {
-                return (*it)->curveLocationAt(_offset - start);
-            }
-        }
+        Size idx = curveIndexAt(_offset);
+        if (idx < curveCount())
+            return Curve(*this, idx).curveLocationAt(_offset - curveOffset(idx));
 
         // comment from paper.js source in Path.js:
         // It may be that through impreciseness of getLength (length) , that the end
         // of the curves was missed:
         if (_offset <= length())
         {
-            return curveArray().last()->curveLocationAtParameter(1);
+            return curve(curveCount() - 1).curveLocationAtParameter(1);
         }
 
         return CurveLocation();
     }
 
     Float Path::length() const
+    {
+        updateCurveOffsets();
+        return get<comps::PathLength>().length;
+    }
+
+    void Path::markCurveOffsetsDirty(Size _curveIndex)
+    {
+        auto & lenData = get<comps::PathLength>();
+        lenData.validOffsetCount = std::min(lenData.validOffsetCount, _curveIndex);
+    }
+
+    void Path::updateCurveOffsets() const
     {
         auto & lenData = const_cast<Path *>(this)->get<comps::PathLength>();
+        auto & curves = const_cast<Path *>(this)->curveArray();
         if (lenData.bDirty)
         {
-            lenData.length = 0;
-            for (const auto & c : curveArray())
-            {
-                lenData.length += c->length();
-            }
+            lenData.validOffsetCount = 0;
             lenData.bDirty = false;
         }
-        return lenData.length;
+
+        if (lenData.validOffsetCount >= curves.count())
+            return;
+
+        //only the curves after the first dirty one need to be summed up again
+        Float offset = lenData.validOffsetCount ? curves[lenData.validOffsetCount - 1].endOffset : 0;
+        for (Size i = lenData.validOffsetCount; i < curves.count(); ++i)
+        {
+            offset += Curve(*this, i).length();
+            curves[i].endOffset = offset;
+        }
+        lenData.validOffsetCount = curves.count();
+        lenData.length = offset;
+    }
+
+    Float Path::curveOffset(Size _curveIndex) const
+    {
+        STICK_ASSERT(_curveIndex < curveCount());
+        updateCurveOffsets();
+        return _curveIndex ? curveArray()[_curveIndex - 1].endOffset : 0;
+    }
+
+    Size Path::curveIndexAt(Float _offset) const
+    {
+        updateCurveOffsets();
+        const auto & curves = curveArray();
+        auto it = std::lower_bound(curves.begin(), curves.end(), _offset,
+                                   [](const CurveData & _c, Float _off) { return _c.endOffset < _off; });
+        return it - curves.begin();
     }
 
     void Path::peaks(stick::DynamicArray<CurveLocation> & _peaks) const
     {
-        auto & curves = curveArray();
         stick::DynamicArray<Float> tmp(document().allocator());
-        for (auto & curve : curves)
+        for (const Curve & c : curves())
         {
-            curve->peaks(tmp);
+            c.peaks(tmp);
             for (auto p : tmp)
             {
-                _peaks.append(curve->curveLocationAtParameter(p));
+                _peaks.append(c.curveLocationAtParameter(p));
             }
         }
     }
 
     void Path::extrema(stick::DynamicArray<CurveLocation> & _extrema) const
     {
-        auto & curves = curveArray();
         stick::DynamicArray<Float> tmp(document().allocator());
-        for (auto & curve : curves)
+        for (const Curve & c : curves())
         {
-            curve->extrema(tmp);
+            c.extrema(tmp);
             for (auto p : tmp)
             {
-                _extrema.append(curve->curveLocationAtParameter(p));
+                _extrema.append(c.curveLocationAtParameter(p));
             }
         }
     }
@@ -991,19 +1073,25 @@ namespace paper
 
     Float Path::area() const
     {
+        Path self = *this;
+        auto maybe = self.maybe<comps::PathArea>();
+        if (maybe && !(*maybe).bDirty)
+            return (*maybe).area;
+
         Float ret = 0;
-        for (const auto & c : curveArray())
+        for (const Curve & c : curves())
         {
-            ret += c->area();
+            ret += c.area();
         }
 
         // take children into account
-        for (auto & c : get<comps::Children>())
+        for (const Item & c : children())
         {
             Path p = brick::reinterpretEntity<Path>(c);
             ret += p.area();
         }
 
+        self.set<comps::PathArea>((comps::PathAreaData) {false, ret});
         return ret;
     }
 
@@ -1014,9 +1102,11 @@ namespace paper
 
     bool Path::isPolygon() const
     {
-        for (const auto & seg : segmentArray())
+        auto & segs = segmentArray();
+        for (Size i = 0; i < segs.count(); ++i)
         {
-            if (!seg->isLinear())
+            if (!crunch::isClose(segs.handlesIn[i], Vec2f(0.0), detail::PaperConstants::tolerance()) ||
+                    !crunch::isClose(segs.handlesOut[i], Vec2f(0.0), detail::PaperConstants::tolerance()))
                 return false;
         }
         return true;
@@ -1062,52 +1152,28 @@ namespace paper
         auto & curves = curveArray();
         curves.clear();
         auto & segs = segmentArray();
-        for (Size i = 0; i < segs.count() - 1; ++i)
-        {
-            curves.append(stick::makeUnique<Curve>(document().allocator(), *this, i, i + 1));
-        }
-
-        if (isClosed() && segs.count() > 1)
-            curves.append(stick::makeUnique<Curve>(document().allocator(), *this, segs.count() - 1, 0));
+        if (segs.count() > 1)
+            curves.resize(isClosed() ? segs.count() : segs.count() - 1);
     }
 
-    void Path::updateSegmentIndices(Size _from, Size _to)
+    void Path::segmentChanged(Size _index)
     {
-        for (Size i = _from; i < _to && i < segmentArray().count(); ++i)
-        {
-            segmentArray()[i]->m_index = i;
-        }
-    }
-
-    void Path::segmentChanged(const Segment & _seg)
-    {
-        //printf("SEGMENT CHANGED A %lu\n", curveArray().count());
-        if (curveArray().count() == 0)
+        auto & curves = curveArray();
+        if (curves.count() == 0)
             return;
 
-        if (_seg.m_index == 0)
-        {
-            // printf("SEGMENT CHANGED B\n");
-            curveArray().first()->markDirty();
-            if (isClosed())
-                curveArray().last()->markDirty();
-        }
-        else if (_seg.m_index == segmentArray().count() - 1)
-        {
-            // printf("SEGMENT CHANGED C\n");
-            curveArray().last()->markDirty();
-            if (isClosed())
-                curveArray().first()->markDirty();
-        }
-        else
-        {
-            // printf("SEGMENT CHANGED D\n");
-            curveArray()[_seg.m_index - 1]->markDirty();
-            curveArray()[_seg.m_index]->markDirty();
-        }
+        //the curve ending in the segment
+        if (_index > 0)
+            Curve(*this, _index - 1).markDirty();
+        else if (isClosed())
+            Curve(*this, curves.count() - 1).markDirty();
+
+        //the curve starting in the segment
+        if (_index < curves.count())
+            Curve(*this, _index).markDirty();
+
         markBoundsDirty(true);
-        markGeometryDirty(true);
-        //printf("SEGMENT CHANGED E\n");
+        markGeometryDirty(false);
     }
 
     namespace detail
@@ -1249,12 +1315,13 @@ namespace paper
 
     Path::BoundsResult Path::computeBoundsImpl(Float _padding, const Mat3f * _transform)
     {
-        if (!segmentArray().count())
+        auto & segs = segmentArray();
+        if (!segs.count())
             return {true, Rect(0, 0, 0, 0)};
 
-        if (segmentArray().count() == 1)
+        if (segs.count() == 1)
         {
-            Vec2f p = _transform ? *_transform * segmentArray()[0]->position() : segmentArray()[0]->position();
+            Vec2f p = _transform ? *_transform * segs.positions[0] : segs.positions[0];
             return {false, Rect(p, p)};
         }
 
@@ -1263,13 +1330,13 @@ namespace paper
         {
             //if not transformation is applied in the document hierarchy, we can simply use the
             //existing beziers as local = global space.
-            auto & curves = curveArray();
-            for (auto it = curves.begin(); it != curves.end(); ++it)
+            for (Size i = 0; i < curveCount(); ++i)
             {
-                if (it == curves.begin())
-                    ret = _padding > 0.0 ? (*it)->bounds(_padding) : (*it)->bounds();
+                Curve c(*this, i);
+                if (i == 0)
+                    ret = _padding > 0.0 ? c.bounds(_padding) : c.bounds();
                 else
-                    ret = crunch::merge(ret, _padding > 0.0 ? (*it)->bounds(_padding) : (*it)->bounds());
+                    ret = crunch::merge(ret, _padding > 0.0 ? c.bounds(_padding) : c.bounds());
             }
         }
         else
@@ -1299,30 +1366,30 @@ namespace paper
 
             //we iterate over segments instead so we only do the matrix multiplication
             //once for each segment.
-            auto & segs = segmentArray();
-            auto it = segs.begin();
-            Vec2f lastPosition = *_transform * (*it)->position();
+            const Vec2f * positions = segs.positions.begin();
+            const Vec2f * handlesIn = segs.handlesIn.begin();
+            const Vec2f * handlesOut = segs.handlesOut.begin();
+            Vec2f lastPosition = *_transform * positions[0];
             Vec2f firstPosition = lastPosition;
-            Vec2f lastHandle = *_transform * (*it)->handleOutAbsolute();
-            ++it;
+            Vec2f lastHandle = *_transform * (positions[0] + handlesOut[0]);
             Vec2f currentPosition, handleIn;
-            for (; it != segs.end(); ++it)
+            for (Size i = 1; i < segs.count(); ++i)
             {
-                handleIn = *_transform * (*it)->handleInAbsolute();
-                currentPosition = *_transform * (*it)->position();
+                handleIn = *_transform * (positions[i] + handlesIn[i]);
+                currentPosition = *_transform * positions[i];
 
                 Bezier bez(lastPosition, lastHandle, handleIn, currentPosition);
-                if (it == segs.begin() + 1)
+                if (i == 1)
                     ret = bez.bounds(_padding);
                 else
                     ret = crunch::merge(ret, bez.bounds(_padding));
 
-                lastHandle = *_transform * (*it)->handleOutAbsolute();
+                lastHandle = *_transform * (positions[i] + handlesOut[i]);
                 lastPosition = currentPosition;
             }
             if (isClosed())
             {
-                Bezier bez(lastPosition, lastHandle, *_transform * segs.first()->handleInAbsolute(), firstPosition);
+                Bezier bez(lastPosition, lastHandle, *_transform * (positions[0] + handlesIn[0]), firstPosition);
                 ret = crunch::merge(ret, bez.bounds(_padding));
             }
         }
@@ -1354,28 +1421,30 @@ namespace paper
         auto result = computeBoundsImpl(max(sp.x, sp.y), _transform);
         bool bIsTransformed = _transform != nullptr;
 
-        //if there is no bounds
-        if (result.bEmpty)
-            return result;
-
+        //if there is no bounds or no curve, there are no joins and caps either
         auto & segments = segmentArray();
-        Size segmentCount = isClosed() ? segments.count() : segments.count() - 1;
+        if (result.bEmpty || segments.count() < 2)
+            return result;
 
         Mat3f ismat = crunch::inverse(smat);
         DynamicArray<detail::SegmentData> strokeSegs(segments.count());
         for (Size i = 0; i < strokeSegs.count(); ++i)
         {
-            strokeSegs[i] = {ismat * segments[i]->position(), ismat * (segments[i]->position() + segments[i]->handleIn()), ismat * (segments[i]->position() + segments[i]->handleOut())};
+            const Vec2f & pos = segments.positions[i];
+            strokeSegs[i] = {ismat * pos, ismat * (pos + segments.handlesIn[i]), ismat * (pos + segments.handlesOut[i])};
         }
 
-        for (Size i = 1; i < segments.count(); ++i)
+        //joins of all the inner segments
+        for (Size i = 1; i + 1 < segments.count(); ++i)
         {
             detail::mergeStrokeJoin(result.rect, join, ml, strokeSegs[i - 1], strokeSegs[i], strokeSegs[i + 1], sp, smat, _transform);
         }
 
         if (isClosed())
         {
-            //closing join
+            //closing joins
+            detail::mergeStrokeJoin(result.rect, join, ml, strokeSegs[strokeSegs.count() - 2],
+                                    strokeSegs[strokeSegs.count() - 1], strokeSegs[0], sp, smat, _transform);
             detail::mergeStrokeJoin(result.rect, join, ml, strokeSegs[strokeSegs.count() - 1],
                                     strokeSegs[0], strokeSegs[1], sp, smat, _transform);
         }
@@ -1398,22 +1467,21 @@ namespace paper
         if (ret.bEmpty)
             return ret;
 
+        auto & segs = segmentArray();
         if (_transform)
         {
-            auto & segs = segmentArray();
-            for (auto & seg : segs)
+            for (Size i = 0; i < segs.count(); ++i)
             {
-                ret.rect = crunch::merge(ret.rect, *_transform * seg->handleInAbsolute());
-                ret.rect = crunch::merge(ret.rect, *_transform * seg->handleOutAbsolute());
+                ret.rect = crunch::merge(ret.rect, *_transform * (segs.positions[i] + segs.handlesIn[i]));
+                ret.rect = crunch::merge(ret.rect, *_transform * (segs.positions[i] + segs.handlesOut[i]));
             }
         }
         else
         {
-            auto & segs = segmentArray();
-            for (auto & seg : segs)
+            for (Size i = 0; i < segs.count(); ++i)
             {
-                ret.rect = crunch::merge(ret.rect, seg->handleInAbsolute());
-                ret.rect = crunch::merge(ret.rect, seg->handleOutAbsolute());
+                ret.rect = crunch::merge(ret.rect, segs.positions[i] + segs.handlesIn[i]);
+                ret.rect = crunch::merge(ret.rect, segs.positions[i] + segs.handlesOut[i]);
             }
         }
 
@@ -1431,11 +1499,52 @@ namespace paper
             return detail::winding(_point, detail::monoCurves(*const_cast<Path *>(this)), false) > 0;
     }
 
+    void Path::contains(const Vec2f * _points, Size _count, bool * _outResults) const
+    {
+        const Rect & bounds = handleBounds();
+        DynamicArray<Vec2f> candidates(document().allocator());
+        DynamicArray<Size> indices(document().allocator());
+        for (Size i = 0; i < _count; ++i)
+        {
+            _outResults[i] = false;
+            if (bounds.contains(_points[i]))
+            {
+                candidates.append(_points[i]);
+                indices.append(i);
+            }
+        }
+
+        if (!candidates.count())
+            return;
+
+        DynamicArray<Int32> windings(document().allocator());
+        windings.resize(candidates.count());
+        detail::windings(&candidates[0], candidates.count(), detail::monoCurves(*const_cast<Path *>(this)), &windings[0]);
+
+        bool bEvenOdd = windingRule() == WindingRule::EvenOdd;
+        for (Size i = 0; i < indices.count(); ++i)
+            _outResults[indices[i]] = bEvenOdd ? windings[i] & 1 : windings[i] > 0;
+    }
+
+    DynamicArray<bool> Path::contains(const DynamicArray<Vec2f> & _points) const
+    {
+        DynamicArray<bool> ret;
+        ret.resize(_points.count());
+        if (_points.count())
+            contains(&_points[0], _points.count(), &ret[0]);
+        return ret;
+    }
+
     void Path::applyTransform(const Mat3f & _transform)
     {
-        for (auto & s : segmentArray())
+        detail::transformSegments(_transform, segmentArray());
+
+        //the curve offsets get reset by Item::applyTransform marking the length dirty,
+        //so only the per curve caches need to be touched.
+        for (CurveData & cd : curveArray())
         {
-            s->transform(_transform);
+            cd.bLengthCached = false;
+            cd.bBoundsCached = false;
         }
     }
 
@@ -1444,24 +1553,28 @@ namespace paper
         return brick::reinterpretEntity<Path>(Item::clone());
     }
 
-    Curve & Path::curve(Size _index)
+    Curve Path::curve(Size _index)
     {
-        return *curveArray()[_index];
+        STICK_ASSERT(_index < curveArray().count());
+        return Curve(*this, _index);
     }
 
-    const Curve & Path::curve(Size _index) const
+    const Curve Path::curve(Size _index) const
     {
-        return *curveArray()[_index];
+        STICK_ASSERT(_index < curveArray().count());
+        return Curve(*this, _index);
     }
 
-    Segment & Path::segment(Size _index)
+    Segment Path::segment(Size _index)
     {
-        return *segmentArray()[_index];
+        STICK_ASSERT(_index < segmentArray().count());
+        return Segment(*this, _index);
     }
 
-    const Segment & Path::segment(Size _index) const
+    const Segment Path::segment(Size _index) const
     {
-        return *segmentArray()[_index];
+        STICK_ASSERT(_index < segmentArray().count());
+        return Segment(*this, _index);
     }
 
     Size Path::curveCount() const
@@ -1474,6 +1587,27 @@ namespace paper
         return segmentArray().count();
     }
 
+    void Path::segmentsAppended(Size _firstIndex)
+    {
+        auto & segs = segmentArray();
+        if (_firstIndex >= segs.count())
+            return;
+
+        auto & curves = curveArray();
+        Size oldCount = curves.count();
+
+        // the old closing curve now ends in the first new segment
+        if (isClosed() && oldCount)
+            Curve(*this, oldCount - 1).markDirty();
+
+        if (segs.count() > 1)
+            curves.resize(isClosed() ? segs.count() : segs.count() - 1);
+        markCurveOffsetsDirty(oldCount);
+
+        markBoundsDirty(true);
+        markGeometryDirty(false);
+    }
+
     namespace detail
     {
         inline bool isAdjacentCurve(Size _a, Size _b, Size _curveCount, bool _bIsClosed)
@@ -1483,66 +1617,163 @@ namespace paper
             return false;
         }
 
+        // axis aligned bounds of a curve used for the broad phase of the intersection tests
+        struct CurveBox
+        {
+            Vec2f min;
+            Vec2f max;
+            Size index;
+            // true if the curve belongs to the other path
+            bool bOther;
+        };
+
+        using CurveBoxArray = stick::DynamicArray<CurveBox>;
+
+        struct CurvePair
+        {
+            bool operator < (const CurvePair & _other) const
+            {
+                return a < _other.a || (a == _other.a && b < _other.b);
+            }
+
+            Size a;
+            Size b;
+        };
+
+        using CurvePairArray = stick::DynamicArray<CurvePair>;
+
+        inline void appendCurveBoxes(const Path & _path, bool _bOther, CurveBoxArray & _outBoxes)
+        {
+            // pad the bounds a little so that curves touching in a single point
+            // still end up as a candidate pair
+            Float eps = detail::PaperConstants::geometricEpsilon();
+            for (Size i = 0; i < _path.curveCount(); ++i)
+            {
+                Rect b = Curve(_path, i).bounds();
+                _outBoxes.append({b.min() - Vec2f(eps), b.max() + Vec2f(eps), i, _bOther});
+            }
+        }
+
+        // unites the bounds of all curves of _path and its children, each in its own local
+        // space, which is where recursivelyIntersect compares them.
+        inline void uniteLocalCurveBounds(const Path & _path, Rect & _bounds, bool & _bEmpty)
+        {
+            for (Size i = 0; i < _path.curveCount(); ++i)
+            {
+                Rect b = Curve(_path, i).bounds();
+                _bounds = _bEmpty ? b : crunch::merge(_bounds, b);
+                _bEmpty = false;
+            }
+
+            for (const Item & c : _path.children())
+                uniteLocalCurveBounds(brick::reinterpretEntity<Path>(c), _bounds, _bEmpty);
+        }
+
+        // sort and sweep along the x axis to find all pairs of curves whose bounds overlap.
+        // If the boxes contain the curves of two different paths, only pairs between the
+        // two paths are reported, otherwise all pairs of the single path.
+        inline void findCandidatePairs(CurveBoxArray & _boxes, bool _bSelf, CurvePairArray & _outPairs)
+        {
+            std::sort(_boxes.begin(), _boxes.end(), [](const CurveBox & _a, const CurveBox & _b)
+            {
+                return _a.min.x < _b.min.x;
+            });
+
+            for (Size i = 0; i < _boxes.count(); ++i)
+            {
+                const CurveBox & a = _boxes[i];
+                for (Size j = i + 1; j < _boxes.count() && _boxes[j].min.x <= a.max.x; ++j)
+                {
+                    const CurveBox & b = _boxes[j];
+                    if ((!_bSelf && a.bOther == b.bOther) || a.min.y > b.max.y || b.min.y > a.max.y)
+                        continue;
+
+                    if (_bSelf)
+                        _outPairs.append({std::min(a.index, b.index), std::max(a.index, b.index)});
+                    else if (a.bOther)
+                        _outPairs.append({b.index, a.index});
+                    else
+                        _outPairs.append({a.index, b.index});
+                }
+            }
+
+            // process the pairs in curve order to keep the order of the results stable
+            std::sort(_outPairs.begin(), _outPairs.end());
+        }
+
+        // checks if a location with the given offset was found already. _sortedOffsets
+        // holds the offsets of all found locations in ascending order.
+        inline bool isDuplicateOffset(const stick::DynamicArray<Float> & _sortedOffsets, Float _offset, Float _length)
+        {
+            if (!_sortedOffsets.count())
+                return false;
+
+            Float eps = detail::PaperConstants::geometricEpsilon();
+            auto it = std::lower_bound(_sortedOffsets.begin(), _sortedOffsets.end(), _offset - eps);
+            if (it != _sortedOffsets.end() && *it - _offset < eps)
+                return true;
+
+            // locations at the very start and end of a path are the same, too
+            if (std::abs(_length - (_sortedOffsets.last() - _offset)) < eps ||
+                    std::abs(_length - (_offset - _sortedOffsets.first())) < eps)
+                return true;
+
+            return false;
+        }
+
         // helper to recursively intersect paths and its children (compound path)
-        inline void recursivelyIntersect(const Path & _self, const Path & _other, IntersectionArray & _intersections)
+        inline void recursivelyIntersect(const Path & _self, const Path & _other, IntersectionArray & _intersections,
+                                         stick::DynamicArray<Float> & _sortedOffsets)
         {
             bool bSelf = _self == _other;
-            const auto & curves = _self.curveArray();
-            auto * otherCurves = !bSelf ? &_other.curveArray() : &curves;
-            for (Size i = 0; i < curves.count(); ++i)
+            Size curveCount = _self.curveCount();
+
+            CurveBoxArray boxes(_self.document().allocator());
+            boxes.reserve(bSelf ? curveCount : curveCount + _other.curveCount());
+            appendCurveBoxes(_self, false, boxes);
+            if (!bSelf)
+                appendCurveBoxes(_other, true, boxes);
+
+            CurvePairArray pairs(_self.document().allocator());
+            findCandidatePairs(boxes, bSelf, pairs);
+
+            for (const CurvePair & pair : pairs)
             {
-                const auto & a = curves[i];
-                for (Size j = bSelf ? i + 1 : 0; j < otherCurves->count(); ++j)
+                Size i = pair.a;
+                Size j = pair.b;
+                Curve a(_self, i);
+                auto intersections = a.bezier().intersections(Curve(_other, j).bezier());
+                for (stick::Int32 z = 0; z < intersections.count; ++z)
                 {
-                    const auto & b = (*otherCurves)[j];
-                    auto intersections = a->bezier().intersections(b->bezier());
-                    for (stick::Int32 z = 0; z < intersections.count; ++z)
+                    bool bAdd = true;
+                    //for self intersection we only add the intersection if its not where
+                    //adjacent curves connect.
+                    if (bSelf)
                     {
-                        bool bAdd = true;
-                        //for self intersection we only add the intersection if its not where
-                        //adjacent curves connect.
-                        if (bSelf)
+                        if (isAdjacentCurve(i, j, curveCount, _self.isClosed()))
                         {
-                            printf("DAA I %lu J %lu\n", i, j);
-                            if (isAdjacentCurve(i, j, curves.count(), _self.isClosed()))
+                            if ((crunch::isClose(intersections.values[z].parameterOne, 1.0f, detail::PaperConstants::curveTimeEpsilon()) &&
+                                    crunch::isClose(intersections.values[z].parameterTwo, 0.0f, detail::PaperConstants::curveTimeEpsilon())) ||
+                                    //this case can only happen for closed paths where the first curve meets the last one
+                                    (_self.isClosed() && crunch::isClose(intersections.values[z].parameterOne, 0.0f, detail::PaperConstants::curveTimeEpsilon()) &&
+                                     crunch::isClose(intersections.values[z].parameterTwo, 1.0f, detail::PaperConstants::curveTimeEpsilon())))
                             {
-                                printf("ITS ADJACENT\n");
-                                if ((crunch::isClose(intersections.values[z].parameterOne, 1.0f, detail::PaperConstants::curveTimeEpsilon()) &&
-                                        crunch::isClose(intersections.values[z].parameterTwo, 0.0f, detail::PaperConstants::curveTimeEpsilon())) ||
-                                        //this case can only happen for closed paths where the first curve meets the last one
-                                        (_self.isClosed() && crunch::isClose(intersections.values[z].parameterOne, 0.0f, detail::PaperConstants::curveTimeEpsilon()) &&
-                                         crunch::isClose(intersections.values[z].parameterTwo, 1.0f, detail::PaperConstants::curveTimeEpsilon())))
-                                {
-                                    printf("DONT FUCKING ADD\n");
-                                    bAdd = false;
-                                }
+                                bAdd = false;
                             }
                         }
+                    }
 
-                        if (bAdd)
+                    if (bAdd)
+                    {
+                        // make sure we don't add an intersection twice. This can happen if the intersection
+                        // is located between two adjacent curves of the path.
+                        auto cl = a.curveLocationAtParameter(intersections.values[z].parameterOne);
+                        if (!isDuplicateOffset(_sortedOffsets, cl.offset(), _self.length()))
                         {
-                            // make sure we don't add an intersection twice. This can happen if the intersection
-                            // is located between two adjacent curves of the path.
-                            // @TODO: do some sorted insertion similar to what paper.js does to avoid having
-                            // to iterate over the whole array of found intersections. I am pretty sure that
-                            // just keeping it simple and iterating over a block of memory will perform better in
-                            // native code in most scenarios.
-                            auto cl = a->curveLocationAtParameter(intersections.values[z].parameterOne);
-                            for (auto & isec : _intersections)
-                            {
-                                printf("COMPARING WITH OLD ONE %f %f\n", cl.offset(), isec.location.offset());
-                                if (cl.isSynonymous(isec.location))
-                                {
-                                    printf("ITS SYNNONYMOUS BIITCH\n");
-                                    bAdd = false;
-                                    break;
-                                }
-
-                            }
-                            if (bAdd)
-                                _intersections.append({cl,
-                                                       intersections.values[z].position
-                                                      });
+                            _sortedOffsets.insert(std::upper_bound(_sortedOffsets.begin(), _sortedOffsets.end(), cl.offset()), cl.offset());
+                            _intersections.append({cl,
+                                                   intersections.values[z].position
+                                                  });
                         }
                     }
                 }
@@ -1551,9 +1782,50 @@ namespace paper
             const auto & children = _other.children();
             for (auto & c : children)
             {
-                recursivelyIntersect(_self, brick::reinterpretEntity<Path>(c), _intersections);
+                recursivelyIntersect(_self, brick::reinterpretEntity<Path>(c), _intersections, _sortedOffsets);
             }
         }
+
+        inline Path booleanOperation(const Path & _a, const Path & _b, detail::BooleanOperation _op)
+        {
+            Mat3f toSpace = crunch::inverse(_a.absoluteTransform());
+            detail::BezierLoopArray loopsA, loopsB, result;
+            detail::appendBooleanLoops(_a, toSpace, loopsA);
+            detail::appendBooleanLoops(_b, toSpace, loopsB);
+            detail::booleanOperation(loopsA, _a.windingRule(), loopsB, _b.windingRule(), _op, result);
+
+            // the temporary geometry never touches the hub, only the final loops become items
+            Path ret = detail::createBooleanResult(_a, result);
+            ret.setTransform(_a.transform());
+            if (_a.parent().isValid())
+                ret.insertAbove(_a);
+            return ret;
+        }
+
+        // appends the stroke outlines of _path and its children, computed in the space of _toSpace * absoluteTransform()
+        inline void appendStrokeOutlines(const Path & _path, const Mat3f & _toSpace, detail::StrokeOutliner & _outliner,
+                                         detail::BezierLoopArray & _outLoops)
+        {
+            if (_path.curveCount())
+            {
+                Mat3f m = _toSpace * _path.absoluteTransform();
+                bool bTransformed = m != Mat3f::identity();
+
+                detail::BezierArray curves;
+                curves.reserve(_path.curveCount());
+                for (Size i = 0; i < _path.curveCount(); ++i)
+                {
+                    Bezier c = Curve(_path, i).bezier();
+                    if (bTransformed)
+                        c = Bezier(m * c.positionOne(), m * c.handleOne(), m * c.handleTwo(), m * c.positionTwo());
+                    curves.append(c);
+                }
+                _outliner.outline(curves, _path.isClosed(), _outLoops);
+            }
+
+            for (const Item & c : _path.children())
+                appendStrokeOutlines(brick::reinterpretEntity<Path>(c), _toSpace, _outliner, _outLoops);
+        }
     }
 
     IntersectionArray Path::intersections() const
@@ -1563,7 +1835,13 @@ namespace paper
 
     IntersectionArray Path::intersections(const Path & _other) const
     {
-        if (!bounds().overlaps(_other.bounds()))
+        // padded like the curve boxes of the broad phase
+        Rect a, b;
+        bool bEmptyA = true, bEmptyB = true;
+        detail::uniteLocalCurveBounds(*this, a, bEmptyA);
+        detail::uniteLocalCurveBounds(_other, b, bEmptyB);
+        Vec2f eps(detail::PaperConstants::geometricEpsilon() * 2);
+        if (bEmptyA || bEmptyB || !Rect(a.min() - eps, a.max() + eps).overlaps(b))
             return IntersectionArray();
         return intersectionsImpl(_other);
     }
@@ -1573,7 +1851,8 @@ namespace paper
         //@TODO: Take transformation matrix into account!!
         //@TODO: In terms of memory allocation and stuff this code is fucking gross :(
         IntersectionArray isecs;
-        detail::recursivelyIntersect(*this, _other, isecs);
+        stick::DynamicArray<Float> sortedOffsets(document().allocator());
+        detail::recursivelyIntersect(*this, _other, isecs, sortedOffsets);
 
         for (auto & c : children())
         {
@@ -1583,4 +1862,74 @@ namespace paper
 
         return isecs;
     }
+
+    Path Path::unite(const Path & _other) const
+    {
+        return detail::booleanOperation(*this, _other, detail::BooleanOperation::Unite);
+    }
+
+    Path Path::intersect(const Path & _other) const
+    {
+        return detail::booleanOperation(*this, _other, detail::BooleanOperation::Intersect);
+    }
+
+    Path Path::subtract(const Path & _other) const
+    {
+        return detail::booleanOperation(*this, _other, detail::BooleanOperation::Subtract);
+    }
+
+    Path Path::exclude(const Path & _other) const
+    {
+        return detail::booleanOperation(*this, _other, detail::BooleanOperation::Exclude);
+    }
+
+    Group Path::divide(const Path & _other) const
+    {
+        Group ret = document().createGroup();
+        if (parent().isValid())
+            ret.insertAbove(*this);
+        Path parts[2] = {intersect(_other), subtract(_other)};
+        for (Path & p : parts)
+        {
+            if (p.segmentCount())
+                ret.addChild(p);
+            else
+                p.remove();
+        }
+        return ret;
+    }
+
+    Path Path::strokeToPath(Float _tolerance) const
+    {
+        //the width of a non scaling stroke is in document space, so that's where its outline is computed
+        bool bScalingStroke = isScalingStroke();
+        Mat3f fromSpace = bScalingStroke ? Mat3f::identity() : absoluteTransform();
+        detail::BezierLoopArray loops;
+        if (hasStroke())
+        {
+            detail::StrokeOutliner outliner(strokeWidth(), strokeJoin(), strokeCap(), miterLimit(),
+                                            dashArray(), dashOffset(), _tolerance);
+            detail::appendStrokeOutlines(*this, fromSpace * crunch::inverse(absoluteTransform()), outliner, loops);
+        }
+
+        if (!bScalingStroke)
+        {
+            Mat3f toSpace = crunch::inverse(fromSpace);
+            for (detail::BezierArray & loop : loops)
+            {
+                for (Bezier & c : loop)
+                    c = Bezier(toSpace * c.positionOne(), toSpace * c.handleOne(), toSpace * c.handleTwo(), toSpace * c.positionTwo());
+            }
+        }
+
+        // the temporary geometry never touches the hub, only the final loops become items
+        Path ret = detail::createBooleanResult(*this, loops);
+        ret.set<comps::Fill>(stroke());
+        ret.setNoStroke();
+        ret.setWindingRule(WindingRule::NonZero);
+        ret.setTransform(transform());
+        if (parent().isValid())
+            ret.insertAbove(*this);
+        return ret;
+    }
 }
@@ -8,6 +8,7 @@
 namespace paper
 {
     class CurveLocation;
+    class Group;
     struct Intersection;
     
     using IntersectionArray = stick::DynamicArray<Intersection>;
@@ -29,10 +30,12 @@ namespace paper
 
         static constexpr EntityType itemType = EntityType::Path;
 
-        using SegmentView = detail::ContainerView<false, SegmentArray, Segment>;
-        using SegmentViewConst = detail::ContainerView<true, SegmentArray, Segment>;
-        using CurveView = detail::ContainerView<false, CurveArray, Curve>;
-        using CurveViewConst = detail::ContainerView<true, CurveArray, Curve>;
+        class Builder;
+
+        using SegmentView = detail::ProxyView<Path, Segment>;
+        using SegmentViewConst = detail::ProxyView<Path, const Segment>;
+        using CurveView = detail::ProxyView<Path, Curve>;
+        using CurveViewConst = detail::ProxyView<Path, const Curve>;
 
         Path();
 
@@ -76,9 +79,22 @@ namespace paper
 
         void addSegment(const Vec2f & _point, const Vec2f & _handleIn, const Vec2f & _handleOut);
 
-        Segment & insertSegment(stick::Size _index, const Vec2f & _point,
-                                const Vec2f & _handleIn = Vec2f(0.0),
-                                const Vec2f & _handleOut = Vec2f(0.0));
+        //appends _count segments from contiguous buffers in one go.
+        //_handlesIn and _handlesOut may be nullptr.
+        void addSegments(const Vec2f * _positions, stick::Size _count);
+
+        void addSegments(const Vec2f * _positions, const Vec2f * _handlesIn,
+                         const Vec2f * _handlesOut, stick::Size _count);
+
+        //replaces all segments of the path.
+        void setSegments(const Vec2f * _positions, stick::Size _count);
+
+        void setSegments(const Vec2f * _positions, const Vec2f * _handlesIn,
+                         const Vec2f * _handlesOut, stick::Size _count);
+
+        Segment insertSegment(stick::Size _index, const Vec2f & _point,
+                              const Vec2f & _handleIn = Vec2f(0.0),
+                              const Vec2f & _handleOut = Vec2f(0.0));
 
         void removeSegment(stick::Size _index);
 
@@ -111,13 +127,13 @@ namespace paper
 
         void setClockwise(bool _b);
 
-        Curve & curve(stick::Size _index);
+        Curve curve(stick::Size _index);
 
-        const Curve & curve(stick::Size _index) const;
+        const Curve curve(stick::Size _index) const;
 
-        Segment & segment(stick::Size _index);
+        Segment segment(stick::Size _index);
 
-        const Segment & segment(stick::Size _index) const;
+        const Segment segment(stick::Size _index) const;
 
         stick::Size curveCount() const;
 
@@ -177,6 +193,13 @@ namespace paper
 
         bool contains(const Vec2f & _p) const;
 
+        //tests _count points at once and writes the results to _outResults. The bounds
+        //and cached curves are only looked up once, so this is a lot faster than calling
+        //contains() for each point.
+        void contains(const Vec2f * _points, stick::Size _count, bool * _outResults) const;
+
+        stick::DynamicArray<bool> contains(const stick::DynamicArray<Vec2f> & _points) const;
+
         Path clone() const;
 
         SegmentArray & segmentArray();
@@ -192,20 +215,56 @@ namespace paper
 
         IntersectionArray intersections(const Path & _other) const;
 
+        //boolean operations. The result is a new (compound) path that has the transform
+        //and style of this path and is inserted above it. Self intersections of the
+        //operands are not resolved.
+        Path unite(const Path & _other) const;
+
+        Path intersect(const Path & _other) const;
+
+        Path subtract(const Path & _other) const;
+
+        Path exclude(const Path & _other) const;
+
+        //splits this path into the parts inside and outside of _other, returned in a group.
+        Group divide(const Path & _other) const;
+
+        //returns a new (compound) path that is filled with the stroke of this path, including
+        //its joins, caps and dashes. Curves stay curves, their offsets deviate at most _tolerance
+        //(in the units of the stroke width) from the exact ones. The outline can overlap itself
+        //and is filled with the non zero rule. Like the boolean operations, the result has the
+        //transform of this path and is inserted above it.
+        Path strokeToPath(Float _tolerance = 0.05) const;
+
 
     private:
 
-        Segment & createSegment(const Vec2f & _pos, const Vec2f & _handleIn, const Vec2f & _handleOut);
+        Segment createSegment(const Vec2f & _pos, const Vec2f & _handleIn, const Vec2f & _handleOut);
 
         IntersectionArray intersectionsImpl(const Path & _other) const;
 
 
         //called from Segment
-        void segmentChanged(const Segment & _seg);
+        void segmentChanged(stick::Size _index);
+
+        //updates curves and dirty state after segments were appended
+        //to the segment array directly, starting at _firstIndex.
+        void segmentsAppended(stick::Size _firstIndex);
 
         void rebuildCurves();
 
-        void updateSegmentIndices(stick::Size _from, stick::Size _to);
+        //invalidates the cumulative curve offsets starting at _curveIndex
+        void markCurveOffsetsDirty(stick::Size _curveIndex);
+
+        //lazily recomputes the dirty part of the cumulative curve offsets
+        void updateCurveOffsets() const;
+
+        //offset of the start of the curve at _curveIndex along the path
+        Float curveOffset(stick::Size _curveIndex) const;
+
+        //binary searches the index of the curve that contains _offset,
+        //returns curveCount() if _offset is past the end of the path.
+        stick::Size curveIndexAt(Float _offset) const;
 
         BoundsResult computeBoundsImpl(Float _padding, const Mat3f * _transform);
 
@@ -215,11 +274,40 @@ namespace paper
 
         BoundsResult computeStrokeBounds(const Mat3f * _transform);
 
-        stick::Error arcHelper(Float _extentDeg, Segment & _segment, const Vec2f & _direction, const Vec2f & _to,
+        stick::Error arcHelper(Float _extentDeg, Segment _segment, const Vec2f & _direction, const Vec2f & _to,
                                const Vec2f & _center, const Mat3f * _transform);
 
         void applyTransform(const Mat3f & _transform);
     };
+
+    //Builder appends segments to a path without updating the curves, lengths
+    //and bounds of the path for every single segment. All of that happens once
+    //when finish() is called or the builder goes out of scope. The path should
+    //not be queried while the builder is active.
+    class STICK_API Path::Builder
+    {
+    public:
+
+        Builder(const Path & _path, stick::Size _reserve = 0);
+
+        Builder(const Builder &) = delete;
+
+        Builder & operator = (const Builder &) = delete;
+
+        ~Builder();
+
+        void addPoint(const Vec2f & _to);
+
+        void addSegment(const Vec2f & _point, const Vec2f & _handleIn, const Vec2f & _handleOut);
+
+        void finish();
+
+    private:
+
+        Path m_path;
+        stick::Size m_firstIndex;
+        bool m_bFinished;
+    };
 }
 
 #endif //PAPER_PATH_HPP
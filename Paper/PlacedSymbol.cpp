@@ -27,4 +27,9 @@ namespace paper
         }
         Item::remove();
     }
+
+    PlacedSymbol PlacedSymbol::clone() const
+    {
+        return brick::reinterpretEntity<PlacedSymbol>(Item::clone());
+    }
 }
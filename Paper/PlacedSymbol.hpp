@@ -25,6 +25,8 @@ namespace paper
         Symbol symbol() const;
 
         void remove();
+
+        PlacedSymbol clone() const;
     };
 }
 
@@ -1,4 +1,6 @@
 #include <Paper/Private/BooleanOperations.hpp>
+#include <Paper/Private/ThreadPool.hpp>
+#include <Paper/Document.hpp>
 #include <Paper/Path.hpp>
 #include <Paper/Curve.hpp>
 #include <Paper/Segment.hpp>
@@ -6,6 +8,11 @@
 
 #include <Crunch/StringConversion.hpp>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PAPER_WINDING_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace paper
 {
     namespace detail
@@ -41,9 +48,11 @@ namespace paper
 
         static void handleCurve(const Bezier & _c, MonoCurveLoop & _target)
         {
-            // Filter out curves of zero length.
+            // Filter out curves of zero length, which is only the case if all of their
+            // points coincide (that's a lot cheaper than computing the length).
             // TODO: Do not filter this here.
-            if (_c.length() == 0)
+            if (_c.positionOne() == _c.handleOne() && _c.handleOne() == _c.handleTwo() &&
+                    _c.handleTwo() == _c.positionTwo())
             {
                 return;
             }
@@ -101,11 +110,128 @@ namespace paper
             }
         }
 
+        //loops with less curves than this are just iterated linearly
+        static const Size s_minBandedCurveCount = 32;
+
+        static Int32 bandIndex(const MonoCurveLoop & _loop, Float _y, Int32 _bandCount)
+        {
+            Int32 ret = (Int32)std::floor((_y - _loop.minY) * _loop.bandScale);
+            return std::min(std::max(ret, 0), _bandCount - 1);
+        }
+
+        static void buildBands(MonoCurveLoop & _loop)
+        {
+            _loop.bandOffsets.clear();
+            _loop.bandCurves.clear();
+
+            Size count = _loop.monoCurves.count();
+            if (count < s_minBandedCurveCount || !(_loop.maxY > _loop.minY))
+                return;
+
+            Float minY = _loop.minY;
+            Float maxY = _loop.maxY;
+
+            //about four curves per band. Curves that span many bands are stored in each
+            //of them, so we use less bands if that would blow up the index.
+            Int32 bandCount = (Int32)std::min(count / 4, (Size)4096);
+            Size entryCount;
+            while (true)
+            {
+                _loop.bandScale = bandCount / (maxY - minY);
+                entryCount = 0;
+                for (const MonoCurve & c : _loop.monoCurves)
+                {
+                    Float y0 = c.bezier.positionOne().y;
+                    Float y1 = c.bezier.positionTwo().y;
+                    entryCount += bandIndex(_loop, std::max(y0, y1), bandCount) -
+                                  bandIndex(_loop, std::min(y0, y1), bandCount) + 1;
+                }
+                if (entryCount <= count * 8 || bandCount == 1)
+                    break;
+                bandCount /= 2;
+            }
+
+            _loop.bandOffsets.resize(bandCount + 1, 0);
+            for (const MonoCurve & c : _loop.monoCurves)
+            {
+                Float y0 = c.bezier.positionOne().y;
+                Float y1 = c.bezier.positionTwo().y;
+                Int32 to = bandIndex(_loop, std::max(y0, y1), bandCount);
+                for (Int32 b = bandIndex(_loop, std::min(y0, y1), bandCount); b <= to; ++b)
+                    ++_loop.bandOffsets[b + 1];
+            }
+            for (Int32 b = 0; b < bandCount; ++b)
+                _loop.bandOffsets[b + 1] += _loop.bandOffsets[b];
+
+            //filling the bands in curve order keeps the indices of each band sorted
+            MonoCurveIndexArray cursors(_loop.bandOffsets);
+            _loop.bandCurves.resize(entryCount);
+            for (Size i = 0; i < count; ++i)
+            {
+                Float y0 = _loop.monoCurves[i].bezier.positionOne().y;
+                Float y1 = _loop.monoCurves[i].bezier.positionTwo().y;
+                Int32 to = bandIndex(_loop, std::max(y0, y1), bandCount);
+                for (Int32 b = bandIndex(_loop, std::min(y0, y1), bandCount); b <= to; ++b)
+                    _loop.bandCurves[cursors[b]++] = (UInt32)i;
+            }
+        }
+
+        static void buildEdgeTable(MonoCurveLoop & _loop)
+        {
+            _loop.bPolygon = true;
+            _loop.inverseSlopes.clear();
+            _loop.inverseSlopes.reserve(_loop.monoCurves.count());
+            for (const MonoCurve & c : _loop.monoCurves)
+            {
+                Vec2f d = c.bezier.positionTwo() - c.bezier.positionOne();
+                //horizontal curves never need an intersection
+                _loop.inverseSlopes.append(c.winding ? d.x / d.y : 0);
+            }
+        }
+
+        static void buildLoopIndex(MonoCurveLoop & _loop, bool _bPolygon)
+        {
+            _loop.minY = std::numeric_limits<Float>::infinity();
+            _loop.maxY = -std::numeric_limits<Float>::infinity();
+            for (const MonoCurve & c : _loop.monoCurves)
+            {
+                //mono curves are monotonic in y, their end points span their y range
+                _loop.minY = std::min(_loop.minY, std::min(c.bezier.positionOne().y, c.bezier.positionTwo().y));
+                _loop.maxY = std::max(_loop.maxY, std::max(c.bezier.positionOne().y, c.bezier.positionTwo().y));
+            }
+
+            buildBands(_loop);
+            _loop.bPolygon = false;
+            if (_bPolygon)
+                buildEdgeTable(_loop);
+        }
+
+        // The inverse transforms of the loops go stale if the path, one of its children or
+        // one of its parents gets transformed.
+        static bool monoCurvesValid(const Path & _path, const MonoCurveLoopArray & _loops)
+        {
+            const ItemArray & children = _path.children();
+            if (_loops.count() != children.count() + 1 || _loops[0].transformVersion != _path.absoluteTransformVersion())
+                return false;
+
+            for (Size i = 0; i < children.count(); ++i)
+            {
+                if (_loops[i + 1].transformVersion != children[i].absoluteTransformVersion())
+                    return false;
+            }
+            return true;
+        }
+
         const MonoCurveLoopArray & monoCurves(Path & _path)
         {
+            auto mcached = _path.maybe<comps::MonoCurves>();
+            if (mcached && !monoCurvesValid(_path, *mcached))
+                _path.removeComponent<comps::MonoCurves>();
+
             if (!_path.hasComponent<comps::MonoCurves>())
             {
                 MonoCurveLoop data;
+                data.transformVersion = _path.absoluteTransformVersion();
                 if (_path.absoluteTransform() != Mat3f::identity())
                 {
                     data.bTransformed = true;
@@ -114,9 +240,8 @@ namespace paper
                 else
                     data.bTransformed = false;
 
-                const CurveArray & curves = _path.curveArray();
-                for (auto & c : curves)
-                    handleCurve(c->bezier(), data);
+                for (const Curve & c : _path.curves())
+                    handleCurve(c.bezier(), data);
 
                 // If the path is not closed, we need to join the end points with a
                 // straight line, just like how filling open paths works.
@@ -124,11 +249,13 @@ namespace paper
                 if (!_path.isClosed() && _path.segmentArray().count() > 1)
                 {
                     auto & segs = _path.segmentArray();
-                    Bezier tmp(segs.last()->position(), segs.last()->position(),
-                               segs.first()->position(), segs.first()->position());
+                    Bezier tmp(segs.positions.last(), segs.positions.last(),
+                               segs.positions.first(), segs.positions.first());
                     handleCurve(tmp, data);
                 }
 
+                buildLoopIndex(data, _path.isPolygon());
+
                 MonoCurveLoopArray loops;
                 loops.append(data);
 
@@ -154,6 +281,308 @@ namespace paper
             return _path.get<comps::MonoCurves>();
         }
 
+        struct STICK_LOCAL WindingCounts
+        {
+            Int32 windingLeft;
+            Int32 windingRight;
+            // Separately count the windings for points on curves.
+            Int32 windLeftOnCurve;
+            Int32 windRightOnCurve;
+        };
+
+        // The state of a point while walking the curves of one loop.
+        struct STICK_LOCAL LoopWinding
+        {
+            Float xBefore;
+            Float xAfter;
+            Int32 prevWinding;
+            Float prevXEnd;
+            bool bIsOnCurve;
+        };
+
+        // A curve crossing the horizontal line at the y of a query point. The
+        // intercept only depends on y, so points on the same line share it.
+        struct STICK_LOCAL ScanlineCrossing
+        {
+            const MonoCurve * curve;
+            Float x;
+            bool bGotX;
+        };
+
+        using ScanlineCrossingArray = DynamicArray<ScanlineCrossing>;
+
+        // A crossing that needs the full rules of addCrossing, together with the state
+        // of the previous non-horizontal crossing on its line.
+        struct STICK_LOCAL OrderedCrossing
+        {
+            ScanlineCrossing crossing;
+            Int32 prevWinding;
+            Float prevXEnd;
+        };
+
+        // The crossings of one horizontal line, prepared for all query points on it.
+        // The state a crossing sees only depends on the crossings before it, not on
+        // the point, so every point can add up the crossings in any order.
+        struct STICK_LOCAL LineCrossings
+        {
+            // crossings of non-horizontal curves away from their start, they only
+            // depend on the side of the point their x is on.
+            DynamicArray<Float> xs;
+            DynamicArray<Float> windings;
+            DynamicArray<OrderedCrossing> ordered;
+        };
+
+        // Calls _fn with the curves of _loop that can cross the line at _y, in order.
+        template<class F>
+        static void forEachCandidate(Float _y, const MonoCurveLoop & _loop, F _fn)
+        {
+            // Curves that don't cross the line don't change the winding state,
+            // so it's enough to visit the ones in the band of the point.
+            if (_loop.bandOffsets.count())
+            {
+                if (_y >= _loop.minY && _y <= _loop.maxY)
+                {
+                    Int32 band = bandIndex(_loop, _y, _loop.bandOffsets.count() - 1);
+                    for (UInt32 i = _loop.bandOffsets[band]; i < _loop.bandOffsets[band + 1]; ++i)
+                        _fn(_loop.monoCurves[_loop.bandCurves[i]]);
+                }
+            }
+            else
+            {
+                for (const MonoCurve & curve : _loop.monoCurves)
+                    _fn(curve);
+            }
+        }
+
+        // Returns true if the curve crosses the line at _y and calculates the x value of
+        // the intersection for non-horizontal curves.
+        static bool scanlineCrossing(Float _y, const MonoCurveLoop & _loop, const MonoCurve & _curve, ScanlineCrossing & _out)
+        {
+            Float yStart = _curve.bezier.positionOne().y;
+            Float yEnd = _curve.bezier.positionTwo().y;
+
+            // Since the curves are monotonic in y direction, we can just
+            // compare the endpoints of the curve to determine if the ray
+            // from query point along +-x direction will intersect the
+            // monotonic curve.
+            if (!((_y >= yStart && _y <= yEnd) || (_y >= yEnd && _y <= yStart)))
+                return false;
+
+            _out.curve = &_curve;
+            _out.bGotX = _curve.winding != 0;
+            if (_out.bGotX)
+            {
+                // Calculate the x value for the ray's intersection.
+                if (_y == yStart)
+                {
+                    _out.x = _curve.bezier.positionOne().x;
+                }
+                else if (_y == yEnd)
+                {
+                    _out.x = _curve.bezier.positionTwo().x;
+                }
+                else if (_loop.bPolygon)
+                {
+                    _out.x = _curve.bezier.positionOne().x + (_y - yStart) * _loop.inverseSlopes[&_curve - &_loop.monoCurves[0]];
+                }
+                else
+                {
+                    auto roots = _curve.bezier.solveCubic(_y, false, 0, 1);
+                    if (roots.count == 1)
+                    {
+                        _out.x = _curve.bezier.positionAt(roots.values[0]).x;
+                    }
+                    else
+                    {
+                        _out.bGotX = false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        static void beginLoopWinding(const Vec2f & _p, const MonoCurveLoop & _loop, LoopWinding & _state)
+        {
+            Float epsilon = detail::PaperConstants::windingEpsilon();
+            _state.xBefore = _p.x - epsilon;
+            _state.xAfter = _p.x + epsilon;
+            // The first curve of a loop holds the last curve with non-zero
+            // winding. Retrieve and use it here.
+            _state.prevWinding = _loop.last.winding;
+            _state.prevXEnd = _loop.last.bezier.positionTwo().x;
+            _state.bIsOnCurve = false;
+        }
+
+        static void addCrossing(const Vec2f & _p, const ScanlineCrossing & _crossing,
+                                LoopWinding & _state, WindingCounts & _counts)
+        {
+            const MonoCurve & curve = *_crossing.curve;
+            Int32 winding = curve.winding;
+            if (winding != 0)
+            {
+                Float x = _crossing.x;
+                Float yStart = curve.bezier.positionOne().y;
+                if (_crossing.bGotX)
+                {
+                    // Test if the point is on the current mono-curve.
+                    if (x >= _state.xBefore && x <= _state.xAfter)
+                    {
+                        _state.bIsOnCurve = true;
+                    }
+                    else if (
+                        // Count the intersection of the ray with the
+                        // monotonic curve if the crossing is not the
+                        // start of the curve, except if the winding
+                        // changes...
+                        (_p.y != yStart || winding != _state.prevWinding)
+                        // ...and the point is not on the curve or on
+                        // the horizontal connection between the last
+                        // non-horizontal curve's end point and the
+                        // current curve's start point.
+                        && !(_p.y == yStart
+                             && (_p.x - x) * (_p.x - _state.prevXEnd) < 0))
+                    {
+                        if (x < _state.xBefore)
+                        {
+                            _counts.windingLeft += winding;
+                        }
+                        else if (x > _state.xAfter)
+                        {
+                            _counts.windingRight += winding;
+                        }
+                    }
+                }
+
+                // Update previous winding and end coordinate whenever
+                // the ray intersects a non-horizontal curve.
+                _state.prevWinding = winding;
+                _state.prevXEnd = curve.bezier.positionTwo().x;
+            }
+            // Test if the point is on the horizontal curve.
+            else if ((_p.x - curve.bezier.positionOne().x) * (_p.x - curve.bezier.positionTwo().x) <= 0)
+            {
+                _state.bIsOnCurve = true;
+            }
+        }
+
+        static void prepareLineCrossings(Float _y, const MonoCurveLoop & _loop,
+                                         const ScanlineCrossingArray & _crossings, LineCrossings & _out)
+        {
+            _out.xs.clear();
+            _out.windings.clear();
+            _out.ordered.clear();
+            Int32 prevWinding = _loop.last.winding;
+            Float prevXEnd = _loop.last.bezier.positionTwo().x;
+            for (const ScanlineCrossing & sc : _crossings)
+            {
+                const MonoCurve & curve = *sc.curve;
+                if (curve.winding != 0 && sc.bGotX && _y != curve.bezier.positionOne().y)
+                {
+                    _out.xs.append(sc.x);
+                    _out.windings.append((Float)curve.winding);
+                }
+                else
+                {
+                    OrderedCrossing oc = {sc, prevWinding, prevXEnd};
+                    _out.ordered.append(oc);
+                }
+
+                if (curve.winding != 0)
+                {
+                    prevWinding = curve.winding;
+                    prevXEnd = curve.bezier.positionTwo().x;
+                }
+            }
+        }
+
+        // Same as calling addCrossing for each of the x values in _xs, which all belong
+        // to non-horizontal curves that are not crossed at their start.
+        static void addSideCrossings(const Float * _xs, const Float * _windings, Size _count,
+                                     LoopWinding & _state, WindingCounts & _counts)
+        {
+            Float left = 0;
+            Float right = 0;
+            bool bIsOnCurve = false;
+            Size i = 0;
+#ifdef PAPER_WINDING_SSE
+            static_assert(sizeof(Float) == sizeof(float), "the SSE winding kernel only supports 32 bit floats");
+
+            // four crossings per iteration, the windings are summed up as floats (they are
+            // small integers, so that is exact)
+            __m128 before = _mm_set1_ps(_state.xBefore);
+            __m128 after = _mm_set1_ps(_state.xAfter);
+            __m128 leftSum = _mm_setzero_ps();
+            __m128 rightSum = _mm_setzero_ps();
+            int onCurveMask = 0;
+            for (; i + 4 <= _count; i += 4)
+            {
+                __m128 x = _mm_loadu_ps(_xs + i);
+                __m128 w = _mm_loadu_ps(_windings + i);
+                __m128 bLeft = _mm_cmplt_ps(x, before);
+                __m128 bRight = _mm_cmpgt_ps(x, after);
+                leftSum = _mm_add_ps(leftSum, _mm_and_ps(bLeft, w));
+                rightSum = _mm_add_ps(rightSum, _mm_and_ps(bRight, w));
+                onCurveMask |= _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, before), _mm_cmple_ps(x, after)));
+            }
+
+            float sums[8];
+            _mm_storeu_ps(sums, leftSum);
+            _mm_storeu_ps(sums + 4, rightSum);
+            left = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+            right = (sums[4] + sums[5]) + (sums[6] + sums[7]);
+            bIsOnCurve = onCurveMask != 0;
+#endif
+            for (; i < _count; ++i)
+            {
+                Float x = _xs[i];
+                if (x >= _state.xBefore && x <= _state.xAfter)
+                    bIsOnCurve = true;
+                else if (x < _state.xBefore)
+                    left += _windings[i];
+                else if (x > _state.xAfter)
+                    right += _windings[i];
+            }
+
+            _counts.windingLeft += (Int32)left;
+            _counts.windingRight += (Int32)right;
+            _state.bIsOnCurve = _state.bIsOnCurve || bIsOnCurve;
+        }
+
+        static void endLoopWinding(const LoopWinding & _state, WindingCounts & _counts)
+        {
+            // If the point was on a curve of the loop, we increment / decrement
+            // the on-curve winding numbers as if the point was inside the path.
+            if (_state.bIsOnCurve)
+            {
+                _counts.windLeftOnCurve += 1;
+                _counts.windRightOnCurve -= 1;
+            }
+        }
+
+        // Adds the windings of a horizontal ray through _p (in the space of the loop) to _counts.
+        static void loopWinding(const Vec2f & _p, const MonoCurveLoop & _loop, WindingCounts & _counts)
+        {
+            LoopWinding state;
+            beginLoopWinding(_p, _loop, state);
+            ScanlineCrossing crossing;
+            forEachCandidate(_p.y, _loop, [&](const MonoCurve & _curve)
+            {
+                if (scanlineCrossing(_p.y, _loop, _curve, crossing))
+                    addCrossing(_p, crossing, state, _counts);
+            });
+            endLoopWinding(state, _counts);
+        }
+
+        static Int32 finishWinding(const WindingCounts & _counts)
+        {
+            // Use the on-curve windings if no other intersections were found or
+            // if they canceled each other. On single paths this ensures that
+            // the overall winding is 1 if the point was on a monotonic curve.
+            if (_counts.windingLeft == 0 && _counts.windingRight == 0)
+                return max(abs(_counts.windLeftOnCurve), abs(_counts.windRightOnCurve));
+            return max(abs(_counts.windingLeft), abs(_counts.windingRight));
+        }
+
         //@TODO: Update this to the changed implementation (apparently more stable) from paper.js develop
         Int32 winding(const Vec2f & _point, const MonoCurveLoopArray & _loops, bool _bHorizontal)
         {
@@ -205,137 +634,923 @@ namespace paper
             }
             else
             {
-                Float xBefore;
-                Float xAfter;
-                Int32 prevWinding;
-                Float prevXEnd;
-                bool bIsOnCurve = false;
-                // Separately count the windings for points on curves.
-                Int32 windLeftOnCurve = 0;
-                Int32 windRightOnCurve = 0;
-
+                WindingCounts counts = {0, 0, 0, 0};
                 for (const MonoCurveLoop & loop : _loops)
+                    loopWinding(loop.bTransformed ? loop.inverseTransform * _point : _point, loop, counts);
+                return finishWinding(counts);
+            }
+
+            return max(abs(windingLeft), abs(windingRight));
+        }
+
+        void windings(const Vec2f * _points, Size _count, const MonoCurveLoopArray & _loops, Int32 * _outWindings)
+        {
+            // Visiting the points sorted by y keeps consecutive queries in the same band
+            // of mono curves and groups the points that lie on the same horizontal line.
+            DynamicArray<UInt32> order;
+            order.resize(_count);
+            for (Size i = 0; i < _count; ++i)
+                order[i] = (UInt32)i;
+            bool bSortedByInput = false;
+
+            DynamicArray<WindingCounts> counts;
+            counts.resize(_count, (WindingCounts) {0, 0, 0, 0});
+            DynamicArray<Vec2f> transformed;
+            ScanlineCrossingArray crossings;
+            LineCrossings line;
+            for (const MonoCurveLoop & loop : _loops)
+            {
+                const Vec2f * points = _points;
+                if (loop.bTransformed)
                 {
-                    Vec2f p = loop.bTransformed ? loop.inverseTransform * _point : _point;
-                    xBefore = p.x - epsilon;
-                    xAfter = p.x + epsilon;
-                    for (Size i = 0; i < loop.monoCurves.count(); ++i)
+                    transformed.resize(_count);
+                    for (Size i = 0; i < _count; ++i)
+                        transformed[i] = loop.inverseTransform * _points[i];
+                    points = &transformed[0];
+                }
+
+                if (loop.bTransformed || !bSortedByInput)
+                {
+                    std::sort(order.begin(), order.end(), [points](UInt32 _a, UInt32 _b)
                     {
-                        const MonoCurve & curve = loop.monoCurves[i];
-                        Float yStart = curve.bezier.positionOne().y;
-                        Float yEnd = curve.bezier.positionTwo().y;
-                        Int32 winding = curve.winding;
-
-                        // The first curve of a loop holds the last curve with non-zero
-                        // winding. Retrieve and use it here.
-                        if (i == 0)
-                        {
-                            prevWinding = loop.last.winding;
-                            prevXEnd = loop.last.bezier.positionTwo().x;
-                            // Reset the on curve flag for each loop.
-                            bIsOnCurve = false;
-                        }
+                        return points[_a].y < points[_b].y;
+                    });
+                    bSortedByInput = !loop.bTransformed;
+                }
+
+                // points outside of the y range of the loop don't cross any of its curves
+                Size i = std::lower_bound(order.begin(), order.end(), loop.minY, [points](UInt32 _idx, Float _y)
+                {
+                    return points[_idx].y < _y;
+                }) - order.begin();
+                while (i < _count && points[order[i]].y <= loop.maxY)
+                {
+                    // the intersections with the line are shared by all points on it, so
+                    // the curves only need to be solved once per line.
+                    Float y = points[order[i]].y;
+                    crossings.clear();
+                    ScanlineCrossing crossing;
+                    forEachCandidate(y, loop, [&](const MonoCurve & _curve)
+                    {
+                        if (scanlineCrossing(y, loop, _curve, crossing))
+                            crossings.append(crossing);
+                    });
 
-                        // Since the curves are monotonic in y direction, we can just
-                        // compare the endpoints of the curve to determine if the ray
-                        // from query point along +-x direction will intersect the
-                        // monotonic curve.
-                        if ((p.y >= yStart && p.y <= yEnd) || (p.y >= yEnd && p.y <= yStart))
+                    // preparing the line only pays off if there are enough crossings to
+                    // fill a few SSE registers
+                    bool bPrepared = crossings.count() >= 8;
+                    if (bPrepared)
+                        prepareLineCrossings(y, loop, crossings, line);
+
+                    for (; i < _count && points[order[i]].y == y; ++i)
+                    {
+                        const Vec2f & p = points[order[i]];
+                        WindingCounts & c = counts[order[i]];
+                        LoopWinding state;
+                        beginLoopWinding(p, loop, state);
+                        if (bPrepared)
                         {
-                            if (winding != 0)
-                            {
-                                // Calculate the x value for the ray's intersection.
-                                Float x;
-                                bool bGotX = true;
-                                if (p.y == yStart)
-                                {
-                                    x = curve.bezier.positionOne().x;
-                                }
-                                else if (p.y == yEnd)
-                                {
-                                    x = curve.bezier.positionTwo().x;
-                                }
-                                else
-                                {
-                                    auto roots = curve.bezier.solveCubic(p.y, false, 0, 1);
-                                    if (roots.count == 1)
-                                    {
-                                        x = curve.bezier.positionAt(roots.values[0]).x;
-                                    }
-                                    else
-                                    {
-                                        bGotX = false;
-                                    }
-                                }
-
-                                if (bGotX)
-                                {
-                                    // Test if the point is on the current mono-curve.
-                                    if (x >= xBefore && x <= xAfter)
-                                    {
-                                        bIsOnCurve = true;
-                                    }
-                                    else if (
-                                        // Count the intersection of the ray with the
-                                        // monotonic curve if the crossing is not the
-                                        // start of the curve, except if the winding
-                                        // changes...
-                                        (p.y != yStart || winding != prevWinding)
-                                        // ...and the point is not on the curve or on
-                                        // the horizontal connection between the last
-                                        // non-horizontal curve's end point and the
-                                        // current curve's start point.
-                                        && !(p.y == yStart
-                                             && (p.x - x) * (p.x - prevXEnd) < 0))
-                                    {
-                                        if (x < xBefore)
-                                        {
-                                            windingLeft += winding;
-                                        }
-                                        else if (x > xAfter)
-                                        {
-                                            windingRight += winding;
-                                        }
-                                    }
-                                }
-
-                                // Update previous winding and end coordinate whenever
-                                // the ray intersects a non-horizontal curve.
-                                prevWinding = winding;
-                                prevXEnd = curve.bezier.positionTwo().x;
-                            }
-                            // Test if the point is on the horizontal curve.
-                            else if ((p.x - curve.bezier.positionOne().x) * (p.x - curve.bezier.positionTwo().x) <= 0)
+                            if (line.xs.count())
+                                addSideCrossings(&line.xs[0], &line.windings[0], line.xs.count(), state, c);
+                            for (const OrderedCrossing & oc : line.ordered)
                             {
-                                bIsOnCurve = true;
+                                state.prevWinding = oc.prevWinding;
+                                state.prevXEnd = oc.prevXEnd;
+                                addCrossing(p, oc.crossing, state, c);
                             }
                         }
+                        else
+                        {
+                            for (const ScanlineCrossing & sc : crossings)
+                                addCrossing(p, sc, state, c);
+                        }
+                        endLoopWinding(state, c);
+                    }
+                }
+            }
+
+            for (Size i = 0; i < _count; ++i)
+                _outWindings[i] = finishWinding(counts[i]);
+        }
+
+        static void monoCurves(const BezierLoopArray & _loops, MonoCurveLoopArray & _outLoops)
+        {
+            for (const BezierArray & loop : _loops)
+            {
+                MonoCurveLoop data;
+                data.bTransformed = false;
+                data.last.winding = 0;
+                bool bPolygon = true;
+                for (const Bezier & c : loop)
+                {
+                    handleCurve(c, data);
+                    bPolygon = bPolygon && c.handleOne() == c.positionOne() && c.handleTwo() == c.positionTwo();
+                }
+                buildLoopIndex(data, bPolygon);
+                _outLoops.append(data);
+            }
+        }
+
+        // The curves of both operands of a boolean operation live in one array, the curves
+        // of each loop are stored contiguously.
+        struct STICK_LOCAL BooleanLoop
+        {
+            UInt32 first;
+            UInt32 count;
+            bool bFromB;
+            // true if any curve of the loop touches the other operand
+            bool bSplit;
+        };
+
+        // A location on a curve where it has to be split. Nodes identify the points where
+        // the pieces of the curves connect. The first node of each curve is its start
+        // vertex, all other nodes are created for the split points.
+        struct STICK_LOCAL SplitPoint
+        {
+            bool operator < (const SplitPoint & _other) const
+            {
+                return curve < _other.curve || (curve == _other.curve && t < _other.t);
+            }
+
+            UInt32 curve;
+            Float t;
+            UInt32 node;
+        };
+
+        struct STICK_LOCAL BooleanEdge
+        {
+            Bezier bezier;
+            UInt32 from;
+            UInt32 to;
+            UInt32 loop;
+        };
+
+        struct STICK_LOCAL BooleanGraph
+        {
+            BezierArray curves;
+            DynamicArray<Rect> bounds;
+            DynamicArray<UInt32> curveLoops;
+            DynamicArray<BooleanLoop> loops;
+            // union find over the nodes, nodes that coincide are merged into one.
+            DynamicArray<UInt32> parents;
+            DynamicArray<SplitPoint> splits;
+        };
+
+        static void addOperand(BooleanGraph & _graph, const BezierLoopArray & _loops, bool _bFromB)
+        {
+            for (const BezierArray & loop : _loops)
+            {
+                if (!loop.count())
+                    continue;
+
+                UInt32 idx = (UInt32)_graph.loops.count();
+                _graph.loops.append({(UInt32)_graph.curves.count(), (UInt32)loop.count(), _bFromB, false});
+                for (const Bezier & c : loop)
+                {
+                    _graph.parents.append((UInt32)_graph.curves.count());
+                    _graph.curves.append(c);
+                    _graph.bounds.append(c.bounds());
+                    _graph.curveLoops.append(idx);
+                }
+            }
+        }
+
+        static UInt32 findNode(BooleanGraph & _graph, UInt32 _node)
+        {
+            while (_graph.parents[_node] != _node)
+            {
+                _graph.parents[_node] = _graph.parents[_graph.parents[_node]];
+                _node = _graph.parents[_node];
+            }
+            return _node;
+        }
+
+        static void mergeNodes(BooleanGraph & _graph, UInt32 _a, UInt32 _b)
+        {
+            _a = findNode(_graph, _a);
+            _b = findNode(_graph, _b);
+            if (_a != _b)
+                _graph.parents[std::max(_a, _b)] = std::min(_a, _b);
+        }
+
+        static UInt32 vertexNode(const BooleanGraph & _graph, UInt32 _curve, bool _bEnd)
+        {
+            if (!_bEnd)
+                return _curve;
+            const BooleanLoop & loop = _graph.loops[_graph.curveLoops[_curve]];
+            return loop.first + (_curve - loop.first + 1) % loop.count;
+        }
+
+        // split locations closer than this in curve time are the same point. It has to stay
+        // far below curveTimeEpsilon, which moves a crossing on a long curve by more than the
+        // geometric epsilon (possibly to the wrong side of the other operand).
+        static Float splitTimeEpsilon()
+        {
+            return static_cast<Float>(1e-7);
+        }
 
-                        // If we are at the end of a loop and the point was on a curve
-                        // of the loop, we increment / decrement the on-curve winding
-                        // numbers as if the point was inside the path.
-                        if (bIsOnCurve && (i >= loop.monoCurves.count() - 1))
+        // returns the node at _t on _curve. Locations close to the ends of the curve snap
+        // to its vertices, split points close to each other are merged later.
+        static UInt32 splitNode(BooleanGraph & _graph, UInt32 _curve, Float _t)
+        {
+            _graph.loops[_graph.curveLoops[_curve]].bSplit = true;
+
+            // the ends of curves without handles move slowly in time, so the location is
+            // compared to the vertices too.
+            Float eps = splitTimeEpsilon();
+            Float geomEps = detail::PaperConstants::geometricEpsilon();
+            const Bezier & c = _graph.curves[_curve];
+            Vec2f p = c.positionAt(_t);
+            if (_t <= eps || crunch::distance(p, c.positionOne()) <= geomEps)
+                return vertexNode(_graph, _curve, false);
+            if (_t >= 1 - eps || crunch::distance(p, c.positionTwo()) <= geomEps)
+                return vertexNode(_graph, _curve, true);
+
+            UInt32 node = (UInt32)_graph.parents.count();
+            _graph.parents.append(node);
+            _graph.splits.append({_curve, _t, node});
+            return node;
+        }
+
+        // returns true if the end point of _other lies on _curve and writes its parameter on _curve to _outT.
+        static bool touchingEnd(const BooleanGraph & _graph, UInt32 _curve, UInt32 _other, bool _bEnd, Float & _outT)
+        {
+            Float eps = detail::PaperConstants::geometricEpsilon();
+            const Bezier & other = _graph.curves[_other];
+            Vec2f p = _bEnd ? other.positionTwo() : other.positionOne();
+            const Rect & b = _graph.bounds[_curve];
+            if (p.x < b.min().x - eps || p.y < b.min().y - eps || p.x > b.max().x + eps || p.y > b.max().y + eps)
+                return false;
+
+            Float dist;
+            _outT = _graph.curves[_curve].closestParameter(p, dist, 0, 1, 0);
+            return dist < eps;
+        }
+
+        static void intersectCurves(BooleanGraph & _graph, UInt32 _a, UInt32 _b)
+        {
+            // Curves that overlap don't intersect in isolated points, the end points of each
+            // curve that lie on the other one are where they need to be split.
+            Float ts[4];
+            bool bTouching[4] =
+            {
+                touchingEnd(_graph, _a, _b, false, ts[0]),
+                touchingEnd(_graph, _a, _b, true, ts[1]),
+                touchingEnd(_graph, _b, _a, false, ts[2]),
+                touchingEnd(_graph, _b, _a, true, ts[3])
+            };
+
+            // the range of _a that touches _b
+            Float from = 1;
+            Float to = 0;
+            Size count = 0;
+            for (Size i = 0; i < 4; ++i)
+            {
+                if (!bTouching[i])
+                    continue;
+                Float t = i < 2 ? ts[i] : (i == 2 ? 0 : 1);
+                from = std::min(from, t);
+                to = std::max(to, t);
+                ++count;
+            }
+
+            // Overlapping curves and parallel lines only meet where they touch, intersecting
+            // them would just yield arbitrary points along the overlap.
+            const Bezier & a = _graph.curves[_a];
+            const Bezier & b = _graph.curves[_b];
+            bool bTouchOnly = false;
+            if (count >= 2 && to - from > detail::PaperConstants::curveTimeEpsilon())
+            {
+                Float dist;
+                b.closestParameter(a.positionAt((from + to) * 0.5), dist, 0, 1, 0);
+                bTouchOnly = dist < detail::PaperConstants::geometricEpsilon();
+            }
+            if (!bTouchOnly && a.isStraight() && b.isStraight())
+            {
+                Vec2f da = crunch::normalize(a.positionTwo() - a.positionOne());
+                Vec2f db = crunch::normalize(b.positionTwo() - b.positionOne());
+                bTouchOnly = std::abs(crunch::cross(da, db)) < detail::PaperConstants::geometricEpsilon();
+            }
+
+            if (!bTouchOnly)
+            {
+                auto res = a.intersections(b);
+                for (Int32 z = 0; z < res.count; ++z)
+                {
+                    mergeNodes(_graph, splitNode(_graph, _a, res.values[z].parameterOne),
+                               splitNode(_graph, _b, res.values[z].parameterTwo));
+                }
+            }
+
+            for (Size i = 0; i < 4; ++i)
+            {
+                if (!bTouching[i])
+                    continue;
+                UInt32 curve = i < 2 ? _a : _b;
+                UInt32 other = i < 2 ? _b : _a;
+                mergeNodes(_graph, splitNode(_graph, curve, ts[i]), vertexNode(_graph, other, i % 2 == 1));
+            }
+        }
+
+        static void intersectOperands(BooleanGraph & _graph)
+        {
+            struct Box
+            {
+                Float minX;
+                Float maxX;
+                UInt32 curve;
+            };
+
+            // sort and sweep along the x axis to only intersect the curves whose bounds overlap
+            Float eps = detail::PaperConstants::geometricEpsilon();
+            DynamicArray<Box> boxes;
+            boxes.reserve(_graph.curves.count());
+            for (UInt32 i = 0; i < _graph.curves.count(); ++i)
+                boxes.append({_graph.bounds[i].min().x - eps, _graph.bounds[i].max().x + eps, i});
+
+            std::sort(boxes.begin(), boxes.end(), [](const Box & _a, const Box & _b)
+            {
+                return _a.minX < _b.minX;
+            });
+
+            for (Size i = 0; i < boxes.count(); ++i)
+            {
+                UInt32 a = boxes[i].curve;
+                bool bAFromB = _graph.loops[_graph.curveLoops[a]].bFromB;
+                for (Size j = i + 1; j < boxes.count() && boxes[j].minX <= boxes[i].maxX; ++j)
+                {
+                    UInt32 b = boxes[j].curve;
+                    if (_graph.loops[_graph.curveLoops[b]].bFromB == bAFromB ||
+                            _graph.bounds[a].min().y - eps > _graph.bounds[b].max().y ||
+                            _graph.bounds[b].min().y - eps > _graph.bounds[a].max().y)
+                        continue;
+
+                    intersectCurves(_graph, a, b);
+                }
+            }
+
+            // sort the split points along each curve and merge the ones that are too close
+            // to be told apart.
+            std::sort(_graph.splits.begin(), _graph.splits.end());
+            Float geomEps = detail::PaperConstants::geometricEpsilon();
+            Size count = 0;
+            for (Size i = 0; i < _graph.splits.count(); ++i)
+            {
+                const SplitPoint & sp = _graph.splits[i];
+                const SplitPoint * prev = count ? &_graph.splits[count - 1] : nullptr;
+                if (prev && prev->curve == sp.curve &&
+                        (sp.t - prev->t < splitTimeEpsilon() ||
+                         crunch::distance(_graph.curves[sp.curve].positionAt(sp.t),
+                                          _graph.curves[sp.curve].positionAt(prev->t)) <= geomEps))
+                {
+                    mergeNodes(_graph, _graph.splits[count - 1].node, sp.node);
+                }
+                else
+                {
+                    _graph.splits[count++] = sp;
+                }
+            }
+            _graph.splits.resize(count);
+        }
+
+        // moves the end of _piece (and its handle along with it) to _position.
+        static void snapEnd(Bezier & _piece, bool _bEnd, const Vec2f & _position)
+        {
+            if (_bEnd)
+                _piece = Bezier(_piece.positionOne(), _piece.handleOne(), _piece.handleTwo() + (_position - _piece.positionTwo()), _position);
+            else
+                _piece = Bezier(_position, _piece.handleOne() + (_position - _piece.positionOne()), _piece.handleTwo(), _piece.positionTwo());
+        }
+
+        // cuts the curves of all loops that touch the other operand at their split points.
+        static void buildEdges(BooleanGraph & _graph, DynamicArray<BooleanEdge> & _outEdges)
+        {
+            Float eps = detail::PaperConstants::geometricEpsilon();
+            Size split = 0;
+            for (UInt32 i = 0; i < _graph.curves.count(); ++i)
+            {
+                UInt32 loop = _graph.curveLoops[i];
+                if (!_graph.loops[loop].bSplit)
+                    continue;
+
+                for (; split < _graph.splits.count() && _graph.splits[split].curve < i; ++split);
+
+                const Bezier & c = _graph.curves[i];
+                bool bLine = c.handleOne() == c.positionOne() && c.handleTwo() == c.positionTwo();
+                Float t0 = 0;
+                UInt32 from = findNode(_graph, vertexNode(_graph, i, false));
+                while (true)
+                {
+                    bool bLast = split == _graph.splits.count() || _graph.splits[split].curve != i;
+                    Float t1 = bLast ? 1 : _graph.splits[split].t;
+                    UInt32 to = findNode(_graph, bLast ? vertexNode(_graph, i, true) : _graph.splits[split].node);
+
+                    // pieces of lines stay lines without handles, so that the result can use the
+                    // polygon fast paths. Pieces of vertical and horizontal lines keep their exact x or y.
+                    Bezier piece;
+                    if (t0 == 0 && t1 == 1)
+                    {
+                        piece = c;
+                    }
+                    else if (bLine)
+                    {
+                        Vec2f a = c.positionAt(t0);
+                        Vec2f b = c.positionAt(t1);
+                        if (c.positionOne().x == c.positionTwo().x)
+                            a.x = b.x = c.positionOne().x;
+                        if (c.positionOne().y == c.positionTwo().y)
+                            a.y = b.y = c.positionOne().y;
+                        piece = Bezier(a, a, b, b);
+                    }
+                    else
+                    {
+                        piece = c.slice(t0, t1);
+                    }
+
+                    // skip the pieces that collapsed into a point
+                    if (from != to || crunch::distance(piece.positionOne(), piece.handleOne()) +
+                            crunch::distance(piece.handleOne(), piece.handleTwo()) +
+                            crunch::distance(piece.handleTwo(), piece.positionTwo()) > eps)
+                    {
+                        _outEdges.append({piece, from, to, loop});
+                    }
+
+                    if (bLast)
+                        break;
+                    t0 = t1;
+                    from = to;
+                    ++split;
+                }
+            }
+
+            // All pieces that meet at a node have to share the exact same end point, otherwise
+            // the tiny gaps between them confuse the scanline rules when computing windings of
+            // the result. A node takes its position from the vertex it is rooted at (merged nodes
+            // are rooted at their smallest index, which is a vertex if there is one) or the first
+            // piece that ends in it, and the exact x or y of vertical or horizontal lines through it.
+            DynamicArray<Vec2f> positions;
+            DynamicArray<UInt8> flags;
+            positions.resize(_graph.parents.count());
+            flags.resize(_graph.parents.count(), 0);
+            auto constrain = [&](UInt32 _node, const Bezier & _piece, bool _bEnd)
+            {
+                UInt8 & f = flags[_node];
+                if (!(f & 1))
+                {
+                    positions[_node] = _node < _graph.curves.count() ? _graph.curves[_node].positionOne() :
+                                       _bEnd ? _piece.positionTwo() : _piece.positionOne();
+                    f |= 1;
+                }
+                if (_piece.handleOne() != _piece.positionOne() || _piece.handleTwo() != _piece.positionTwo())
+                    return;
+                if (!(f & 2) && _piece.positionOne().x == _piece.positionTwo().x)
+                {
+                    positions[_node].x = _piece.positionOne().x;
+                    f |= 2;
+                }
+                if (!(f & 4) && _piece.positionOne().y == _piece.positionTwo().y)
+                {
+                    positions[_node].y = _piece.positionOne().y;
+                    f |= 4;
+                }
+            };
+
+            for (const BooleanEdge & e : _outEdges)
+            {
+                constrain(e.from, e.bezier, false);
+                constrain(e.to, e.bezier, true);
+            }
+            for (BooleanEdge & e : _outEdges)
+            {
+                snapEnd(e.bezier, false, positions[e.from]);
+                snapEnd(e.bezier, true, positions[e.to]);
+            }
+        }
+
+        static bool isInside(WindingRule _rule, Int32 _winding)
+        {
+            return _rule == WindingRule::EvenOdd ? (_winding & 1) != 0 : _winding > 0;
+        }
+
+        static bool applyOperation(BooleanOperation _op, bool _bInA, bool _bInB)
+        {
+            switch (_op)
+            {
+            case BooleanOperation::Unite:
+                return _bInA || _bInB;
+            case BooleanOperation::Intersect:
+                return _bInA && _bInB;
+            case BooleanOperation::Subtract:
+                return _bInA && !_bInB;
+            case BooleanOperation::Exclude:
+                return _bInA != _bInB;
+            }
+            return false;
+        }
+
+        static Bezier reversed(const Bezier & _c)
+        {
+            return Bezier(_c.positionTwo(), _c.handleTwo(), _c.handleOne(), _c.positionOne());
+        }
+
+        static Float loopArea(const BezierArray & _loop)
+        {
+            Float ret = 0;
+            for (const Bezier & c : _loop)
+                ret += c.area();
+            return ret;
+        }
+
+        void booleanOperation(const BezierLoopArray & _a, WindingRule _ruleA,
+                              const BezierLoopArray & _b, WindingRule _ruleB,
+                              BooleanOperation _op, BezierLoopArray & _outLoops)
+        {
+            BooleanGraph graph;
+            addOperand(graph, _a, false);
+            addOperand(graph, _b, true);
+            if (!graph.curves.count())
+                return;
+
+            intersectOperands(graph);
+
+            DynamicArray<BooleanEdge> edges;
+            buildEdges(graph, edges);
+
+            // Each edge (and each loop that doesn't touch the other operand) is classified
+            // by sampling both operands on its left and right side. It is part of the
+            // result if the operation is inside on one side and outside on the other.
+            Rect total = graph.bounds[0];
+            for (const Rect & b : graph.bounds)
+                total = crunch::merge(total, b);
+            Float minOffset = detail::PaperConstants::windingEpsilon() * 4;
+            Float maxOffset = std::max(minOffset, std::max(total.width(), total.height()) * (Float)1e-5);
+
+            Size sampleCount = edges.count();
+            for (const BooleanLoop & loop : graph.loops)
+            {
+                if (!loop.bSplit)
+                    ++sampleCount;
+            }
+
+            DynamicArray<Vec2f> samples;
+            samples.reserve(sampleCount * 2);
+            auto addSamples = [&](const Bezier & _c)
+            {
+                Float length = crunch::distance(_c.positionOne(), _c.handleOne()) +
+                               crunch::distance(_c.handleOne(), _c.handleTwo()) +
+                               crunch::distance(_c.handleTwo(), _c.positionTwo());
+                Float offset = std::max(minOffset, std::min(maxOffset, length * (Float)0.25));
+                Vec2f p = _c.positionAt(0.5);
+                Vec2f n = _c.normalAt(0.5) * offset;
+                samples.append(p + n);
+                samples.append(p - n);
+            };
+
+            for (const BooleanEdge & e : edges)
+                addSamples(e.bezier);
+            for (const BooleanLoop & loop : graph.loops)
+            {
+                if (!loop.bSplit)
+                    addSamples(graph.curves[loop.first]);
+            }
+
+            MonoCurveLoopArray monoA, monoB;
+            monoCurves(_a, monoA);
+            monoCurves(_b, monoB);
+            DynamicArray<Int32> windingsA, windingsB;
+            windingsA.resize(samples.count());
+            windingsB.resize(samples.count());
+            windings(&samples[0], samples.count(), monoA, &windingsA[0]);
+            windings(&samples[0], samples.count(), monoB, &windingsB[0]);
+
+            // returns 0 if the edge is not part of the result, 1 if the result is on its
+            // left and -1 if it is on its right.
+            auto classify = [&](Size _sample, bool _bFromB) -> Int32
+            {
+                bool bInALeft = isInside(_ruleA, windingsA[_sample * 2]);
+                bool bInARight = isInside(_ruleA, windingsA[_sample * 2 + 1]);
+                bool bLeft = applyOperation(_op, bInALeft, isInside(_ruleB, windingsB[_sample * 2]));
+                bool bRight = applyOperation(_op, bInARight, isInside(_ruleB, windingsB[_sample * 2 + 1]));
+                // edges of b that coincide with an edge of a are only kept once, as part of a.
+                if (bLeft == bRight || (_bFromB && bInALeft != bInARight))
+                    return 0;
+                return bLeft ? 1 : -1;
+            };
+
+            Size sample = edges.count();
+            for (const BooleanLoop & loop : graph.loops)
+            {
+                if (loop.bSplit)
+                    continue;
+
+                Int32 side = classify(sample++, loop.bFromB);
+                if (!side)
+                    continue;
+
+                BezierArray out;
+                out.reserve(loop.count);
+                if (side > 0)
+                {
+                    for (UInt32 i = 0; i < loop.count; ++i)
+                        out.append(graph.curves[loop.first + i]);
+                }
+                else
+                {
+                    for (UInt32 i = loop.count; i > 0; --i)
+                        out.append(reversed(graph.curves[loop.first + i - 1]));
+                }
+                _outLoops.append(out);
+            }
+
+            // keep the edges of the result, pointing in the direction that has the result on the left
+            Size keptCount = 0;
+            for (Size i = 0; i < edges.count(); ++i)
+            {
+                Int32 side = classify(i, graph.loops[edges[i].loop].bFromB);
+                if (!side)
+                    continue;
+
+                BooleanEdge & e = edges[keptCount++];
+                e = edges[i];
+                if (side < 0)
+                {
+                    e.bezier = reversed(e.bezier);
+                    std::swap(e.from, e.to);
+                }
+            }
+            edges.resize(keptCount);
+            if (!keptCount)
+                return;
+
+            // link the edges into loops, the outgoing edges of each node are looked up
+            // in a compressed table.
+            DynamicArray<UInt32> offsets;
+            offsets.resize(graph.parents.count() + 1, 0);
+            for (const BooleanEdge & e : edges)
+                ++offsets[e.from + 1];
+            for (Size i = 1; i < offsets.count(); ++i)
+                offsets[i] += offsets[i - 1];
+
+            DynamicArray<UInt32> outgoing;
+            outgoing.resize(keptCount);
+            DynamicArray<UInt32> cursors(offsets);
+            for (UInt32 i = 0; i < keptCount; ++i)
+                outgoing[cursors[edges[i].from]++] = i;
+
+            DynamicArray<bool> visited;
+            visited.resize(keptCount, false);
+            for (UInt32 i = 0; i < keptCount; ++i)
+            {
+                if (visited[i])
+                    continue;
+
+                BezierArray out;
+                UInt32 start = edges[i].from;
+                UInt32 current = i;
+                while (true)
+                {
+                    visited[current] = true;
+                    out.append(edges[current].bezier);
+                    UInt32 node = edges[current].to;
+                    if (node == start)
+                        break;
+
+                    // loops that can't be closed (i.e. due to numerical issues) are closed
+                    // with a straight line when they are turned into a path.
+                    bool bFound = false;
+                    for (UInt32 j = offsets[node]; j < offsets[node + 1]; ++j)
+                    {
+                        if (!visited[outgoing[j]])
                         {
-                            //printf("ON CURVE WIND\n");
-                            windLeftOnCurve += 1;
-                            windRightOnCurve -= 1;
+                            current = outgoing[j];
+                            bFound = true;
+                            break;
                         }
                     }
+                    if (!bFound)
+                        break;
                 }
 
-                // Use the on-curve windings if no other intersections were found or
-                // if they canceled each other. On single paths this ensures that
-                // the overall winding is 1 if the point was on a monotonic curve.
-                if (windingLeft == 0 && windingRight == 0)
+                // drop the slivers left over by edges that almost coincide
+                if (std::abs(loopArea(out)) > detail::PaperConstants::tolerance())
+                    _outLoops.append(out);
+            }
+        }
+
+        void appendBooleanLoops(const Path & _path, const Mat3f & _toSpace, BezierLoopArray & _outLoops)
+        {
+            if (_path.curveCount())
+            {
+                Mat3f m = _toSpace * _path.absoluteTransform();
+                bool bTransformed = m != Mat3f::identity();
+
+                BezierArray loop;
+                loop.reserve(_path.curveCount() + 1);
+                for (Size i = 0; i < _path.curveCount(); ++i)
                 {
-                    //printf("USE ON CURVE WIND\n");
-                    windingLeft = windLeftOnCurve;
-                    windingRight = windRightOnCurve;
+                    Bezier c = _path.curve(i).bezier();
+                    if (bTransformed)
+                        c = Bezier(m * c.positionOne(), m * c.handleOne(), m * c.handleTwo(), m * c.positionTwo());
+                    loop.append(c);
                 }
+
+                // open paths are filled as if they were closed with a straight line
+                Vec2f last = loop.last().positionTwo();
+                Vec2f first = loop.first().positionOne();
+                if (!_path.isClosed() && last != first)
+                    loop.append(Bezier(last, last, first, first));
+
+                _outLoops.append(loop);
             }
 
-            return max(abs(windingLeft), abs(windingRight));
+            for (const Item & c : _path.children())
+                appendBooleanLoops(brick::reinterpretEntity<Path>(c), _toSpace, _outLoops);
         }
 
+        static void setLoopSegments(Path & _path, const BezierArray & _loop)
+        {
+            // a closed path needs at least two segments
+            if (_loop.count() == 1)
+            {
+                auto halves = _loop[0].subdivide(0.5);
+                BezierArray tmp;
+                tmp.append(halves.first);
+                tmp.append(halves.second);
+                setLoopSegments(_path, tmp);
+                return;
+            }
+
+            Size count = _loop.count();
+            DynamicArray<Vec2f> positions(_path.document().allocator());
+            DynamicArray<Vec2f> handlesIn(_path.document().allocator());
+            DynamicArray<Vec2f> handlesOut(_path.document().allocator());
+            positions.resize(count);
+            handlesIn.resize(count);
+            handlesOut.resize(count);
+            for (Size i = 0; i < count; ++i)
+            {
+                const Bezier & c = _loop[i];
+                const Bezier & prev = _loop[(i + count - 1) % count];
+                positions[i] = c.positionOne();
+                handlesOut[i] = c.handleOne() - c.positionOne();
+                handlesIn[i] = prev.handleTwo() - prev.positionTwo();
+            }
+
+            _path.setSegments(&positions[0], &handlesIn[0], &handlesOut[0], count);
+            _path.closePath();
+        }
+
+        template<class C>
+        static void copyComponent(const Item & _from, Item & _to)
+        {
+            Item from = _from;
+            if (auto m = from.maybe<C>())
+                _to.set<C>(*m);
+        }
+
+        Path createBooleanResult(const Path & _styleSource, const BezierLoopArray & _loops)
+        {
+            Document doc = _styleSource.document();
+            Path ret = doc.createPath();
+            for (Size i = 0; i < _loops.count(); ++i)
+            {
+                Path p = i == 0 ? ret : doc.createPath();
+                setLoopSegments(p, _loops[i]);
+                if (i)
+                    ret.addChild(p);
+            }
+
+            copyComponent<paper::comps::Fill>(_styleSource, ret);
+            copyComponent<paper::comps::Stroke>(_styleSource, ret);
+            copyComponent<paper::comps::StrokeWidth>(_styleSource, ret);
+            copyComponent<paper::comps::MiterLimit>(_styleSource, ret);
+            copyComponent<paper::comps::StrokeJoin>(_styleSource, ret);
+            copyComponent<paper::comps::StrokeCap>(_styleSource, ret);
+            copyComponent<paper::comps::DashArray>(_styleSource, ret);
+            copyComponent<paper::comps::DashOffset>(_styleSource, ret);
+            copyComponent<paper::comps::ScalingStrokeFlag>(_styleSource, ret);
+            // the loops of the result never overlap, their orientation is only needed for holes
+            ret.setWindingRule(WindingRule::EvenOdd);
+            return ret;
+        }
+
+        static Rect handleBounds(const BezierLoopArray & _loops)
+        {
+            Vec2f min(std::numeric_limits<Float>::infinity());
+            Vec2f max(-std::numeric_limits<Float>::infinity());
+            for (const BezierArray & loop : _loops)
+            {
+                for (const Bezier & c : loop)
+                {
+                    min = crunch::min(min, crunch::min(crunch::min(c.positionOne(), c.handleOne()), crunch::min(c.handleTwo(), c.positionTwo())));
+                    max = crunch::max(max, crunch::max(crunch::max(c.positionOne(), c.handleOne()), crunch::max(c.handleTwo(), c.positionTwo())));
+                }
+            }
+            return Rect(min, max);
+        }
+
+        BooleanOperand booleanOperand(const Path & _path)
+        {
+            BooleanOperand ret;
+            appendBooleanLoops(_path, Mat3f::identity(), ret.loops);
+            ret.windingRule = _path.windingRule();
+            ret.bounds = handleBounds(ret.loops);
+            return ret;
+        }
+
+        static void uniteOperands(const BooleanOperand & _a, const BooleanOperand & _b, BooleanOperand & _out)
+        {
+            _out.windingRule = WindingRule::EvenOdd;
+            _out.bounds = crunch::merge(_a.bounds, _b.bounds);
+
+            // the union of operands that don't overlap holds the loops of both. The result
+            // uses the even odd rule, so that only works for operands that use it too or
+            // consist of a single loop.
+            if (!_a.bounds.overlaps(_b.bounds) &&
+                    (_a.windingRule == WindingRule::EvenOdd || _a.loops.count() == 1) &&
+                    (_b.windingRule == WindingRule::EvenOdd || _b.loops.count() == 1))
+            {
+                _out.loops.reserve(_a.loops.count() + _b.loops.count());
+                for (const BezierArray & loop : _a.loops)
+                    _out.loops.append(loop);
+                for (const BezierArray & loop : _b.loops)
+                    _out.loops.append(loop);
+                return;
+            }
+
+            booleanOperation(_a.loops, _a.windingRule, _b.loops, _b.windingRule, BooleanOperation::Unite, _out.loops);
+        }
+
+        // interleaves the lower 16 bits of _v with zeros
+        static UInt32 spreadBits(UInt32 _v)
+        {
+            _v &= 0xffff;
+            _v = (_v | (_v << 8)) & 0x00ff00ff;
+            _v = (_v | (_v << 4)) & 0x0f0f0f0f;
+            _v = (_v | (_v << 2)) & 0x33333333;
+            _v = (_v | (_v << 1)) & 0x55555555;
+            return _v;
+        }
+
+        void uniteAll(BooleanOperandArray & _operands, ThreadPool & _pool, BezierLoopArray & _outLoops)
+        {
+            if (!_operands.count())
+                return;
+
+            // a single operand isn't united with anything, but overlapping loops still need to be merged
+            if (_operands.count() == 1)
+            {
+                booleanOperation(_operands[0].loops, _operands[0].windingRule, BezierLoopArray(),
+                                 WindingRule::EvenOdd, BooleanOperation::Unite, _outLoops);
+                return;
+            }
+
+            Rect total = _operands[0].bounds;
+            for (const BooleanOperand & op : _operands)
+                total = crunch::merge(total, op.bounds);
+            Vec2f scale(65535.0f / std::max(total.width(), detail::PaperConstants::tolerance()),
+                        65535.0f / std::max(total.height(), detail::PaperConstants::tolerance()));
+
+            struct Key
+            {
+                UInt32 code;
+                UInt32 index;
+            };
+
+            DynamicArray<Key> keys;
+            keys.resize(_operands.count());
+            for (Size i = 0; i < _operands.count(); ++i)
+            {
+                Vec2f c = (_operands[i].bounds.center() - total.min()) * scale;
+                keys[i] = {spreadBits((UInt32)c.x) | (spreadBits((UInt32)c.y) << 1), (UInt32)i};
+            }
+            std::sort(keys.begin(), keys.end(), [](const Key & _a, const Key & _b)
+            {
+                return _a.code < _b.code;
+            });
+
+            BooleanOperandArray level;
+            level.resize(_operands.count());
+            for (Size i = 0; i < keys.count(); ++i)
+                std::swap(level[i], _operands[keys[i].index]);
+
+            // every level unites neighbouring pairs, so each curve takes part in log(n) unions
+            BooleanOperandArray next;
+            while (level.count() > 1)
+            {
+                Size pairCount = level.count() / 2;
+                next.clear();
+                next.resize(pairCount + level.count() % 2);
+                _pool.parallelFor(pairCount, [&](Size _index, Size _worker)
+                {
+                    uniteOperands(level[_index * 2], level[_index * 2 + 1], next[_index]);
+                });
+                if (level.count() % 2)
+                    std::swap(next.last(), level.last());
+                std::swap(level, next);
+            }
+
+            std::swap(_outLoops, level[0].loops);
+        }
     }
 }
@@ -9,6 +9,8 @@ namespace paper
 
     namespace detail
     {
+        class ThreadPool;
+
         struct STICK_LOCAL MonoCurve
         {
             Bezier bezier;
@@ -17,12 +19,31 @@ namespace paper
 
         using MonoCurveArray = stick::DynamicArray<MonoCurve>;
 
+        using MonoCurveIndexArray = stick::DynamicArray<stick::UInt32>;
+
         struct STICK_LOCAL MonoCurveLoop
         {
             Mat3f inverseTransform;
             bool bTransformed;
+            //the absolute transform version of the path the loop was built from
+            stick::UInt64 transformVersion;
             MonoCurveArray monoCurves;
             MonoCurve last;
+            //the y range of all mono curves, points outside of it have no crossings with the loop.
+            Float minY;
+            Float maxY;
+            //the y range of the loop is split into equally high bands, each holding the
+            //indices of the mono curves that overlap it in ascending order. Band i uses
+            //bandCurves[bandOffsets[i]] to bandCurves[bandOffsets[i + 1]]. Small loops
+            //don't have bands (bandOffsets is empty).
+            Float bandScale;
+            MonoCurveIndexArray bandOffsets;
+            MonoCurveIndexArray bandCurves;
+            //true if all mono curves are straight lines. In that case inverseSlopes
+            //holds dx / dy of each of them, so that the crossings with a horizontal
+            //line can be computed without any root solving.
+            bool bPolygon;
+            stick::DynamicArray<Float> inverseSlopes;
         };
 
         using MonoCurveLoopArray = stick::DynamicArray<MonoCurveLoop>;
@@ -35,6 +56,54 @@ namespace paper
         STICK_LOCAL const MonoCurveLoopArray & monoCurves(Path & _path);
 
         STICK_LOCAL stick::Int32 winding(const Vec2f & _point, const MonoCurveLoopArray & _loops, bool _bHorizontal);
+
+        //same as calling winding(_points[i], _loops, false) for each point.
+        STICK_LOCAL void windings(const Vec2f * _points, stick::Size _count, const MonoCurveLoopArray & _loops, stick::Int32 * _outWindings);
+
+        enum class BooleanOperation
+        {
+            Unite,
+            Intersect,
+            Subtract,
+            Exclude
+        };
+
+        using BezierArray = stick::DynamicArray<Bezier>;
+
+        //a closed loop of curves, each curve starts where the previous one ends.
+        using BezierLoopArray = stick::DynamicArray<BezierArray>;
+
+        //computes the outline of _op applied to the areas enclosed by _a and _b. The loops of
+        //the result are oriented so that the filled area is on the left of each curve (with
+        //respect to its normal). Self intersections within _a or _b are not resolved.
+        STICK_LOCAL void booleanOperation(const BezierLoopArray & _a, WindingRule _ruleA,
+                                          const BezierLoopArray & _b, WindingRule _ruleB,
+                                          BooleanOperation _op, BezierLoopArray & _outLoops);
+
+        //appends the loops of _path and its children, mapped to the space of _toSpace * absoluteTransform().
+        //Open paths are closed with a straight line.
+        STICK_LOCAL void appendBooleanLoops(const Path & _path, const Mat3f & _toSpace, BezierLoopArray & _outLoops);
+
+        //creates a path (with one child per additional loop) from the result of a boolean
+        //operation. It has the style of _styleSource and is added to its document.
+        STICK_LOCAL Path createBooleanResult(const Path & _styleSource, const BezierLoopArray & _loops);
+
+        struct STICK_LOCAL BooleanOperand
+        {
+            BezierLoopArray loops;
+            WindingRule windingRule;
+            //the bounds of all handles of the loops
+            Rect bounds;
+        };
+
+        using BooleanOperandArray = stick::DynamicArray<BooleanOperand>;
+
+        STICK_LOCAL BooleanOperand booleanOperand(const Path & _path);
+
+        //unites all _operands in a balanced tree. The operands are sorted along a z-order curve
+        //first, so that the ones that are united early on are close to each other. The
+        //independent unions of each level of the tree run in parallel on _pool.
+        STICK_LOCAL void uniteAll(BooleanOperandArray & _operands, ThreadPool & _pool, BezierLoopArray & _outLoops);
     }
 }
 
@@ -140,6 +140,96 @@ namespace paper
             InternalIter m_begin;
             InternalIter m_end;
         };
+
+        //view over an index range that constructs lightweight proxy objects
+        //(i.e. Segment) from an owner and an index on dereference.
+        template<class Owner, class TO>
+        class ProxyView
+        {
+        public:
+
+            using ValueType = TO;
+
+            struct Iter
+            {
+                Iter()
+                {
+
+                }
+
+                Iter(const Owner & _owner, stick::Size _index) :
+                    m_owner(_owner),
+                    m_index(_index)
+                {
+
+                }
+
+                bool operator == (const Iter & _other) const
+                {
+                    return m_index == _other.m_index;
+                }
+
+                bool operator != (const Iter & _other) const
+                {
+                    return m_index != _other.m_index;
+                }
+
+                ValueType operator* () const
+                {
+                    return ValueType(m_owner, m_index);
+                }
+
+                Iter & operator++()
+                {
+                    m_index++;
+                    return *this;
+                }
+
+                Iter operator++(int)
+                {
+                    Iter ret(*this);
+                    ++(*this);
+                    return ret;
+                }
+
+                Owner m_owner;
+                stick::Size m_index;
+            };
+
+
+            ProxyView()
+            {
+            }
+
+            ProxyView(const Owner & _owner, stick::Size _begin, stick::Size _end) :
+                m_owner(_owner),
+                m_begin(_begin),
+                m_end(_end)
+            {
+
+            }
+
+            Iter begin() const
+            {
+                return Iter(m_owner, m_begin);
+            }
+
+            Iter end() const
+            {
+                return Iter(m_owner, m_end);
+            }
+
+            stick::Size count() const
+            {
+                return m_end - m_begin;
+            }
+
+        private:
+
+            Owner m_owner;
+            stick::Size m_begin;
+            stick::Size m_end;
+        };
     }
 }
 
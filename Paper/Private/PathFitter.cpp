@@ -24,7 +24,7 @@ namespace paper
             // Copy over points from path and filter out adjacent duplicates.
             for (stick::Size i = 0; i < segs.count(); ++i)
             {
-                point = segs[i]->position();
+                point = segs.positions[i];
                 if (i < 1 || prev != point)
                 {
                     m_positions.append(point);
@@ -92,10 +92,10 @@ namespace paper
                 // m_path.removeSegments();
                 auto & segs = m_path.segmentArray();
                 segs.clear();
-                Document doc = m_path.document();
+                segs.reserve(m_newSegments.count());
                 for (i = 0; i < m_newSegments.count(); ++i)
                 {
-                    segs.append(stick::makeUnique<Segment>(doc.allocator(), m_path, m_newSegments[i].position, m_newSegments[i].handleIn, m_newSegments[i].handleOut, segs.count()));
+                    segs.append(m_newSegments[i].position, m_newSegments[i].handleIn, m_newSegments[i].handleOut);
                 }
 
                 m_path.rebuildCurves();
@@ -27,11 +27,11 @@ namespace paper
         void PathFlattener::flatten(const Path & _path, PositionArray & _outPositions, JoinArray * _outJoins,
                                     Float _angleTolerance, Float _minDistance, stick::Size _maxRecursionDepth)
         {
-            auto & curves = _path.get<comps::Curves>();
-            auto it = curves.begin();
-            for (; it != curves.end(); ++it)
+            stick::Size curveCount = _path.curveCount();
+            for (stick::Size i = 0; i < curveCount; ++i)
             {
-                flattenCurve((*it)->bezier(), (*it)->bezier(), _outPositions, _outJoins, _angleTolerance, _minDistance, 0, _maxRecursionDepth, _path.isClosed(), it == curves.end() - 1);
+                Bezier bez = Curve(_path, i).bezier();
+                flattenCurve(bez, bez, _outPositions, _outJoins, _angleTolerance, _minDistance, 0, _maxRecursionDepth, _path.isClosed(), i == curveCount - 1);
             }
         }
 
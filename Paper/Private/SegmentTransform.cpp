@@ -0,0 +1,89 @@
+#include <Paper/Private/SegmentTransform.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PAPER_SEGMENT_TRANSFORM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace paper
+{
+    namespace detail
+    {
+        //the kernels treat an array of Vec2f as interleaved x, y floats
+        static_assert(sizeof(Vec2f) == sizeof(stick::Float32) * 2, "Vec2f needs to be two tightly packed floats");
+        static_assert(sizeof(Float) == sizeof(stick::Float32), "the segment kernels only support 32 bit floats");
+
+        static void transformAffine(const Mat3f & _transform, Vec2f * _data, stick::Size _count, bool _bTranslate)
+        {
+            Float a = _transform[0].x;
+            Float b = _transform[0].y;
+            Float c = _transform[1].x;
+            Float d = _transform[1].y;
+            Float tx = _bTranslate ? _transform[2].x : 0;
+            Float ty = _bTranslate ? _transform[2].y : 0;
+
+            stick::Size i = 0;
+#ifdef PAPER_SEGMENT_TRANSFORM_SSE
+            //two points per register, four per iteration
+            Float * f = reinterpret_cast<Float *>(_data);
+            __m128 col0 = _mm_setr_ps(a, b, a, b);
+            __m128 col1 = _mm_setr_ps(c, d, c, d);
+            __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+            for (; i + 4 <= _count; i += 4)
+            {
+                Float * p = f + i * 2;
+                __m128 p01 = _mm_loadu_ps(p);
+                __m128 p23 = _mm_loadu_ps(p + 4);
+                __m128 x01 = _mm_shuffle_ps(p01, p01, _MM_SHUFFLE(2, 2, 0, 0));
+                __m128 y01 = _mm_shuffle_ps(p01, p01, _MM_SHUFFLE(3, 3, 1, 1));
+                __m128 x23 = _mm_shuffle_ps(p23, p23, _MM_SHUFFLE(2, 2, 0, 0));
+                __m128 y23 = _mm_shuffle_ps(p23, p23, _MM_SHUFFLE(3, 3, 1, 1));
+                _mm_storeu_ps(p, _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, x01), _mm_mul_ps(col1, y01)), trans));
+                _mm_storeu_ps(p + 4, _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, x23), _mm_mul_ps(col1, y23)), trans));
+            }
+#else
+            for (; i + 4 <= _count; i += 4)
+            {
+                Vec2f * p = _data + i;
+                Float x0 = p[0].x, y0 = p[0].y, x1 = p[1].x, y1 = p[1].y;
+                Float x2 = p[2].x, y2 = p[2].y, x3 = p[3].x, y3 = p[3].y;
+                p[0] = Vec2f(a * x0 + c * y0 + tx, b * x0 + d * y0 + ty);
+                p[1] = Vec2f(a * x1 + c * y1 + tx, b * x1 + d * y1 + ty);
+                p[2] = Vec2f(a * x2 + c * y2 + tx, b * x2 + d * y2 + ty);
+                p[3] = Vec2f(a * x3 + c * y3 + tx, b * x3 + d * y3 + ty);
+            }
+#endif
+            for (; i < _count; ++i)
+            {
+                Float x = _data[i].x;
+                Float y = _data[i].y;
+                _data[i] = Vec2f(a * x + c * y + tx, b * x + d * y + ty);
+            }
+        }
+
+        void transformPoints(const Mat3f & _transform, Vec2f * _points, stick::Size _count)
+        {
+            transformAffine(_transform, _points, _count, true);
+        }
+
+        void transformDirections(const Mat3f & _transform, Vec2f * _directions, stick::Size _count)
+        {
+            //translations (i.e. Item::translate) leave directions untouched
+            if (_transform[0].x == 1 && _transform[0].y == 0 && _transform[1].x == 0 && _transform[1].y == 1)
+                return;
+
+            transformAffine(_transform, _directions, _count, false);
+        }
+
+        void transformSegments(const Mat3f & _transform, SegmentArray & _segments)
+        {
+            stick::Size count = _segments.count();
+            if (!count)
+                return;
+
+            transformPoints(_transform, &_segments.positions[0], count);
+            transformDirections(_transform, &_segments.handlesIn[0], count);
+            transformDirections(_transform, &_segments.handlesOut[0], count);
+        }
+    }
+}
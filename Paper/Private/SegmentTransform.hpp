@@ -0,0 +1,22 @@
+#ifndef PAPER_PRIVATE_SEGMENTTRANSFORM_HPP
+#define PAPER_PRIVATE_SEGMENTTRANSFORM_HPP
+
+#include <Paper/BasicTypes.hpp>
+
+namespace paper
+{
+    namespace detail
+    {
+        //kernels to transform contiguous segment data by the affine part of a matrix. They
+        //work on several points at a time (using SSE if available).
+        STICK_LOCAL void transformPoints(const Mat3f & _transform, Vec2f * _points, stick::Size _count);
+
+        //like transformPoints, but ignores the translation (i.e. for handles)
+        STICK_LOCAL void transformDirections(const Mat3f & _transform, Vec2f * _directions, stick::Size _count);
+
+        //transforms the positions and handles of all segments in _segments
+        STICK_LOCAL void transformSegments(const Mat3f & _transform, SegmentArray & _segments);
+    }
+}
+
+#endif //PAPER_PRIVATE_SEGMENTTRANSFORM_HPP
@@ -17,79 +17,79 @@ namespace paper
         Shape::Shape(const Path & _path) :
             m_type(ShapeType::None)
         {
-            const auto & curves = _path.curveArray();
+            stick::Size curveCount = _path.curveCount();
             const auto & segments = _path.segmentArray();
-            if (curves.count() == 4 &&
-                    curves[0]->isArc() &&
-                    curves[1]->isArc() &&
-                    curves[2]->isArc() &&
-                    curves[3]->isArc())
+            if (curveCount == 4 &&
+                    _path.curve(0).isArc() &&
+                    _path.curve(1).isArc() &&
+                    _path.curve(2).isArc() &&
+                    _path.curve(3).isArc())
             {
-                if (crunch::isClose(crunch::length(segments[0]->position() - segments[2]->position()) -
-                                    crunch::length(segments[1]->position() - segments[3]->position()), (Float)0, PaperConstants::epsilon()))
+                if (crunch::isClose(crunch::length(segments.positions[0] - segments.positions[2]) -
+                                    crunch::length(segments.positions[1] - segments.positions[3]), (Float)0, PaperConstants::epsilon()))
                 {
                     m_type = ShapeType::Circle;
                     m_data.circle.position = _path.localBounds().center();
-                    m_data.circle.radius = crunch::distance(segments[0]->position(), segments[2]->position()) * 0.5;
+                    m_data.circle.radius = crunch::distance(segments.positions[0], segments.positions[2]) * 0.5;
                 }
                 else
                 {
-                    if (crunch::isClose(crunch::distance(segments[0]->position(), segments[2]->position()), (Float)0, PaperConstants::epsilon()))
+                    if (crunch::isClose(crunch::distance(segments.positions[0], segments.positions[2]), (Float)0, PaperConstants::epsilon()))
                     {
                         m_type = ShapeType::Circle;
                         m_data.circle.position = _path.localBounds().center();
-                        m_data.circle.radius = crunch::distance(segments[0]->position(), segments[2]->position()) * 0.5;
+                        m_data.circle.radius = crunch::distance(segments.positions[0], segments.positions[2]) * 0.5;
                     }
                     else
                     {
                         m_type = ShapeType::Ellipse;
                         m_data.ellipse.position = _path.localBounds().center();
-                        m_data.ellipse.size = Vec2f(crunch::distance(segments[0]->position(), segments[2]->position()),
-                                                    crunch::distance(segments[1]->position(), segments[3]->position()));
+                        m_data.ellipse.size = Vec2f(crunch::distance(segments.positions[0], segments.positions[2]),
+                                                    crunch::distance(segments.positions[1], segments.positions[3]));
                     }
                 }
             }
             else if (_path.isPolygon() &&
-                     curves.count() == 4 &&
-                     curves[0]->isCollinear(*curves[2]) &&
-                     curves[1]->isCollinear(*curves[3]) &&
-                     curves[1]->isOrthogonal(*curves[0]))
+                     curveCount == 4 &&
+                     _path.curve(0).isCollinear(_path.curve(2)) &&
+                     _path.curve(1).isCollinear(_path.curve(3)) &&
+                     _path.curve(1).isOrthogonal(_path.curve(0)))
             {
                 m_type = ShapeType::Rectangle;
                 m_data.rectangle.position = _path.localBounds().center();
 
-                Float w = crunch::distance(segments[0]->position(),
-                                           segments[1]->position());
-                Float h = crunch::distance(segments[1]->position(),
-                                           segments[2]->position());
-                if (!crunch::isClose(segments[0]->position().y, segments[1]->position().y))
+                Float w = crunch::distance(segments.positions[0],
+                                           segments.positions[1]);
+                Float h = crunch::distance(segments.positions[1],
+                                           segments.positions[2]);
+                if (!crunch::isClose(segments.positions[0].y, segments.positions[1].y))
                 {
                     std::swap(w, h);
                 }
                 m_data.rectangle.size = Vec2f(w, h);
                 m_data.rectangle.cornerRadius = Vec2f(0);
             }
-            else if (curves.count() == 8 &&
-                     curves[1]->isArc() &&
-                     curves[3]->isArc() &&
-                     curves[5]->isArc() &&
-                     curves[7]->isArc() &&
-                     curves[0]->isCollinear(*curves[4]) &&
-                     curves[2]->isCollinear(*curves[6]))
+            else if (curveCount == 8 &&
+                     _path.curve(1).isArc() &&
+                     _path.curve(3).isArc() &&
+                     _path.curve(5).isArc() &&
+                     _path.curve(7).isArc() &&
+                     _path.curve(0).isCollinear(_path.curve(4)) &&
+                     _path.curve(2).isCollinear(_path.curve(6)))
             {
 
                 //rounded rect
                 m_type = ShapeType::Rectangle;
 
                 m_data.rectangle.position = _path.localBounds().center();
-                m_data.rectangle.size = Vec2f(crunch::distance(segments[7]->position(),
-                                              segments[2]->position()),
-                                              crunch::distance(segments[0]->position(),
-                                                      segments[5]->position()));
-                m_data.rectangle.cornerRadius = (m_data.rectangle.size - Vec2f(crunch::distance(segments[0]->position(),
-                                                 segments[1]->position()),
-                                                 crunch::distance(segments[2]->position(),
-                                                         segments[3]->position()))) * 0.5;
+                m_data.rectangle.size = Vec2f(crunch::distance(segments.positions[7],
+                                              segments.positions[2]),
+                                              crunch::distance(segments.positions[0],
+                                                      segments.positions[5]));
+                m_data.rectangle.cornerRadius = (m_data.rectangle.size - Vec2f(crunch::distance(segments.positions[0],
+                                                 segments.positions[1]),
+                                                 crunch::distance(segments.positions[2],
+                                                         segments.positions[3]))) * 0.5;
 
             }
 
@@ -0,0 +1,489 @@
+#include <Paper/Private/SpatialIndex.hpp>
+#include <Paper/Document.hpp>
+
+namespace paper
+{
+    namespace detail
+    {
+        using namespace stick;
+
+        static bool hasIndexedType(const Item & _item)
+        {
+            EntityType t = _item.itemType();
+            return t == EntityType::Path || t == EntityType::PlacedSymbol;
+        }
+
+        static SpatialIndex * existingIndex(const Item & _item)
+        {
+            if (!_item.hasComponent<paper::comps::Doc>())
+                return nullptr;
+
+            Document doc = _item.get<paper::comps::Doc>();
+            if (!doc.isValid())
+                return nullptr;
+
+            auto maybe = doc.maybe<comps::SpatialIndexHolder>();
+            return maybe ? &(*maybe) : nullptr;
+        }
+
+        static void markSubtreeDirty(SpatialIndex & _index, const Item & _item)
+        {
+            if (hasIndexedType(_item))
+                _index.markDirty(_item);
+
+            for (const Item & child : _item.children())
+                markSubtreeDirty(_index, child);
+        }
+
+        // Only items that are attached to the document and that are not part of a
+        // compound path end up in the tree. Children of compound paths are accounted
+        // for by the bounds of their parent path.
+        static bool isIndexable(const Item & _item, const Document & _doc)
+        {
+            if (!hasIndexedType(_item))
+                return false;
+
+            if (_item.itemType() == EntityType::Path)
+            {
+                Path p = brick::reinterpretEntity<Path>(_item);
+                if (!p.segmentArray().count() && !p.children().count())
+                    return false;
+            }
+
+            Item p = _item.parent();
+            if (p.isValid() && p.itemType() == EntityType::Path)
+                return false;
+
+            while (p.isValid())
+            {
+                if (p == _doc)
+                    return true;
+                p = p.parent();
+            }
+            return false;
+        }
+
+        static Rect fattenedBounds(const Rect & _bounds)
+        {
+            Float margin = std::max(_bounds.width(), _bounds.height()) * 0.1f + PaperConstants::geometricEpsilon();
+            return Rect(_bounds.min() - Vec2f(margin), _bounds.max() + Vec2f(margin));
+        }
+
+        static Float perimeter(const Rect & _rect)
+        {
+            return 2.0f * (_rect.width() + _rect.height());
+        }
+
+        SpatialIndex::SpatialIndex() :
+            m_root(-1),
+            m_freeList(-1),
+            m_leafCount(0)
+        {
+        }
+
+        SpatialIndex & SpatialIndex::indexFor(const Document & _doc)
+        {
+            if (!_doc.hasComponent<comps::SpatialIndexHolder>())
+            {
+                Document doc = _doc;
+                doc.set<comps::SpatialIndexHolder>(SpatialIndex());
+                markSubtreeDirty(doc.get<comps::SpatialIndexHolder>(), doc);
+            }
+
+            SpatialIndex & ret = const_cast<Document &>(_doc).get<comps::SpatialIndexHolder>();
+            ret.update(_doc);
+            return ret;
+        }
+
+        void SpatialIndex::itemChanged(const Item & _item)
+        {
+            if (!hasIndexedType(_item))
+                return;
+
+            if (SpatialIndex * index = existingIndex(_item))
+                index->markDirty(_item);
+        }
+
+        void SpatialIndex::subtreeChanged(const Item & _item)
+        {
+            if (SpatialIndex * index = existingIndex(_item))
+                index->queueSubtree(_item);
+        }
+
+        void SpatialIndex::itemRemoved(const Item & _item)
+        {
+            if (!hasIndexedType(_item) || !_item.hasComponent<comps::SpatialIndexNode>())
+                return;
+
+            if (SpatialIndex * index = existingIndex(_item))
+                index->removeItem(_item);
+        }
+
+        void SpatialIndex::markDirty(const Item & _item)
+        {
+            Item item = _item;
+            auto maybe = item.maybe<comps::SpatialIndexNode>();
+            if (!maybe)
+            {
+                item.set<comps::SpatialIndexNode>((comps::SpatialIndexNodeData) { -1, true, false});
+                m_queue.append(item);
+            }
+            else if (!(*maybe).bQueued)
+            {
+                (*maybe).bQueued = true;
+                m_queue.append(item);
+            }
+        }
+
+        void SpatialIndex::queueSubtree(const Item & _item)
+        {
+            Item item = _item;
+            auto maybe = item.maybe<comps::SpatialIndexNode>();
+            if (!maybe)
+            {
+                item.set<comps::SpatialIndexNode>((comps::SpatialIndexNodeData) { -1, false, true});
+                m_subtreeQueue.append(item);
+            }
+            else if (!(*maybe).bSubtreeQueued)
+            {
+                (*maybe).bSubtreeQueued = true;
+                m_subtreeQueue.append(item);
+            }
+        }
+
+        void SpatialIndex::removeItem(const Item & _item)
+        {
+            Item item = _item;
+            auto & data = item.get<comps::SpatialIndexNode>();
+            if (data.node != -1)
+            {
+                removeLeaf(data.node);
+                freeNode(data.node);
+                data.node = -1;
+            }
+        }
+
+        void SpatialIndex::update(const Document & _doc)
+        {
+            for (Item & item : m_subtreeQueue)
+            {
+                if (!item.isValid() || !item.hasComponent<comps::SpatialIndexNode>())
+                    continue;
+
+                item.get<comps::SpatialIndexNode>().bSubtreeQueued = false;
+                markSubtreeDirty(*this, item);
+            }
+            m_subtreeQueue.clear();
+
+            for (Item & item : m_queue)
+            {
+                // the item might have been destroyed while it was queued
+                if (!item.isValid() || !item.hasComponent<comps::SpatialIndexNode>())
+                    continue;
+
+                item.get<comps::SpatialIndexNode>().bQueued = false;
+
+                if (!isIndexable(item, _doc))
+                {
+                    removeItem(item);
+                    continue;
+                }
+
+                Rect bounds = item.strokeBounds();
+                auto & data = item.get<comps::SpatialIndexNode>();
+                if (data.node != -1)
+                {
+                    // the fat bounds still enclose the item, no need to touch the tree
+                    Node & n = m_nodes[data.node];
+                    if (rectContains(n.fatBounds, bounds))
+                    {
+                        n.bounds = bounds;
+                        continue;
+                    }
+                    removeLeaf(data.node);
+                }
+                else
+                {
+                    data.node = allocateNode();
+                }
+
+                Node & n = m_nodes[data.node];
+                n.bounds = bounds;
+                n.fatBounds = fattenedBounds(bounds);
+                n.item = item;
+                insertLeaf(data.node);
+            }
+            m_queue.clear();
+        }
+
+        Size SpatialIndex::itemCount() const
+        {
+            return m_leafCount;
+        }
+
+        Int32 SpatialIndex::allocateNode()
+        {
+            Int32 ret;
+            if (m_freeList != -1)
+            {
+                ret = m_freeList;
+                m_freeList = m_nodes[ret].parent;
+            }
+            else
+            {
+                ret = (Int32)m_nodes.count();
+                m_nodes.append(Node());
+            }
+
+            Node & n = m_nodes[ret];
+            n.item = Item();
+            n.parent = -1;
+            n.children[0] = -1;
+            n.children[1] = -1;
+            n.height = 0;
+            return ret;
+        }
+
+        void SpatialIndex::freeNode(Int32 _node)
+        {
+            Node & n = m_nodes[_node];
+            n.item = Item();
+            n.height = -1;
+            n.parent = m_freeList;
+            m_freeList = _node;
+        }
+
+        void SpatialIndex::insertLeaf(Int32 _leaf)
+        {
+            ++m_leafCount;
+
+            if (m_root == -1)
+            {
+                m_root = _leaf;
+                m_nodes[_leaf].parent = -1;
+                return;
+            }
+
+            // find the best sibling by descending along the cheapest perimeter increase
+            Rect leafBounds = m_nodes[_leaf].fatBounds;
+            Int32 idx = m_root;
+            while (!m_nodes[idx].isLeaf())
+            {
+                const Node & n = m_nodes[idx];
+                Float combined = perimeter(crunch::merge(n.fatBounds, leafBounds));
+                Float cost = 2.0f * combined;
+                Float inheritance = 2.0f * (combined - perimeter(n.fatBounds));
+
+                Float childCosts[2];
+                for (Int32 i = 0; i < 2; ++i)
+                {
+                    const Node & c = m_nodes[n.children[i]];
+                    Float merged = perimeter(crunch::merge(c.fatBounds, leafBounds));
+                    childCosts[i] = c.isLeaf() ? merged + inheritance : merged - perimeter(c.fatBounds) + inheritance;
+                }
+
+                if (cost < childCosts[0] && cost < childCosts[1])
+                    break;
+
+                idx = childCosts[0] < childCosts[1] ? n.children[0] : n.children[1];
+            }
+
+            Int32 sibling = idx;
+            Int32 oldParent = m_nodes[sibling].parent;
+            Int32 newParent = allocateNode();
+
+            Node & np = m_nodes[newParent];
+            np.parent = oldParent;
+            np.fatBounds = crunch::merge(leafBounds, m_nodes[sibling].fatBounds);
+            np.height = m_nodes[sibling].height + 1;
+            np.children[0] = sibling;
+            np.children[1] = _leaf;
+
+            if (oldParent != -1)
+            {
+                Node & op = m_nodes[oldParent];
+                if (op.children[0] == sibling)
+                    op.children[0] = newParent;
+                else
+                    op.children[1] = newParent;
+            }
+            else
+            {
+                m_root = newParent;
+            }
+            m_nodes[sibling].parent = newParent;
+            m_nodes[_leaf].parent = newParent;
+
+            idx = newParent;
+            while (idx != -1)
+            {
+                idx = balance(idx);
+                Node & n = m_nodes[idx];
+                const Node & a = m_nodes[n.children[0]];
+                const Node & b = m_nodes[n.children[1]];
+                n.height = 1 + std::max(a.height, b.height);
+                n.fatBounds = crunch::merge(a.fatBounds, b.fatBounds);
+                idx = n.parent;
+            }
+        }
+
+        void SpatialIndex::removeLeaf(Int32 _leaf)
+        {
+            --m_leafCount;
+
+            if (_leaf == m_root)
+            {
+                m_root = -1;
+                return;
+            }
+
+            Int32 parent = m_nodes[_leaf].parent;
+            Int32 grandParent = m_nodes[parent].parent;
+            Int32 sibling = m_nodes[parent].children[0] == _leaf ? m_nodes[parent].children[1] : m_nodes[parent].children[0];
+
+            if (grandParent != -1)
+            {
+                Node & gp = m_nodes[grandParent];
+                if (gp.children[0] == parent)
+                    gp.children[0] = sibling;
+                else
+                    gp.children[1] = sibling;
+                m_nodes[sibling].parent = grandParent;
+                freeNode(parent);
+
+                Int32 idx = grandParent;
+                while (idx != -1)
+                {
+                    idx = balance(idx);
+                    Node & n = m_nodes[idx];
+                    const Node & a = m_nodes[n.children[0]];
+                    const Node & b = m_nodes[n.children[1]];
+                    n.height = 1 + std::max(a.height, b.height);
+                    n.fatBounds = crunch::merge(a.fatBounds, b.fatBounds);
+                    idx = n.parent;
+                }
+            }
+            else
+            {
+                m_root = sibling;
+                m_nodes[sibling].parent = -1;
+                freeNode(parent);
+            }
+        }
+
+        // AVL style rotation, promotes the taller grand child if _node is imbalanced.
+        // Returns the index of the node that now sits at the position of _node.
+        Int32 SpatialIndex::balance(Int32 _node)
+        {
+            Node & a = m_nodes[_node];
+            if (a.isLeaf() || a.height < 2)
+                return _node;
+
+            Int32 ib = a.children[0];
+            Int32 ic = a.children[1];
+            Node & b = m_nodes[ib];
+            Node & c = m_nodes[ic];
+            Int32 diff = c.height - b.height;
+
+            // rotate c up
+            if (diff > 1)
+            {
+                Int32 i_f = c.children[0];
+                Int32 ig = c.children[1];
+                Node & f = m_nodes[i_f];
+                Node & g = m_nodes[ig];
+
+                c.children[0] = _node;
+                c.parent = a.parent;
+                a.parent = ic;
+
+                if (c.parent != -1)
+                {
+                    Node & cp = m_nodes[c.parent];
+                    if (cp.children[0] == _node)
+                        cp.children[0] = ic;
+                    else
+                        cp.children[1] = ic;
+                }
+                else
+                {
+                    m_root = ic;
+                }
+
+                if (f.height > g.height)
+                {
+                    c.children[1] = i_f;
+                    a.children[1] = ig;
+                    g.parent = _node;
+                    a.fatBounds = crunch::merge(b.fatBounds, g.fatBounds);
+                    c.fatBounds = crunch::merge(a.fatBounds, f.fatBounds);
+                    a.height = 1 + std::max(b.height, g.height);
+                    c.height = 1 + std::max(a.height, f.height);
+                }
+                else
+                {
+                    c.children[1] = ig;
+                    a.children[1] = i_f;
+                    f.parent = _node;
+                    a.fatBounds = crunch::merge(b.fatBounds, f.fatBounds);
+                    c.fatBounds = crunch::merge(a.fatBounds, g.fatBounds);
+                    a.height = 1 + std::max(b.height, f.height);
+                    c.height = 1 + std::max(a.height, g.height);
+                }
+
+                return ic;
+            }
+
+            // rotate b up
+            if (diff < -1)
+            {
+                Int32 id = b.children[0];
+                Int32 ie = b.children[1];
+                Node & d = m_nodes[id];
+                Node & e = m_nodes[ie];
+
+                b.children[0] = _node;
+                b.parent = a.parent;
+                a.parent = ib;
+
+                if (b.parent != -1)
+                {
+                    Node & bp = m_nodes[b.parent];
+                    if (bp.children[0] == _node)
+                        bp.children[0] = ib;
+                    else
+                        bp.children[1] = ib;
+                }
+                else
+                {
+                    m_root = ib;
+                }
+
+                if (d.height > e.height)
+                {
+                    b.children[1] = id;
+                    a.children[0] = ie;
+                    e.parent = _node;
+                    a.fatBounds = crunch::merge(c.fatBounds, e.fatBounds);
+                    b.fatBounds = crunch::merge(a.fatBounds, d.fatBounds);
+                    a.height = 1 + std::max(c.height, e.height);
+                    b.height = 1 + std::max(a.height, d.height);
+                }
+                else
+                {
+                    b.children[1] = ie;
+                    a.children[0] = id;
+                    d.parent = _node;
+                    a.fatBounds = crunch::merge(c.fatBounds, d.fatBounds);
+                    b.fatBounds = crunch::merge(a.fatBounds, e.fatBounds);
+                    a.height = 1 + std::max(c.height, d.height);
+                    b.height = 1 + std::max(a.height, e.height);
+                }
+
+                return ib;
+            }
+
+            return _node;
+        }
+    }
+}
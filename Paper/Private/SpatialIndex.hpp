@@ -0,0 +1,149 @@
+#ifndef PAPER_PRIVATE_SPATIALINDEX_HPP
+#define PAPER_PRIVATE_SPATIALINDEX_HPP
+
+#include <Paper/Item.hpp>
+
+namespace paper
+{
+    class Document;
+
+    namespace detail
+    {
+        //Dynamic AABB tree over the stroke bounds of all leaf items (paths that are not
+        //part of a compound path and placed symbols) of a document. Leaves store a fattened
+        //version of the item bounds so that small changes do not require a reinsertion.
+        //The index is updated lazily: bounds invalidation only queues the item, the actual
+        //tree update happens right before the next query.
+        class STICK_LOCAL SpatialIndex
+        {
+        public:
+
+            SpatialIndex();
+
+            //returns the index of _doc, building it the first time it is requested.
+            static SpatialIndex & indexFor(const Document & _doc);
+
+            //these are called from the item invalidation code and don't do anything
+            //if the document of _item has no index yet.
+            static void itemChanged(const Item & _item);
+
+            static void subtreeChanged(const Item & _item);
+
+            static void itemRemoved(const Item & _item);
+
+
+            void markDirty(const Item & _item);
+
+            //queues all leaves of _item. The subtree is only walked in update(), so that
+            //moving a group around repeatedly does not touch its children every time.
+            void queueSubtree(const Item & _item);
+
+            void removeItem(const Item & _item);
+
+            //processes all queued items
+            void update(const Document & _doc);
+
+            //calls _callback(item, tightBounds) for every indexed item whose fat bounds overlap _rect.
+            template<class F>
+            void query(const Rect & _rect, F _callback) const;
+
+            stick::Size itemCount() const;
+
+
+        private:
+
+            struct Node
+            {
+                Rect fatBounds;
+                Rect bounds;
+                Item item;
+                stick::Int32 parent;
+                stick::Int32 children[2];
+                stick::Int32 height;
+
+                bool isLeaf() const
+                {
+                    return children[0] == -1;
+                }
+            };
+
+            using NodeArray = stick::DynamicArray<Node>;
+            using IndexArray = stick::DynamicArray<stick::Int32>;
+
+            stick::Int32 allocateNode();
+
+            void freeNode(stick::Int32 _node);
+
+            void insertLeaf(stick::Int32 _leaf);
+
+            void removeLeaf(stick::Int32 _leaf);
+
+            stick::Int32 balance(stick::Int32 _node);
+
+            NodeArray m_nodes;
+            stick::Int32 m_root;
+            stick::Int32 m_freeList;
+            stick::Size m_leafCount;
+            ItemArray m_queue;
+            ItemArray m_subtreeQueue;
+            mutable IndexArray m_stack;
+        };
+
+        namespace comps
+        {
+            struct SpatialIndexNodeData
+            {
+                stick::Int32 node;
+                bool bQueued;
+                bool bSubtreeQueued;
+            };
+
+            using SpatialIndexHolder = brick::Component<ComponentName("SpatialIndexHolder"), SpatialIndex>;
+            using SpatialIndexNode = brick::Component<ComponentName("SpatialIndexNode"), SpatialIndexNodeData>;
+        }
+
+        inline bool rectsOverlap(const Rect & _a, const Rect & _b)
+        {
+            return _a.min().x <= _b.max().x && _a.max().x >= _b.min().x &&
+                   _a.min().y <= _b.max().y && _a.max().y >= _b.min().y;
+        }
+
+        inline bool rectContains(const Rect & _outer, const Rect & _inner)
+        {
+            return _inner.min().x >= _outer.min().x && _inner.max().x <= _outer.max().x &&
+                   _inner.min().y >= _outer.min().y && _inner.max().y <= _outer.max().y;
+        }
+
+        template<class F>
+        void SpatialIndex::query(const Rect & _rect, F _callback) const
+        {
+            if (m_root == -1)
+                return;
+
+            m_stack.clear();
+            m_stack.append(m_root);
+            while (m_stack.count())
+            {
+                stick::Int32 idx = m_stack.last();
+                m_stack.resize(m_stack.count() - 1);
+
+                const Node & n = m_nodes[idx];
+                if (!rectsOverlap(n.fatBounds, _rect))
+                    continue;
+
+                if (n.isLeaf())
+                {
+                    if (n.item.isValid())
+                        _callback(n.item, n.bounds);
+                }
+                else
+                {
+                    m_stack.append(n.children[0]);
+                    m_stack.append(n.children[1]);
+                }
+            }
+        }
+    }
+}
+
+#endif //PAPER_PRIVATE_SPATIALINDEX_HPP
@@ -0,0 +1,408 @@
+#include <Paper/Private/StrokeOutliner.hpp>
+#include <Paper/Private/JoinAndCap.hpp>
+
+namespace paper
+{
+    namespace detail
+    {
+        using namespace stick;
+
+        // offset curves are subdivided at most this many times to meet the tolerance
+        static const Size s_maxOffsetDepth = 8;
+
+        static Vec2f rotate90(const Vec2f & _v)
+        {
+            return Vec2f(-_v.y, _v.x);
+        }
+
+        static bool isPoint(const Bezier & _c)
+        {
+            return _c.positionOne() == _c.handleOne() && _c.handleOne() == _c.handleTwo() &&
+                   _c.handleTwo() == _c.positionTwo();
+        }
+
+        static Bezier reversed(const Bezier & _c)
+        {
+            return Bezier(_c.positionTwo(), _c.handleTwo(), _c.handleOne(), _c.positionOne());
+        }
+
+        // signed curvature, positive if the curve turns left
+        static Float curvatureAt(const Bezier & _c, Float _t)
+        {
+            Vec2f d = _c.derivativeAt(_t);
+            Float len = crunch::length(d);
+            if (len <= detail::PaperConstants::epsilon())
+                return 0;
+            return crunch::cross(d, _c.secondDerivativeAt(_t)) / (len * len * len);
+        }
+
+        static void addLine(const Vec2f & _from, const Vec2f & _to, BezierArray & _out)
+        {
+            if (_from != _to)
+                _out.append(Bezier(_from, _from, _to, _to));
+        }
+
+        // appends a circular arc around _center that starts at _from, sweeps _angle (radians,
+        // positive turns left) and ends exactly at _to.
+        static void addArc(const Vec2f & _center, const Vec2f & _from, Float _angle, const Vec2f & _to, BezierArray & _out)
+        {
+            Size count = std::max((Size)1, (Size)std::ceil(std::abs(_angle) / crunch::Constants<Float>::halfPi() - 1e-4));
+            Float step = _angle / count;
+            Float k = (Float)4.0 / (Float)3.0 * std::tan(step * 0.25);
+            Float cosa = std::cos(step);
+            Float sina = std::sin(step);
+            Vec2f u = _from - _center;
+            Vec2f p = _from;
+            for (Size i = 0; i < count; ++i)
+            {
+                Vec2f next(u.x * cosa - u.y * sina, u.x * sina + u.y * cosa);
+                Vec2f np = i + 1 == count ? _to : _center + next;
+                _out.append(Bezier(p, p + rotate90(u) * k, np - rotate90(next) * k, np));
+                u = next;
+                p = np;
+            }
+        }
+
+        StrokeOutliner::StrokeOutliner(Float _strokeWidth, StrokeJoin _join, StrokeCap _cap, Float _miterLimit,
+                                       const DashArray & _dashArray, Float _dashOffset, Float _tolerance) :
+            m_halfWidth(_strokeWidth * 0.5),
+            m_join(_join),
+            m_cap(_cap),
+            m_miterLimit(_miterLimit),
+            m_dashOffset(_dashOffset),
+            m_tolerance(_tolerance)
+        {
+            // like in SVG, dash arrays with negative values or without any length are ignored
+            // and odd ones are repeated to get an even number of values.
+            Float patternLength = 0;
+            for (Float d : _dashArray)
+            {
+                if (d < 0)
+                    return;
+                patternLength += d;
+            }
+
+            if (patternLength > 0)
+            {
+                Size count = _dashArray.count() % 2 ? _dashArray.count() * 2 : _dashArray.count();
+                m_dashArray.reserve(count);
+                for (Size i = 0; i < count; ++i)
+                    m_dashArray.append(_dashArray[i % _dashArray.count()]);
+            }
+        }
+
+        void StrokeOutliner::outline(const BezierArray & _curves, bool _bClosed, BezierLoopArray & _outLoops)
+        {
+            if (m_halfWidth <= 0)
+                return;
+
+            // curves that collapsed into a point have no direction
+            m_curves.clear();
+            m_curves.reserve(_curves.count());
+            for (const Bezier & c : _curves)
+            {
+                if (!isPoint(c))
+                    m_curves.append(c);
+            }
+
+            if (!m_curves.count())
+                return;
+
+            if (!m_dashArray.count())
+            {
+                outlineDash(m_curves, _bClosed, _outLoops);
+                return;
+            }
+
+            Float totalLength = 0;
+            m_lengths.resize(m_curves.count());
+            for (Size i = 0; i < m_curves.count(); ++i)
+            {
+                m_lengths[i] = m_curves[i].length();
+                totalLength += m_lengths[i];
+            }
+
+            // find the dash that the offset starts in
+            Float patternLength = 0;
+            for (Float d : m_dashArray)
+                patternLength += d;
+            Float phase = std::fmod(m_dashOffset, patternLength);
+            if (phase < 0)
+                phase += patternLength;
+            Size dashIndex = 0;
+            while (phase > 0 && phase >= m_dashArray[dashIndex])
+            {
+                phase -= m_dashArray[dashIndex];
+                dashIndex = (dashIndex + 1) % m_dashArray.count();
+            }
+
+            // The dashes are visited in order, so the curve that a dash starts in is tracked
+            // with a cursor rather than searched for. On closed paths a dash that starts at
+            // the beginning of the path is held back to be joined with one that reaches its end.
+            Size curve = 0;
+            Float curveStart = 0;
+            Float start = -phase;
+            m_first.clear();
+            // a dash without length at the end of an open path still gets a dot
+            while (start < totalLength || (start == totalLength && !_bClosed && m_dashArray[dashIndex] == 0))
+            {
+                Float end = start + m_dashArray[dashIndex];
+                // even entries are dashes, odd ones are gaps
+                if (dashIndex % 2 == 0 && end >= 0)
+                {
+                    Float from = std::max(start, (Float)0);
+                    Float to = std::min(end, totalLength);
+                    while (curve + 1 < m_curves.count() && curveStart + m_lengths[curve] <= from)
+                    {
+                        curveStart += m_lengths[curve];
+                        ++curve;
+                    }
+
+                    if (to <= from)
+                    {
+                        // dashes without length are dots if the caps add anything
+                        const Bezier & c = m_curves[curve];
+                        Float t = c.parameterAtOffset(from - curveStart);
+                        outlineDot(c.positionAt(t), c.tangentAt(t), _outLoops);
+                    }
+                    else
+                    {
+                        m_dash.clear();
+                        Float s = curveStart;
+                        for (Size i = curve; i < m_curves.count(); ++i)
+                        {
+                            const Bezier & c = m_curves[i];
+                            Float t0 = from > s ? c.parameterAtOffset(from - s) : 0;
+                            Float t1 = to < s + m_lengths[i] ? c.parameterAtOffset(to - s) : 1;
+                            if (t1 > t0)
+                                m_dash.append(t0 == 0 && t1 == 1 ? c : c.slice(t0, t1));
+                            s += m_lengths[i];
+                            if (to <= s)
+                                break;
+                        }
+
+                        if (m_dash.count())
+                        {
+                            if (_bClosed && start <= 0 && end >= totalLength)
+                            {
+                                outlineDash(m_curves, true, _outLoops);
+                                return;
+                            }
+                            else if (_bClosed && start <= 0)
+                            {
+                                std::swap(m_first, m_dash);
+                            }
+                            else
+                            {
+                                if (_bClosed && end >= totalLength)
+                                {
+                                    for (const Bezier & c : m_first)
+                                        m_dash.append(c);
+                                    m_first.clear();
+                                }
+                                outlineDash(m_dash, false, _outLoops);
+                            }
+                        }
+                    }
+                }
+
+                start = end;
+                dashIndex = (dashIndex + 1) % m_dashArray.count();
+            }
+
+            if (m_first.count())
+                outlineDash(m_first, false, _outLoops);
+        }
+
+        void StrokeOutliner::outlineDash(const BezierArray & _curves, bool _bClosed, BezierLoopArray & _outLoops)
+        {
+            m_reversed.clear();
+            m_reversed.reserve(_curves.count());
+            for (Size i = _curves.count(); i > 0; --i)
+                m_reversed.append(reversed(_curves[i - 1]));
+
+            // a closed stroke is the area between the offsets on both sides, which run in
+            // opposite directions. An open one goes along one side and back along the other.
+            BezierArray loop;
+            addSide(_curves, _bClosed, loop);
+            m_tmp.clear();
+            addSide(m_reversed, _bClosed, m_tmp);
+            if (_bClosed)
+            {
+                _outLoops.append(loop);
+                _outLoops.append(m_tmp);
+                return;
+            }
+
+            // the end points are copied, appending to the loop invalidates references into it
+            Vec2f from = loop.last().positionTwo();
+            addCap(_curves.last().positionTwo(), _curves.last().tangentAt(1), from, m_tmp.first().positionOne(), loop);
+            for (const Bezier & c : m_tmp)
+                loop.append(c);
+            from = loop.last().positionTwo();
+            Vec2f to = loop.first().positionOne();
+            addCap(_curves.first().positionOne(), -_curves.first().tangentAt(0), from, to, loop);
+            _outLoops.append(loop);
+        }
+
+        void StrokeOutliner::outlineDot(const Vec2f & _position, const Vec2f & _direction, BezierLoopArray & _outLoops)
+        {
+            if (m_cap == StrokeCap::Butt)
+                return;
+
+            Vec2f from = _position + rotate90(_direction) * m_halfWidth;
+            Vec2f to = _position - rotate90(_direction) * m_halfWidth;
+            BezierArray loop;
+            addCap(_position, _direction, from, to, loop);
+            addCap(_position, -_direction, to, from, loop);
+            _outLoops.append(loop);
+        }
+
+        void StrokeOutliner::addSide(const BezierArray & _curves, bool _bClosed, BezierArray & _outCurves)
+        {
+            Size first = _outCurves.count();
+            for (Size i = 0; i < _curves.count(); ++i)
+            {
+                if (i == 0)
+                {
+                    addOffsetCurve(_curves[i], nullptr, _outCurves, 0);
+                    continue;
+                }
+
+                m_offset.clear();
+                addOffsetCurve(_curves[i], nullptr, m_offset, 0);
+                Vec2f from = _outCurves.last().positionTwo();
+                addJoin(_curves[i].positionOne(), _curves[i - 1].tangentAt(1), _curves[i].tangentAt(0),
+                        from, m_offset.first().positionOne(), _outCurves);
+                for (const Bezier & c : m_offset)
+                    _outCurves.append(c);
+            }
+
+            if (_bClosed)
+            {
+                Vec2f from = _outCurves.last().positionTwo();
+                Vec2f to = _outCurves[first].positionOne();
+                addJoin(_curves.first().positionOne(), _curves.last().tangentAt(1), _curves.first().tangentAt(0),
+                        from, to, _outCurves);
+            }
+        }
+
+        void StrokeOutliner::addOffsetCurve(const Bezier & _curve, const Vec2f * _start, BezierArray & _outCurves, Size _depth)
+        {
+            // the offset of a straight curve is a translated copy
+            if (_curve.isStraight())
+            {
+                Vec2f n = rotate90(crunch::normalize(_curve.positionTwo() - _curve.positionOne())) * m_halfWidth;
+                _outCurves.append(Bezier(_start ? *_start : _curve.positionOne() + n, _curve.handleOne() + n,
+                                         _curve.handleTwo() + n, _curve.positionTwo() + n));
+                return;
+            }
+
+            // Move the end points along their normals and scale the handles by the ratio of the
+            // offset and the original radius of curvature, which is exact for circular arcs.
+            Vec2f a = _start ? *_start : _curve.positionOne() + rotate90(_curve.tangentAt(0)) * m_halfWidth;
+            Vec2f b = _curve.positionTwo() + rotate90(_curve.tangentAt(1)) * m_halfWidth;
+            Float s0 = std::max((Float)0, 1 - m_halfWidth * curvatureAt(_curve, 0));
+            Float s1 = std::max((Float)0, 1 - m_halfWidth * curvatureAt(_curve, 1));
+            Bezier approx(a, a + (_curve.handleOne() - _curve.positionOne()) * s0,
+                          b + (_curve.handleTwo() - _curve.positionTwo()) * s1, b);
+
+            if (_depth < s_maxOffsetDepth)
+            {
+                static const Float s_samples[] = {0.25, 0.5, 0.75};
+                for (Float t : s_samples)
+                {
+                    Vec2f exact = _curve.positionAt(t) + rotate90(_curve.tangentAt(t)) * m_halfWidth;
+                    if (crunch::distance(approx.positionAt(t), exact) > m_tolerance)
+                    {
+                        // the second half starts exactly where the first one ends
+                        auto halves = _curve.subdivide(0.5);
+                        addOffsetCurve(halves.first, _start, _outCurves, _depth + 1);
+                        Vec2f mid = _outCurves.last().positionTwo();
+                        addOffsetCurve(halves.second, &mid, _outCurves, _depth + 1);
+                        return;
+                    }
+                }
+            }
+
+            _outCurves.append(approx);
+        }
+
+        void StrokeOutliner::addJoin(const Vec2f & _position, const Vec2f & _dirIn, const Vec2f & _dirOut,
+                                     const Vec2f & _from, const Vec2f & _to, BezierArray & _outCurves)
+        {
+            Float cross = crunch::cross(_dirIn, _dirOut);
+            Float dot = crunch::dot(_dirIn, _dirOut);
+
+            // vertices without a visible corner are connected directly
+            if (dot > 0 && crunch::distance(_from, _to) <= m_tolerance)
+            {
+                addLine(_from, _to, _outCurves);
+                return;
+            }
+
+            // On the inner side of the corner the offsets overlap, going through the vertex
+            // keeps the area covered for the non zero rule.
+            if (cross > 0)
+            {
+                addLine(_from, _position, _outCurves);
+                addLine(_position, _to, _outCurves);
+                return;
+            }
+
+            switch (m_join)
+            {
+            case StrokeJoin::Round:
+                {
+                    // a u-turn has no corner, the arc goes around the front
+                    Vec2f u = _from - _position;
+                    Vec2f v = _to - _position;
+                    Float angle = cross == 0 ? -crunch::Constants<Float>::pi() : std::atan2(crunch::cross(u, v), crunch::dot(u, v));
+                    addArc(_position, _from, angle, _to, _outCurves);
+                    break;
+                }
+            case StrokeJoin::Miter:
+                {
+                    // same miter length as the renderers and the stroke bounds use
+                    Float miterLen;
+                    Vec2f tip = detail::joinMiter(_position, _from, _dirIn, _to, _dirOut, miterLen);
+                    if (cross != 0 && miterLen <= m_miterLimit)
+                    {
+                        addLine(_from, tip, _outCurves);
+                        addLine(tip, _to, _outCurves);
+                        break;
+                    }
+                    //else fall back to Bevel
+                }
+            default:
+            case StrokeJoin::Bevel:
+                addLine(_from, _to, _outCurves);
+                break;
+            }
+        }
+
+        void StrokeOutliner::addCap(const Vec2f & _position, const Vec2f & _direction,
+                                    const Vec2f & _from, const Vec2f & _to, BezierArray & _outCurves)
+        {
+            switch (m_cap)
+            {
+            case StrokeCap::Round:
+                addArc(_position, _from, -crunch::Constants<Float>::pi(), _to, _outCurves);
+                break;
+            case StrokeCap::Square:
+                {
+                    Vec2f a, b, c, d;
+                    detail::capSquare(_position, _direction * m_halfWidth, a, b, c, d);
+                    addLine(_from, d, _outCurves);
+                    addLine(d, c, _outCurves);
+                    addLine(c, _to, _outCurves);
+                    break;
+                }
+            default:
+            case StrokeCap::Butt:
+                addLine(_from, _to, _outCurves);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef PAPER_PRIVATE_STROKEOUTLINER_HPP
+#define PAPER_PRIVATE_STROKEOUTLINER_HPP
+
+#include <Paper/Private/BooleanOperations.hpp>
+
+namespace paper
+{
+    namespace detail
+    {
+        //computes the outline of a stroke as closed loops of curves. Curves are offset by
+        //cubic approximations (instead of being flattened), joins and caps are made of
+        //lines and circular arcs. The loops may overlap each other and are meant to be
+        //filled with the non zero winding rule.
+        class STICK_LOCAL StrokeOutliner
+        {
+        public:
+
+            StrokeOutliner(Float _strokeWidth, StrokeJoin _join, StrokeCap _cap, Float _miterLimit,
+                           const DashArray & _dashArray, Float _dashOffset, Float _tolerance);
+
+            //appends the outline of the stroke of one (sub)path to _outLoops. Each curve
+            //of _curves has to start where the previous one ends.
+            void outline(const BezierArray & _curves, bool _bClosed, BezierLoopArray & _outLoops);
+
+        private:
+
+            void outlineDash(const BezierArray & _curves, bool _bClosed, BezierLoopArray & _outLoops);
+
+            void outlineDot(const Vec2f & _position, const Vec2f & _direction, BezierLoopArray & _outLoops);
+
+            //offsets all curves to their left and connects them with joins
+            void addSide(const BezierArray & _curves, bool _bClosed, BezierArray & _outCurves);
+
+            //_start overrides the start of the offset curve to keep it connected to the previous one
+            void addOffsetCurve(const Bezier & _curve, const Vec2f * _start, BezierArray & _outCurves, stick::Size _depth);
+
+            void addJoin(const Vec2f & _position, const Vec2f & _dirIn, const Vec2f & _dirOut,
+                         const Vec2f & _from, const Vec2f & _to, BezierArray & _outCurves);
+
+            void addCap(const Vec2f & _position, const Vec2f & _direction,
+                        const Vec2f & _from, const Vec2f & _to, BezierArray & _outCurves);
+
+            Float m_halfWidth;
+            StrokeJoin m_join;
+            StrokeCap m_cap;
+            Float m_miterLimit;
+            DashArray m_dashArray;
+            Float m_dashOffset;
+            Float m_tolerance;
+            //reused between calls
+            BezierArray m_curves;
+            BezierArray m_dash;
+            BezierArray m_first;
+            BezierArray m_reversed;
+            BezierArray m_offset;
+            BezierArray m_tmp;
+            stick::DynamicArray<Float> m_lengths;
+        };
+    }
+}
+
+#endif //PAPER_PRIVATE_STROKEOUTLINER_HPP
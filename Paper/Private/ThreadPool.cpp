@@ -0,0 +1,146 @@
+#include <Paper/Private/ThreadPool.hpp>
+
+namespace paper
+{
+    namespace detail
+    {
+        using namespace stick;
+
+        ThreadPool::ThreadPool(Size _threadCount) :
+            m_generation(0),
+            m_busyCount(0),
+            m_bShutdown(false),
+            m_func(nullptr),
+            m_userData(nullptr)
+        {
+            if (!_threadCount)
+                _threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+            for (Size i = 0; i < _threadCount; ++i)
+                m_ranges.append(makeUnique<Range>());
+
+            for (Size i = 1; i < _threadCount; ++i)
+                m_threads.append(std::thread(&ThreadPool::workerLoop, this, i));
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_bShutdown = true;
+            }
+            m_wakeCondition.notify_all();
+            for (auto & t : m_threads)
+                t.join();
+        }
+
+        Size ThreadPool::threadCount() const
+        {
+            return m_ranges.count();
+        }
+
+        void ThreadPool::run(Size _count, TaskFunction _func, void * _userData)
+        {
+            if (!m_threads.count() || _count < 2)
+            {
+                for (Size i = 0; i < _count; ++i)
+                    _func(_userData, i, 0);
+                return;
+            }
+
+            Size n = m_ranges.count();
+            for (Size i = 0; i < n; ++i)
+            {
+                std::lock_guard<std::mutex> lock(m_ranges[i]->mutex);
+                m_ranges[i]->begin = _count * i / n;
+                m_ranges[i]->end = _count * (i + 1) / n;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_func = _func;
+                m_userData = _userData;
+                m_busyCount = m_threads.count();
+                ++m_generation;
+            }
+            m_wakeCondition.notify_all();
+
+            process(0);
+
+            //the ranges and the task are only valid until all workers are done with them
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_doneCondition.wait(lock, [this]() { return m_busyCount == 0; });
+        }
+
+        void ThreadPool::workerLoop(Size _worker)
+        {
+            Size generation = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wakeCondition.wait(lock, [&]() { return m_bShutdown || m_generation != generation; });
+                    if (m_bShutdown)
+                        return;
+                    generation = m_generation;
+                }
+
+                process(_worker);
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_busyCount == 0)
+                    m_doneCondition.notify_one();
+            }
+        }
+
+        void ThreadPool::process(Size _worker)
+        {
+            Range & own = *m_ranges[_worker];
+            while (true)
+            {
+                Size index;
+                bool bHasWork;
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    bHasWork = own.begin < own.end;
+                    index = own.begin++;
+                    if (!bHasWork)
+                        own.begin = own.end;
+                }
+
+                if (bHasWork)
+                    m_func(m_userData, index, _worker);
+                else if (!steal(_worker))
+                    return;
+            }
+        }
+
+        bool ThreadPool::steal(Size _worker)
+        {
+            //no work is added while a loop runs, so once every range is empty we are done.
+            Size n = m_ranges.count();
+            for (Size i = 1; i < n; ++i)
+            {
+                Range & victim = *m_ranges[(_worker + i) % n];
+                Size begin, end;
+                {
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (victim.begin >= victim.end)
+                        continue;
+
+                    end = victim.end;
+                    begin = victim.end - (victim.end - victim.begin + 1) / 2;
+                    victim.end = begin;
+                }
+
+                //nobody steals from an empty range, so it is safe to refill it here
+                Range & own = *m_ranges[_worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin;
+                own.end = end;
+                return true;
+            }
+            return false;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PAPER_PRIVATE_THREADPOOL_HPP
+#define PAPER_PRIVATE_THREADPOOL_HPP
+
+#include <Paper/BasicTypes.hpp>
+#include <Stick/DynamicArray.hpp>
+#include <Stick/UniquePtr.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace paper
+{
+    namespace detail
+    {
+        //Fixed set of worker threads that run index based parallel loops. Every worker
+        //starts out with a contiguous share of the indices. Once a worker runs out of
+        //work, it steals the upper half of the remaining indices of another worker, so
+        //uneven costs per index still keep all threads busy.
+        //The thread calling parallelFor takes part as worker 0.
+        class STICK_LOCAL ThreadPool
+        {
+        public:
+
+            //_threadCount includes the calling thread, 0 uses one thread per hardware thread.
+            explicit ThreadPool(stick::Size _threadCount = 0);
+
+            ~ThreadPool();
+
+
+            //calls _func(index, worker) for every index in [0, _count) and returns once all of
+            //them are done. worker is in [0, threadCount()) and meant to pick per thread scratch data.
+            template<class F>
+            void parallelFor(stick::Size _count, F _func);
+
+            stick::Size threadCount() const;
+
+
+        private:
+
+            using TaskFunction = void (*)(void *, stick::Size, stick::Size);
+
+            struct Range
+            {
+                std::mutex mutex;
+                stick::Size begin;
+                stick::Size end;
+            };
+
+            void run(stick::Size _count, TaskFunction _func, void * _userData);
+
+            void workerLoop(stick::Size _worker);
+
+            void process(stick::Size _worker);
+
+            bool steal(stick::Size _worker);
+
+
+            stick::DynamicArray<std::thread> m_threads;
+            stick::DynamicArray<stick::UniquePtr<Range>> m_ranges;
+            std::mutex m_mutex;
+            std::condition_variable m_wakeCondition;
+            std::condition_variable m_doneCondition;
+            stick::Size m_generation;
+            stick::Size m_busyCount;
+            bool m_bShutdown;
+            TaskFunction m_func;
+            void * m_userData;
+        };
+
+        template<class F>
+        void ThreadPool::parallelFor(stick::Size _count, F _func)
+        {
+            run(_count, [](void * _userData, stick::Size _index, stick::Size _worker)
+            {
+                (*static_cast<F *>(_userData))(_index, _worker);
+            }, &_func);
+        }
+    }
+}
+
+#endif //PAPER_PRIVATE_THREADPOOL_HPP
@@ -0,0 +1,1032 @@
+#include <Paper/Raster/RasterRenderer.hpp>
+#include <Paper/Private/PathFlattener.hpp>
+#include <Paper/Private/StrokeTriangulator.hpp>
+#include <Paper/Private/ThreadPool.hpp>
+
+#include <Crunch/MatrixFunc.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace paper
+{
+    namespace raster
+    {
+        using namespace stick;
+
+        namespace detail
+        {
+            using ByteArray = DynamicArray<UInt8>;
+            using PositionArray = paper::detail::PathFlattener::PositionArray;
+            using JoinArray = paper::detail::PathFlattener::JoinArray;
+
+            //signed cover and area an outline contributes to a single pixel.
+            //cover is the vertical extent of the outline inside the pixel, area
+            //the part of the pixel to the right of it (weighted by cover).
+            struct Cell
+            {
+                Int32 x;
+                Int32 y;
+                Float cover;
+                Float area;
+            };
+
+            using CellArray = DynamicArray<Cell>;
+
+            //Collects the cells touched by the outline of one shape and turns
+            //them into coverage rows. Only cells that an edge passes through are
+            //stored, the runs in between are filled with the accumulated cover.
+            class CellRasterizer
+            {
+            public:
+
+                CellRasterizer() :
+                    m_width(0),
+                    m_height(0)
+                {
+                }
+
+                void reset(Int32 _width, Int32 _height)
+                {
+                    m_cells.clear();
+                    m_width = _width;
+                    m_height = _height;
+                }
+
+                void addLine(const Vec2f & _a, const Vec2f & _b)
+                {
+                    //horizontal edges don't carry any cover
+                    if (_a.y == _b.y)
+                        return;
+
+                    Float h = m_height;
+                    if ((_a.y <= 0 && _b.y <= 0) || (_a.y >= h && _b.y >= h))
+                        return;
+
+                    Vec2f p0 = _a.y < 0 ? pointAtY(_a, _b, 0) : _a.y > h ? pointAtY(_a, _b, h) : _a;
+                    Vec2f p1 = _b.y < 0 ? pointAtY(_a, _b, 0) : _b.y > h ? pointAtY(_a, _b, h) : _b;
+
+                    //split the line where it leaves the buffer horizontally. Parts
+                    //left of the buffer still add cover to every pixel in the row, so
+                    //they are projected onto x = 0. Parts right of it are dropped.
+                    Float w = m_width;
+                    Float ts[4];
+                    Int32 count = 0;
+                    ts[count++] = 0;
+                    if ((p0.x < 0) != (p1.x < 0))
+                        ts[count++] = -p0.x / (p1.x - p0.x);
+                    if ((p0.x > w) != (p1.x > w))
+                        ts[count++] = (w - p0.x) / (p1.x - p0.x);
+                    if (count == 3 && ts[1] > ts[2])
+                        std::swap(ts[1], ts[2]);
+                    ts[count++] = 1;
+
+                    Vec2f d = p1 - p0;
+                    for (Int32 i = 0; i < count - 1; ++i)
+                    {
+                        Vec2f s = i == 0 ? p0 : p0 + d * ts[i];
+                        Vec2f e = i == count - 2 ? p1 : p0 + d * ts[i + 1];
+                        Float mid = (s.x + e.x) * 0.5f;
+                        if (mid >= w)
+                            continue;
+
+                        if (mid <= 0)
+                        {
+                            s.x = 0;
+                            e.x = 0;
+                        }
+                        else
+                        {
+                            s.x = std::min(std::max(s.x, 0.0f), w);
+                            e.x = std::min(std::max(e.x, 0.0f), w);
+                        }
+                        addClippedLine(s, e);
+                    }
+                }
+
+                //calls _callback(y, x0, x1, coverage) for every run of touched pixels in a row.
+                //Gaps without any coverage (i.e. holes or the inside of a stroke) split the
+                //row into separate runs. coverage is indexed with absolute x coordinates and
+                //valid in [x0, x1).
+                template<class F>
+                void sweep(WindingRule _rule, ByteArray & _coverage, F _callback)
+                {
+                    std::sort(m_cells.begin(), m_cells.end(), [](const Cell & _a, const Cell & _b)
+                    {
+                        return _a.y < _b.y || (_a.y == _b.y && _a.x < _b.x);
+                    });
+
+                    _coverage.resize(m_width);
+                    UInt8 * cov = &_coverage[0];
+                    bool bEvenOdd = _rule == WindingRule::EvenOdd;
+
+                    Size i = 0;
+                    Size n = m_cells.count();
+                    while (i < n)
+                    {
+                        Int32 y = m_cells[i].y;
+                        Int32 x0 = m_cells[i].x;
+                        Int32 end = x0;
+                        Float acc = 0;
+                        while (i < n && m_cells[i].y == y)
+                        {
+                            Int32 x = m_cells[i].x;
+                            Float cover = 0;
+                            Float area = 0;
+                            while (i < n && m_cells[i].y == y && m_cells[i].x == x)
+                            {
+                                cover += m_cells[i].cover;
+                                area += m_cells[i].area;
+                                ++i;
+                            }
+
+                            UInt8 gap = coverageValue(acc, bEvenOdd);
+                            if (!gap && x > end)
+                            {
+                                _callback(y, x0, end, cov);
+                                x0 = x;
+                            }
+                            else
+                                std::fill(cov + end, cov + x, gap);
+                            cov[x] = coverageValue(acc + area, bEvenOdd);
+                            acc += cover;
+                            end = x + 1;
+                        }
+
+                        //shapes that extend past the right border cover the rest of the row
+                        UInt8 tail = coverageValue(acc, bEvenOdd);
+                        if (tail)
+                        {
+                            std::fill(cov + end, cov + m_width, tail);
+                            end = m_width;
+                        }
+
+                        _callback(y, x0, end, cov);
+                    }
+                }
+
+            private:
+
+                static Vec2f pointAtY(const Vec2f & _a, const Vec2f & _b, Float _y)
+                {
+                    Float t = (_y - _a.y) / (_b.y - _a.y);
+                    return Vec2f(_a.x + (_b.x - _a.x) * t, _y);
+                }
+
+                static UInt8 coverageValue(Float _cover, bool _bEvenOdd)
+                {
+                    Float a = std::abs(_cover);
+                    if (_bEvenOdd)
+                    {
+                        a = std::fmod(a, 2.0f);
+                        if (a > 1.0f)
+                            a = 2.0f - a;
+                    }
+                    else
+                    {
+                        a = std::min(a, 1.0f);
+                    }
+                    return (UInt8)(a * 255.0f + 0.5f);
+                }
+
+                //_a and _b are inside the buffer
+                void addClippedLine(Vec2f _a, Vec2f _b)
+                {
+                    if (_a.y == _b.y)
+                        return;
+
+                    Float dir = 1.0f;
+                    if (_a.y > _b.y)
+                    {
+                        std::swap(_a, _b);
+                        dir = -1.0f;
+                    }
+
+                    Float dxdy = (_b.x - _a.x) / (_b.y - _a.y);
+                    Int32 firstRow = (Int32)_a.y;
+                    Int32 lastRow = std::min(m_height - 1, (Int32)std::ceil(_b.y) - 1);
+                    Float w = m_width;
+                    for (Int32 row = firstRow; row <= lastRow; ++row)
+                    {
+                        Float ya = std::max(_a.y, (Float)row);
+                        Float yb = std::min(_b.y, (Float)(row + 1));
+                        if (yb <= ya)
+                            continue;
+
+                        Float xa = std::min(std::max(_a.x + (ya - _a.y) * dxdy, 0.0f), w);
+                        Float xb = std::min(std::max(_a.x + (yb - _a.y) * dxdy, 0.0f), w);
+                        addRowSegment(row, xa, ya - row, xb, yb - row, dir);
+                    }
+                }
+
+                //adds a line that stays within one row, walking all the columns it crosses
+                void addRowSegment(Int32 _row, Float _xa, Float _ya, Float _xb, Float _yb, Float _dir)
+                {
+                    Int32 ixa = (Int32)_xa;
+                    Int32 ixb = (Int32)_xb;
+                    if (ixa == ixb)
+                    {
+                        addCell(ixa, _row, _xa - ixa, _xb - ixa, (_yb - _ya) * _dir);
+                        return;
+                    }
+
+                    Int32 step = ixb > ixa ? 1 : -1;
+                    Float dydx = (_yb - _ya) / (_xb - _xa);
+                    Float cx = _xa;
+                    Float cy = _ya;
+                    Int32 ix = ixa;
+                    while (true)
+                    {
+                        Float nx, ny;
+                        if (ix == ixb)
+                        {
+                            nx = _xb;
+                            ny = _yb;
+                        }
+                        else
+                        {
+                            nx = step > 0 ? ix + 1 : ix;
+                            ny = _ya + (nx - _xa) * dydx;
+                        }
+
+                        addCell(ix, _row, cx - ix, nx - ix, (ny - cy) * _dir);
+                        if (ix == ixb)
+                            break;
+
+                        cx = nx;
+                        cy = ny;
+                        ix += step;
+                    }
+                }
+
+                void addCell(Int32 _x, Int32 _y, Float _fx0, Float _fx1, Float _dy)
+                {
+                    if (_x >= m_width || _dy == 0)
+                        return;
+
+                    Float area = _dy * (1.0f - (_fx0 + _fx1) * 0.5f);
+                    if (m_cells.count())
+                    {
+                        Cell & last = m_cells.last();
+                        if (last.x == _x && last.y == _y)
+                        {
+                            last.cover += _dy;
+                            last.area += area;
+                            return;
+                        }
+                    }
+                    m_cells.append((Cell) {_x, _y, _dy, area});
+                }
+
+                CellArray m_cells;
+                Int32 m_width;
+                Int32 m_height;
+            };
+
+            //Tiles are rasterized independently of each other, possibly on different threads.
+            //They span full rows, as cover accumulates from left to right and narrower tiles
+            //would each have to walk the outlines to their left again.
+            static const Int32 TileHeight = 32;
+
+            using IndexArray = DynamicArray<UInt32>;
+
+            struct PixelRect
+            {
+                Int32 x0;
+                Int32 y0;
+                Int32 x1;
+                Int32 y1;
+
+                bool isEmpty() const
+                {
+                    return x0 >= x1 || y0 >= y1;
+                }
+            };
+
+            //the lines of a command that cross one tile
+            struct Band
+            {
+                UInt32 offset;
+                UInt32 count;
+            };
+
+            enum class CommandType
+            {
+                Fill,
+                BeginClipping,
+                EndClipping
+            };
+
+            //A shape that was prepared in device space while traversing the document.
+            //Its lines are stored as pairs of points in RasterStuff::lines and read by
+            //every tile that the shape overlaps.
+            struct Command
+            {
+                CommandType type;
+                WindingRule windingRule;
+                Size lineOffset;
+                Size lineCount;
+                //index of the band of the first tile in RasterStuff::bands
+                Size bandOffset;
+                Int32 firstTile;
+                //index into RasterStuff::gradients, -1 for solid colors
+                Int32 gradient;
+                UInt8 color[4];
+                PixelRect bounds;
+            };
+
+            struct Gradient
+            {
+                UInt8 table[256 * 4];
+                Mat3f inverseTransform;
+                Vec2f origin;
+                //for linear gradients, the direction scaled by its inverse squared length
+                Vec2f direction;
+                bool bRadial;
+                //for radial gradients, the inverse of the radius
+                Float inverseRadius;
+            };
+
+            //scratch data owned by one worker thread
+            struct TileContext
+            {
+                CellRasterizer rasterizer;
+                ByteArray coverage;
+                ByteArray spanColors;
+                //clip masks cover one tile and are kept around between frames
+                DynamicArray<ByteArray> clipMasks;
+            };
+
+            struct RasterStuff
+            {
+                RasterStuff() :
+                    width(0),
+                    height(0),
+                    clearColor(0, 0, 0, 0),
+                    bHasProjection(false),
+                    threadCount(0)
+                {
+                }
+
+                Int32 width;
+                Int32 height;
+                ByteArray pixels;
+                ColorRGBA clearColor;
+                UInt8 clearPixel[4];
+                bool bHasProjection;
+                Mat4f projection;
+                Mat3f deviceTransform;
+                Size threadCount;
+                UniquePtr<paper::detail::ThreadPool> threadPool;
+                DynamicArray<TileContext> contexts;
+                DynamicArray<Command> commands;
+                PositionArray lines;
+                DynamicArray<Gradient> gradients;
+                DynamicArray<PixelRect> clipStack;
+                //the indices of the commands that overlap each tile, in drawing order
+                DynamicArray<IndexArray> tiles;
+                DynamicArray<Band> bands;
+                IndexArray bandLines;
+                PositionArray positions;
+                PositionArray vertices;
+                JoinArray joins;
+            };
+
+            static inline UInt32 mulDiv255(UInt32 _a, UInt32 _b)
+            {
+                UInt32 t = _a * _b + 128;
+                return (t + (t >> 8)) >> 8;
+            }
+
+            // The blend loops are kept free of branches so that the compiler can vectorize them.
+            static void blendSolid(UInt8 * _dst, const UInt8 * _coverage, Size _count, const UInt8 * _color)
+            {
+                for (Size i = 0; i < _count; ++i)
+                {
+                    UInt32 c = _coverage[i];
+                    UInt32 inv = 255 - mulDiv255(_color[3], c);
+                    UInt8 * d = _dst + i * 4;
+                    d[0] = std::min(mulDiv255(_color[0], c) + mulDiv255(d[0], inv), 255u);
+                    d[1] = std::min(mulDiv255(_color[1], c) + mulDiv255(d[1], inv), 255u);
+                    d[2] = std::min(mulDiv255(_color[2], c) + mulDiv255(d[2], inv), 255u);
+                    d[3] = std::min(mulDiv255(_color[3], c) + mulDiv255(d[3], inv), 255u);
+                }
+            }
+
+            //opaque colors replace fully covered pixels, only the partially covered ones
+            //along the edges need blending.
+            static void blendOpaque(UInt8 * _dst, const UInt8 * _coverage, Size _count, const UInt8 * _color)
+            {
+                UInt32 packed;
+                std::copy(_color, _color + 4, reinterpret_cast<UInt8 *>(&packed));
+                Size i = 0;
+                while (i < _count)
+                {
+                    Size start = i;
+                    while (i < _count && _coverage[i] == 255)
+                        ++i;
+                    std::fill(reinterpret_cast<UInt32 *>(_dst + start * 4), reinterpret_cast<UInt32 *>(_dst + i * 4), packed);
+
+                    start = i;
+                    while (i < _count && _coverage[i] != 255)
+                        ++i;
+                    blendSolid(_dst + start * 4, _coverage + start, i - start, _color);
+                }
+            }
+
+            static void blendSpan(UInt8 * _dst, const UInt8 * _coverage, Size _count, const UInt8 * _colors)
+            {
+                for (Size i = 0; i < _count; ++i)
+                {
+                    UInt32 c = _coverage[i];
+                    const UInt8 * s = _colors + i * 4;
+                    UInt32 inv = 255 - mulDiv255(s[3], c);
+                    UInt8 * d = _dst + i * 4;
+                    d[0] = std::min(mulDiv255(s[0], c) + mulDiv255(d[0], inv), 255u);
+                    d[1] = std::min(mulDiv255(s[1], c) + mulDiv255(d[1], inv), 255u);
+                    d[2] = std::min(mulDiv255(s[2], c) + mulDiv255(d[2], inv), 255u);
+                    d[3] = std::min(mulDiv255(s[3], c) + mulDiv255(d[3], inv), 255u);
+                }
+            }
+
+            static void applyMask(UInt8 * _coverage, const UInt8 * _mask, Size _count)
+            {
+                for (Size i = 0; i < _count; ++i)
+                    _coverage[i] = mulDiv255(_coverage[i], _mask[i]);
+            }
+
+            static void premultiply(const ColorRGBA & _color, UInt8 * _out)
+            {
+                Float a = std::min(std::max(_color.a, 0.0f), 1.0f);
+                _out[0] = (UInt8)(std::min(std::max(_color.r, 0.0f), 1.0f) * a * 255.0f + 0.5f);
+                _out[1] = (UInt8)(std::min(std::max(_color.g, 0.0f), 1.0f) * a * 255.0f + 0.5f);
+                _out[2] = (UInt8)(std::min(std::max(_color.b, 0.0f), 1.0f) * a * 255.0f + 0.5f);
+                _out[3] = (UInt8)(a * 255.0f + 0.5f);
+            }
+
+            static void updateGradientTable(const ColorStopArray & _stops, UInt8 * _table)
+            {
+                if (!_stops.count())
+                {
+                    std::fill(_table, _table + 256 * 4, 0);
+                    return;
+                }
+
+                ColorStopArray stops(_stops);
+                std::stable_sort(stops.begin(), stops.end(), [](const ColorStop & _a, const ColorStop & _b)
+                {
+                    return _a.offset < _b.offset;
+                });
+
+                Size idx = 0;
+                for (Size i = 0; i < 256; ++i)
+                {
+                    Float t = i / 255.0f;
+                    while (idx < stops.count() && stops[idx].offset < t)
+                        ++idx;
+
+                    ColorRGBA col;
+                    if (idx == 0)
+                        col = stops.first().color;
+                    else if (idx == stops.count())
+                        col = stops.last().color;
+                    else
+                    {
+                        const ColorStop & a = stops[idx - 1];
+                        const ColorStop & b = stops[idx];
+                        Float f = b.offset > a.offset ? (t - a.offset) / (b.offset - a.offset) : 1.0f;
+                        col = ColorRGBA(a.color.r + (b.color.r - a.color.r) * f,
+                                        a.color.g + (b.color.g - a.color.g) * f,
+                                        a.color.b + (b.color.b - a.color.b) * f,
+                                        a.color.a + (b.color.a - a.color.a) * f);
+                    }
+                    premultiply(col, _table + i * 4);
+                }
+            }
+
+            static Float deviceScale(const Mat3f & _transform)
+            {
+                return std::max(crunch::length(Vec2f(_transform[0].x, _transform[0].y)),
+                                crunch::length(Vec2f(_transform[1].x, _transform[1].y)));
+            }
+
+            static Float flatteningTolerance(const Mat3f & _transform)
+            {
+                return 0.15f / std::max(deviceScale(_transform), 0.0001f);
+            }
+
+            static void addFillContours(RasterStuff & _r, const Path & _path, const Mat3f & _transform)
+            {
+                if (_path.segmentArray().count() > 1)
+                {
+                    _r.positions.clear();
+                    paper::detail::PathFlattener::flatten(_path, _r.positions, nullptr, flatteningTolerance(_transform), 0.0f, 32);
+
+                    //contours are implicitly closed, just like for open paths that are filled
+                    Size n = _r.positions.count();
+                    Vec2f first = _transform * _r.positions[0];
+                    Vec2f last = first;
+                    for (Size i = 1; i < n; ++i)
+                    {
+                        Vec2f p = _transform * _r.positions[i];
+                        _r.lines.append(last);
+                        _r.lines.append(p);
+                        last = p;
+                    }
+                    _r.lines.append(last);
+                    _r.lines.append(first);
+                }
+
+                for (const Item & c : _path.children())
+                {
+                    STICK_ASSERT(c.itemType() == EntityType::Path);
+                    const Path & p = static_cast<const Path &>(c);
+                    addFillContours(_r, p, p.hasTransform() ? _transform * p.transform() : _transform);
+                }
+            }
+
+            static void addTriangle(PositionArray & _lines, const Vec2f & _a, const Vec2f & _b, const Vec2f & _c)
+            {
+                //all triangles need the same orientation so that overlaps don't cancel out
+                Float cross = (_b.x - _a.x) * (_c.y - _a.y) - (_b.y - _a.y) * (_c.x - _a.x);
+                if (cross == 0)
+                    return;
+
+                const Vec2f & b = cross > 0 ? _b : _c;
+                const Vec2f & c = cross > 0 ? _c : _b;
+                _lines.append(_a);
+                _lines.append(b);
+                _lines.append(b);
+                _lines.append(c);
+                _lines.append(c);
+                _lines.append(_a);
+            }
+
+            //compound path children are stroked with the style of the compound path
+            static void addStrokeTriangles(RasterStuff & _r, const Path & _path, const Mat3f & _transform, const PathStyle & _style)
+            {
+                if (_path.segmentArray().count() > 1)
+                {
+                    //same triangulation as the OpenGL renderer, the triangles are in path space
+                    Mat3f strokeMat = Item::strokeTransform(&_path.absoluteTransform(), _style.strokeWidth, _style.bScalingStroke);
+                    paper::detail::StrokeTriangulator tri(strokeMat, crunch::inverse(strokeMat), _style.join, _style.cap,
+                                                          _style.miterLimit, _path.isClosed(), _style.dashArray, _style.dashOffset);
+
+                    _r.positions.clear();
+                    _r.joins.clear();
+                    _r.vertices.clear();
+                    paper::detail::PathFlattener::flatten(_path, _r.positions, &_r.joins, flatteningTolerance(_transform), 0.0f, 32);
+                    tri.triangulateStroke(_r.positions, _r.joins, _r.vertices, _path.isClockwise());
+
+                    for (auto & v : _r.vertices)
+                        v = _transform * v;
+
+                    //dashed strokes are generated as separate triangles, solid ones as a strip
+                    Size n = _r.vertices.count();
+                    Size step = _style.dashArray.count() ? 3 : 1;
+                    for (Size i = 0; i + 2 < n; i += step)
+                        addTriangle(_r.lines, _r.vertices[i], _r.vertices[i + 1], _r.vertices[i + 2]);
+                }
+
+                for (const Item & c : _path.children())
+                {
+                    const Path & p = static_cast<const Path &>(c);
+                    addStrokeTriangles(_r, p, p.hasTransform() ? _transform * p.transform() : _transform, _style);
+                }
+            }
+
+            //returns false if _paint does not draw anything
+            static bool preparePaint(RasterStuff & _r, const Paint & _paint, const Mat3f & _transform, Command & _cmd)
+            {
+                _cmd.gradient = -1;
+                if (_paint.is<ColorRGBA>())
+                {
+                    premultiply(_paint.get<ColorRGBA>(), _cmd.color);
+                    return _cmd.color[3] != 0;
+                }
+                else if (_paint.is<LinearGradient>() || _paint.is<RadialGradient>())
+                {
+                    bool bRadial = _paint.is<RadialGradient>();
+                    const BaseGradient & grad = bRadial ? (const BaseGradient &)_paint.get<RadialGradient>() :
+                                                (const BaseGradient &)_paint.get<LinearGradient>();
+                    _r.gradients.resize(_r.gradients.count() + 1);
+                    Gradient & g = _r.gradients.last();
+                    updateGradientTable(grad.stops(), g.table);
+
+                    //gradient positions are in path space, just like in the tarp renderer
+                    g.inverseTransform = crunch::inverse(_transform);
+                    g.origin = grad.origin();
+                    g.direction = grad.destination() - g.origin;
+                    g.bRadial = bRadial;
+                    g.inverseRadius = 0;
+                    Float lenSq = crunch::dot(g.direction, g.direction);
+                    if (lenSq > 0)
+                    {
+                        //radial gradients are centered at the origin and reach the destination
+                        g.direction = g.direction / lenSq;
+                        g.inverseRadius = 1.0f / std::sqrt(lenSq);
+                    }
+                    _cmd.gradient = _r.gradients.count() - 1;
+                    return true;
+                }
+                return false;
+            }
+
+            static PixelRect intersect(const PixelRect & _a, const PixelRect & _b)
+            {
+                return {std::max(_a.x0, _b.x0), std::max(_a.y0, _b.y0), std::min(_a.x1, _b.x1), std::min(_a.y1, _b.y1)};
+            }
+
+            //appends a command for the lines added since _lineOffset, bounded by the current clipping path
+            static void addCommand(RasterStuff & _r, Command & _cmd, CommandType _type, Size _lineOffset, WindingRule _rule)
+            {
+                PixelRect clip = _r.clipStack.count() ? _r.clipStack.last() : PixelRect {0, 0, _r.width, _r.height};
+
+                Vec2f min(std::numeric_limits<Float>::max());
+                Vec2f max(-std::numeric_limits<Float>::max());
+                for (Size i = _lineOffset; i < _r.lines.count(); ++i)
+                {
+                    min = crunch::min(min, _r.lines[i]);
+                    max = crunch::max(max, _r.lines[i]);
+                }
+
+                //the pixels touched by an outline, clamped so that the conversion can't overflow
+                PixelRect bounds = {(Int32)std::floor(std::max(min.x, -1.0f)), (Int32)std::floor(std::max(min.y, -1.0f)),
+                                    (Int32)std::floor(std::min(max.x, (Float)_r.width)) + 1,
+                                    (Int32)std::floor(std::min(max.y, (Float)_r.height)) + 1
+                                   };
+
+                _cmd.type = _type;
+                _cmd.windingRule = _rule;
+                _cmd.lineOffset = _lineOffset;
+                _cmd.lineCount = (_r.lines.count() - _lineOffset) / 2;
+                _cmd.bounds = intersect(bounds, clip);
+
+                if (_type == CommandType::BeginClipping)
+                    _r.clipStack.append(_cmd.bounds);
+                else if (_cmd.bounds.isEmpty())
+                {
+                    //nothing of the shape is visible
+                    _r.lines.resize(_lineOffset);
+                    return;
+                }
+                _r.commands.append(_cmd);
+            }
+
+            static void binCommands(RasterStuff & _r)
+            {
+                _r.tiles.resize((_r.height + TileHeight - 1) / TileHeight);
+                for (auto & tile : _r.tiles)
+                    tile.clear();
+
+                _r.bands.clear();
+                _r.bandLines.clear();
+                for (Size i = 0; i < _r.commands.count(); ++i)
+                {
+                    Command & cmd = _r.commands[i];
+                    const PixelRect & b = cmd.bounds;
+                    if (b.isEmpty())
+                        continue;
+
+                    Int32 firstTile = b.y0 / TileHeight;
+                    Int32 lastTile = (b.y1 - 1) / TileHeight;
+                    for (Int32 y = firstTile; y <= lastTile; ++y)
+                        _r.tiles[y].append(i);
+
+                    //sort the lines into the tiles they cross so that a tile does not
+                    //need to look at the lines of a shape that are above or below it.
+                    cmd.firstTile = firstTile;
+                    cmd.bandOffset = _r.bands.count();
+                    _r.bands.resize(_r.bands.count() + lastTile - firstTile + 1);
+                    Band * bands = &_r.bands[cmd.bandOffset];
+                    for (Int32 j = 0; j <= lastTile - firstTile; ++j)
+                        bands[j] = {0, 0};
+
+                    const Vec2f * lines = &_r.lines[cmd.lineOffset];
+                    auto tileRange = [&](Size _line, Int32 & _outFirst, Int32 & _outLast)
+                    {
+                        Float y0 = std::min(lines[_line * 2].y, lines[_line * 2 + 1].y);
+                        Float y1 = std::max(lines[_line * 2].y, lines[_line * 2 + 1].y);
+                        //horizontal lines and the ones outside of the bounds don't add any cover
+                        if (y0 == y1 || y1 <= b.y0 || y0 >= b.y1)
+                            return false;
+                        _outFirst = (Int32)std::floor(std::max(y0, (Float)b.y0)) / TileHeight - firstTile;
+                        _outLast = ((Int32)std::ceil(std::min(y1, (Float)b.y1)) - 1) / TileHeight - firstTile;
+                        return true;
+                    };
+
+                    Int32 from, to;
+                    for (Size j = 0; j < cmd.lineCount; ++j)
+                    {
+                        if (tileRange(j, from, to))
+                        {
+                            for (Int32 k = from; k <= to; ++k)
+                                ++bands[k].count;
+                        }
+                    }
+
+                    UInt32 offset = _r.bandLines.count();
+                    for (Int32 j = 0; j <= lastTile - firstTile; ++j)
+                    {
+                        bands[j].offset = offset;
+                        offset += bands[j].count;
+                        bands[j].count = 0;
+                    }
+
+                    _r.bandLines.resize(offset);
+                    for (Size j = 0; j < cmd.lineCount; ++j)
+                    {
+                        if (tileRange(j, from, to))
+                        {
+                            for (Int32 k = from; k <= to; ++k)
+                                _r.bandLines[bands[k].offset + bands[k].count++] = j;
+                        }
+                    }
+                }
+            }
+
+            //blends the shape accumulated in the rasterizer of _ctx with the paint of _cmd
+            static void fillShape(RasterStuff & _r, TileContext & _ctx, const Command & _cmd,
+                                  Int32 _tileY, const UInt8 * _mask)
+            {
+                UInt8 * pixels = &_r.pixels[0];
+                Int32 width = _r.width;
+
+                if (_cmd.gradient == -1)
+                {
+                    _ctx.rasterizer.sweep(_cmd.windingRule, _ctx.coverage, [&](Int32 _y, Int32 _x0, Int32 _x1, UInt8 * _coverage)
+                    {
+                        if (_mask)
+                            applyMask(_coverage + _x0, _mask + _y * width + _x0, _x1 - _x0);
+                        UInt8 * dst = pixels + ((_tileY + _y) * width + _x0) * 4;
+                        if (_cmd.color[3] == 255)
+                            blendOpaque(dst, _coverage + _x0, _x1 - _x0, _cmd.color);
+                        else
+                            blendSolid(dst, _coverage + _x0, _x1 - _x0, _cmd.color);
+                    });
+                }
+                else
+                {
+                    const Gradient & grad = _r.gradients[_cmd.gradient];
+                    const Mat3f & inv = grad.inverseTransform;
+                    Vec2f step(inv[0].x, inv[0].y);
+                    Float dt = crunch::dot(step, grad.direction);
+
+                    _ctx.spanColors.resize(width * 4);
+                    _ctx.rasterizer.sweep(_cmd.windingRule, _ctx.coverage, [&](Int32 _y, Int32 _x0, Int32 _x1, UInt8 * _coverage)
+                    {
+                        Vec2f start = inv * Vec2f(_x0 + 0.5f, _tileY + _y + 0.5f) - grad.origin;
+                        UInt8 * colors = &_ctx.spanColors[0];
+                        if (grad.bRadial)
+                        {
+                            Vec2f pos = start;
+                            for (Int32 x = _x0; x < _x1; ++x, pos += step)
+                            {
+                                Float t = crunch::length(pos) * grad.inverseRadius;
+                                Int32 idx = std::min(std::max((Int32)(t * 255.0f + 0.5f), 0), 255);
+                                std::copy(grad.table + idx * 4, grad.table + idx * 4 + 4, colors + (x - _x0) * 4);
+                            }
+                        }
+                        else
+                        {
+                            Float t = crunch::dot(start, grad.direction);
+                            for (Int32 x = _x0; x < _x1; ++x, t += dt)
+                            {
+                                Int32 idx = std::min(std::max((Int32)(t * 255.0f + 0.5f), 0), 255);
+                                std::copy(grad.table + idx * 4, grad.table + idx * 4 + 4, colors + (x - _x0) * 4);
+                            }
+                        }
+
+                        if (_mask)
+                            applyMask(_coverage + _x0, _mask + _y * width + _x0, _x1 - _x0);
+                        blendSpan(pixels + ((_tileY + _y) * width + _x0) * 4, _coverage + _x0, _x1 - _x0, colors);
+                    });
+                }
+            }
+
+            static void renderTile(RasterStuff & _r, TileContext & _ctx, Size _tile)
+            {
+                Int32 width = _r.width;
+                Int32 tileY = _tile * TileHeight;
+                Int32 tileHeight = std::min(TileHeight, _r.height - tileY);
+
+                UInt8 * pixels = &_r.pixels[tileY * width * 4];
+                for (Int32 i = 0; i < tileHeight * width * 4; i += 4)
+                    std::copy(_r.clearPixel, _r.clearPixel + 4, pixels + i);
+
+                Vec2f origin(0, tileY);
+                Size clipDepth = 0;
+                for (UInt32 idx : _r.tiles[_tile])
+                {
+                    const Command & cmd = _r.commands[idx];
+                    if (cmd.type == CommandType::EndClipping)
+                    {
+                        STICK_ASSERT(clipDepth);
+                        --clipDepth;
+                        continue;
+                    }
+
+                    _ctx.rasterizer.reset(width, tileHeight);
+                    const Vec2f * lines = &_r.lines[cmd.lineOffset];
+                    const Band & band = _r.bands[cmd.bandOffset + _tile - cmd.firstTile];
+                    for (UInt32 i = band.offset; i < band.offset + band.count; ++i)
+                    {
+                        UInt32 line = _r.bandLines[i];
+                        _ctx.rasterizer.addLine(lines[line * 2] - origin, lines[line * 2 + 1] - origin);
+                    }
+
+                    if (cmd.type == CommandType::BeginClipping)
+                    {
+                        if (_ctx.clipMasks.count() <= clipDepth)
+                            _ctx.clipMasks.resize(clipDepth + 1);
+
+                        ByteArray & mask = _ctx.clipMasks[clipDepth];
+                        mask.resize(width * TileHeight);
+                        std::fill(mask.begin(), mask.end(), 0);
+
+                        //nested clipping paths intersect with the current mask
+                        const UInt8 * parent = clipDepth ? &_ctx.clipMasks[clipDepth - 1][0] : nullptr;
+                        _ctx.rasterizer.sweep(cmd.windingRule, _ctx.coverage, [&](Int32 _y, Int32 _x0, Int32 _x1, UInt8 * _coverage)
+                        {
+                            if (parent)
+                                applyMask(_coverage + _x0, parent + _y * width + _x0, _x1 - _x0);
+                            std::copy(_coverage + _x0, _coverage + _x1, &mask[_y * width + _x0]);
+                        });
+                        ++clipDepth;
+                    }
+                    else
+                    {
+                        fillShape(_r, _ctx, cmd, tileY, clipDepth ? &_ctx.clipMasks[clipDepth - 1][0] : nullptr);
+                    }
+                }
+                STICK_ASSERT(!clipDepth);
+            }
+        }
+
+        RasterRenderer::RasterRenderer() :
+            m_raster(makeUnique<detail::RasterStuff>())
+        {
+
+        }
+
+        RasterRenderer::~RasterRenderer()
+        {
+
+        }
+
+        Error RasterRenderer::init(Document _doc)
+        {
+            this->m_document = _doc;
+            return Error();
+        }
+
+        void RasterRenderer::setViewport(Float _x, Float _y, Float _widthInPixels, Float _heightInPixels)
+        {
+            RenderInterface::setViewport(_x, _y, _widthInPixels, _heightInPixels);
+            m_raster->width = std::max((Int32)_widthInPixels, 0);
+            m_raster->height = std::max((Int32)_heightInPixels, 0);
+            m_raster->pixels.resize(m_raster->width * m_raster->height * 4);
+        }
+
+        void RasterRenderer::setProjection(const Mat4f & _projection)
+        {
+            RenderInterface::setProjection(_projection);
+            m_raster->projection = _projection;
+            m_raster->bHasProjection = true;
+        }
+
+        void RasterRenderer::reserveItems(Size _count)
+        {
+            //nothing is cached per item
+        }
+
+        void RasterRenderer::setClearColor(const ColorRGBA & _color)
+        {
+            m_raster->clearColor = _color;
+        }
+
+        void RasterRenderer::setThreadCount(Size _count)
+        {
+            if (_count != m_raster->threadCount)
+            {
+                m_raster->threadCount = _count;
+                m_raster->threadPool.reset();
+            }
+        }
+
+        const UInt8 * RasterRenderer::pixels() const
+        {
+            return m_raster->pixels.count() ? &m_raster->pixels[0] : nullptr;
+        }
+
+        Size RasterRenderer::width() const
+        {
+            return m_raster->width;
+        }
+
+        Size RasterRenderer::height() const
+        {
+            return m_raster->height;
+        }
+
+        Error RasterRenderer::drawPath(Path _path, const Mat3f & _transform, const PathStyle & _style)
+        {
+            detail::RasterStuff & r = *m_raster;
+            Mat3f transform = r.deviceTransform * _transform;
+
+            detail::Command cmd;
+            if (detail::preparePaint(r, _style.fill, transform, cmd))
+            {
+                Size offset = r.lines.count();
+                detail::addFillContours(r, _path, transform);
+                detail::addCommand(r, cmd, detail::CommandType::Fill, offset, _style.windingRule);
+            }
+
+            if (_style.strokeWidth > 0 && detail::preparePaint(r, _style.stroke, transform, cmd))
+            {
+                Size offset = r.lines.count();
+                detail::addStrokeTriangles(r, _path, transform, _style);
+                detail::addCommand(r, cmd, detail::CommandType::Fill, offset, WindingRule::NonZero);
+            }
+
+            return Error();
+        }
+
+        Error RasterRenderer::beginClipping(Path _clippingPath, const Mat3f & _transform)
+        {
+            detail::RasterStuff & r = *m_raster;
+            detail::Command cmd;
+            cmd.gradient = -1;
+            Size offset = r.lines.count();
+            detail::addFillContours(r, _clippingPath, r.deviceTransform * _transform);
+            detail::addCommand(r, cmd, detail::CommandType::BeginClipping, offset, _clippingPath.windingRule());
+            return Error();
+        }
+
+        Error RasterRenderer::endClipping()
+        {
+            detail::RasterStuff & r = *m_raster;
+            STICK_ASSERT(r.clipStack.count());
+
+            //ends the clipping in exactly the tiles that began it
+            detail::Command cmd;
+            cmd.type = detail::CommandType::EndClipping;
+            cmd.lineOffset = 0;
+            cmd.lineCount = 0;
+            cmd.gradient = -1;
+            cmd.bounds = r.clipStack.last();
+            r.clipStack.resize(r.clipStack.count() - 1);
+            r.commands.append(cmd);
+            return Error();
+        }
+
+        Error RasterRenderer::prepareDrawing()
+        {
+            detail::RasterStuff & r = *m_raster;
+            if (!r.width || !r.height)
+                return Error(ec::InvalidOperation, "The raster renderer needs a viewport to draw", STICK_FILE, STICK_LINE);
+
+            if (r.bHasProjection)
+            {
+                //bring the 2D part of the projection to pixels, flipping y as the rows go from top to bottom
+                const Mat4f & p = r.projection;
+                Mat3f proj(crunch::Vec3f(p[0][0], p[0][1], 0), crunch::Vec3f(p[1][0], p[1][1], 0), crunch::Vec3f(p[3][0], p[3][1], 1));
+                Mat3f ndcToPixels(crunch::Vec3f(r.width * 0.5f, 0, 0), crunch::Vec3f(0, -r.height * 0.5f, 0),
+                                  crunch::Vec3f(r.width * 0.5f, r.height * 0.5f, 1));
+                r.deviceTransform = ndcToPixels * proj;
+            }
+            else
+            {
+                r.deviceTransform = Mat3f::identity();
+            }
+
+            detail::premultiply(r.clearColor, r.clearPixel);
+            r.commands.clear();
+            r.lines.clear();
+            r.gradients.clear();
+            r.clipStack.clear();
+            return Error();
+        }
+
+        Error RasterRenderer::finishDrawing()
+        {
+            detail::RasterStuff & r = *m_raster;
+            STICK_ASSERT(!r.clipStack.count());
+
+            //all geometry is prepared at this point and only read from the tiles
+            detail::binCommands(r);
+
+            if (!r.threadPool)
+            {
+                r.threadPool = makeUnique<paper::detail::ThreadPool>(r.threadCount);
+                r.contexts.resize(r.threadPool->threadCount());
+            }
+
+            r.threadPool->parallelFor(r.tiles.count(), [&r](Size _tile, Size _worker)
+            {
+                detail::renderTile(r, r.contexts[_worker], _tile);
+            });
+            return Error();
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef PAPER_RASTER_RASTERRENDERER_HPP
+#define PAPER_RASTER_RASTERRENDERER_HPP
+
+#include <Paper/RenderInterface.hpp>
+#include <Stick/UniquePtr.hpp>
+
+namespace paper
+{
+    namespace raster
+    {
+        namespace detail
+        {
+            struct RasterStuff;
+        };
+
+        //Software renderer that does not need an OpenGL context. It renders into
+        //an in memory RGBA8 buffer with premultiplied alpha, rows from top to bottom.
+        //Shapes are rasterized by accumulating signed area and cover per touched
+        //pixel cell, so the cost depends on the outline length rather than on
+        //the number of pixels covered.
+        //Drawing first prepares the geometry of all visible items in device space and
+        //bins it into screen tiles, which are then rasterized in parallel.
+        class STICK_API RasterRenderer : public RenderInterface
+        {
+        public:
+
+            RasterRenderer();
+
+            ~RasterRenderer();
+
+
+            stick::Error init(Document _doc) final;
+
+            //resizes the target buffer to _widthInPixels x _heightInPixels.
+            //_x and _y are ignored as the buffer always matches the viewport.
+            void setViewport(Float _x, Float _y, Float _widthInPixels, Float _heightInPixels) final;
+
+            //expects an OpenGL style projection into normalized device coordinates.
+            //If no projection is set, document coordinates map one to one to pixels.
+            void setProjection(const Mat4f & _projection) final;
+
+            void reserveItems(stick::Size _count) final;
+
+            void setClearColor(const ColorRGBA & _color);
+
+            //the number of threads that rasterize tiles, including the one calling draw.
+            //0 (the default) uses one thread per hardware thread.
+            void setThreadCount(stick::Size _count);
+
+            const stick::UInt8 * pixels() const;
+
+            stick::Size width() const;
+
+            stick::Size height() const;
+
+            stick::Error drawPath(Path _path, const Mat3f & _transform, const PathStyle & _style) final;
+
+            stick::Error beginClipping(Path _clippingPath, const Mat3f & _transform) final;
+
+            stick::Error endClipping() final;
+
+            stick::Error prepareDrawing() final;
+
+            stick::Error finishDrawing() final;
+
+
+        private:
+
+            stick::UniquePtr<detail::RasterStuff> m_raster;
+        };
+    }
+}
+
+#endif //PAPER_RASTER_RASTERRENDERER_HPP
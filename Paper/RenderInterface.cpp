@@ -1,13 +1,19 @@
 #include <Paper/RenderInterface.hpp>
+#include <Paper/DisplayList.hpp>
 #include <Paper/Document.hpp>
 #include <Paper/Path.hpp>
 #include <Paper/PlacedSymbol.hpp>
+#include <Paper/Private/SpatialIndex.hpp>
 
 #include <Crunch/StringConversion.hpp>
 
 namespace paper
 {
-    RenderInterface::RenderInterface()
+    RenderInterface::RenderInterface() :
+        m_viewportSize(0, 0),
+        m_bHasProjection(false),
+        m_culledItemCount(0),
+        m_drawnPathCount(0)
     {
 
     }
@@ -17,9 +23,51 @@ namespace paper
 
     }
 
+    void RenderInterface::setViewport(Float _x, Float _y, Float _widthInPixels, Float _heightInPixels)
+    {
+        m_viewportSize = Vec2f(_widthInPixels, _heightInPixels);
+    }
+
+    void RenderInterface::setProjection(const Mat4f & _projection)
+    {
+        m_projection = _projection;
+        m_bHasProjection = true;
+    }
+
+    stick::Size RenderInterface::culledItemCount() const
+    {
+        return m_culledItemCount;
+    }
+
+    stick::Size RenderInterface::drawnPathCount() const
+    {
+        return m_drawnPathCount;
+    }
+
+    void RenderInterface::beginFrame()
+    {
+        if (m_bHasProjection)
+        {
+            //the visible area in normalized device coordinates
+            const Mat4f & p = m_projection;
+            m_cullingTransform = Mat3f(crunch::Vec3f(p[0][0], p[0][1], 0), crunch::Vec3f(p[1][0], p[1][1], 0), crunch::Vec3f(p[3][0], p[3][1], 1));
+            m_cullingRect = Rect(-1, -1, 1, 1);
+        }
+        else
+        {
+            //without a projection, document units are pixels
+            m_cullingTransform = Mat3f::identity();
+            m_cullingRect = Rect(Vec2f(0, 0), m_viewportSize);
+        }
+        m_culledItemCount = 0;
+        m_drawnPathCount = 0;
+    }
+
     stick::Error RenderInterface::draw()
     {
         STICK_ASSERT(m_document.isValid());
+
+        beginFrame();
         stick::Error ret = prepareDrawing();
         if (ret) return ret;
         ret = drawChildren(m_document, nullptr);
@@ -28,6 +76,43 @@ namespace paper
         return ret;
     }
 
+    stick::Error RenderInterface::draw(const DisplayList & _list)
+    {
+        beginFrame();
+        stick::Error ret = prepareDrawing();
+        if (ret) return ret;
+
+        const DisplayList::CommandArray & cmds = _list.commands();
+        for (stick::Size i = 0; i < cmds.count(); ++i)
+        {
+            const DisplayList::Command & cmd = cmds[i];
+            if (cmd.type == DisplayList::CommandType::DrawPath)
+            {
+                if (!cmd.bDrawable || isCulled(cmd.bounds))
+                    continue;
+                ++m_drawnPathCount;
+                ret = drawPath(cmd.path, cmd.transform, cmd.style);
+            }
+            else if (cmd.type == DisplayList::CommandType::BeginClipping)
+            {
+                //nothing inside of the clipping path can be visible, skip the whole scope
+                if (isCulled(cmd.bounds))
+                {
+                    i = cmd.scopeEnd;
+                    continue;
+                }
+                ret = beginClipping(cmd.path, cmd.transform);
+            }
+            else
+                ret = endClipping();
+
+            if (ret) return ret;
+        }
+
+        ret = finishDrawing();
+        return ret;
+    }
+
     stick::Error RenderInterface::drawChildren(Item _item, const Mat3f * _transform)
     {
         const auto & children = _item.children();
@@ -52,7 +137,7 @@ namespace paper
         if (et == EntityType::Group)
         {
             Group grp = brick::reinterpretEntity<Group>(_item);
-            if (!grp.isVisible())
+            if (!grp.isVisible() || isCulled(_item, _transform))
                 return ret;
 
             if (grp.isClipped())
@@ -79,16 +164,52 @@ namespace paper
         else if (et == EntityType::Path)
         {
             Path p = brick::reinterpretEntity<Path>(_item);
-            if (p.isVisible() && p.segmentArray().count() > 1)
+            if (p.isVisible() && p.segmentArray().count() > 1 && !isCulled(_item, _transform))
             {
-                ret = drawPath(p, _transform ? tmp : p.absoluteTransform());
+                ++m_drawnPathCount;
+                ret = drawPath(p, _transform ? tmp : p.absoluteTransform(), p.style());
             }
         }
         else if (et == EntityType::PlacedSymbol)
         {
+            if (isCulled(_item, _transform))
+                return ret;
             PlacedSymbol ps = brick::reinterpretEntity<PlacedSymbol>(_item);
             drawItem(ps.symbol().item(), _transform ? &tmp : &ps.absoluteTransform());
         }
         return ret;
     }
+
+    bool RenderInterface::isCulled(const Item & _item, const Mat3f * _transform)
+    {
+        //the cached bounds of items inside of a symbol are not in document space, these are
+        //culled together with the placed symbol instead.
+        if (_transform)
+            return false;
+
+        return isCulled(_item.strokeBounds());
+    }
+
+    bool RenderInterface::isCulled(const Rect & _bounds)
+    {
+        if (m_viewportSize.x <= 0 || m_viewportSize.y <= 0)
+            return false;
+
+        const Rect & b = _bounds;
+        Vec2f corners[4] = {b.min(), Vec2f(b.max().x, b.min().y), b.max(), Vec2f(b.min().x, b.max().y)};
+        Vec2f min = m_cullingTransform * corners[0];
+        Vec2f max = min;
+        for (stick::Size i = 1; i < 4; ++i)
+        {
+            Vec2f c = m_cullingTransform * corners[i];
+            min = crunch::min(min, c);
+            max = crunch::max(max, c);
+        }
+
+        if (detail::rectsOverlap(Rect(min, max), m_cullingRect))
+            return false;
+
+        ++m_culledItemCount;
+        return true;
+    }
 }
@@ -9,6 +9,7 @@ namespace paper
     class Document;
     class Path;
     class Item;
+    class DisplayList;
 
     class STICK_API RenderInterface
     {
@@ -23,6 +24,12 @@ namespace paper
 
         stick::Error draw();
 
+        //replays a recorded display list instead of traversing the document. This only reads
+        //the list and the paths it references, so it may run on another thread as long as
+        //neither the document nor the list are modified at the same time.
+        stick::Error draw(const DisplayList & _list);
+
+        //implementations need to call these so that items outside of the viewport can be culled
         virtual void setViewport(Float _x, Float _y,
                                  Float _widthInPixels, Float _heightInPixels) = 0;
 
@@ -30,11 +37,19 @@ namespace paper
 
         virtual void reserveItems(stick::Size _count) = 0;
 
+        //the number of items the last draw skipped because their stroke bounds are outside
+        //of the viewport. A culled group or placed symbol counts as a single item, when
+        //drawing a display list every culled path and clipping scope counts.
+        stick::Size culledItemCount() const;
+
+        //the number of paths the last draw passed to drawPath.
+        stick::Size drawnPathCount() const;
+
 
     protected:
 
         //these have to be implemented
-        virtual stick::Error drawPath(Path _path, const Mat3f & _transform) = 0;
+        virtual stick::Error drawPath(Path _path, const Mat3f & _transform, const PathStyle & _style) = 0;
         virtual stick::Error beginClipping(Path _clippingPath, const Mat3f & _transform) = 0;
         virtual stick::Error endClipping() = 0;
 
@@ -46,6 +61,24 @@ namespace paper
         stick::Error drawItem(Item _item, const Mat3f * _transform);
 
         Document m_document;
+
+
+    private:
+
+        void beginFrame();
+
+        bool isCulled(const Item & _item, const Mat3f * _transform);
+
+        bool isCulled(const Rect & _bounds);
+
+        Vec2f m_viewportSize;
+        bool m_bHasProjection;
+        Mat4f m_projection;
+        //brings document coordinates to the space of m_cullingRect
+        Mat3f m_cullingTransform;
+        Rect m_cullingRect;
+        stick::Size m_culledItemCount;
+        stick::Size m_drawnPathCount;
     };
 }
 
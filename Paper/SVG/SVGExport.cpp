@@ -32,19 +32,19 @@ namespace paper
             return String::concat(toString(_p.x), ",", toString(_p.y));
         }
 
-        static void addCurveToPathData(const Curve & _curve, String & _currentData, bool _bApplyTransform)
+        static void addCurveToPathData(const SegmentArray & _segs, Size _a, Size _b, String & _currentData, const Mat3f * _transform)
         {
-            if (_curve.isLinear())
-            {
-                Vec2f stp = _curve.segmentTwo().position();
-                Vec2f sop = _curve.segmentOne().position();
+            Vec2f sop = _segs.positions[_a];
+            Vec2f stp = _segs.positions[_b];
+            bool bIsLinear = crunch::isClose(_segs.handlesOut[_a], Vec2f(0)) && crunch::isClose(_segs.handlesIn[_b], Vec2f(0));
 
+            if (bIsLinear)
+            {
                 //this happens if the curve is part of a compound path
-                if (_bApplyTransform)
+                if (_transform)
                 {
-                    Mat3f transform = _curve.path().transform();
-                    stp = transform * stp;
-                    sop = transform * sop;
+                    stp = *_transform * stp;
+                    sop = *_transform * sop;
                 }
 
                 //relative line to
@@ -52,19 +52,16 @@ namespace paper
             }
             else
             {
-                Vec2f stp = _curve.segmentTwo().position();
-                Vec2f sop = _curve.segmentOne().position();
-                Vec2f ho = _curve.handleOneAbsolute();
-                Vec2f ht = _curve.handleTwoAbsolute();
+                Vec2f ho = sop + _segs.handlesOut[_a];
+                Vec2f ht = stp + _segs.handlesIn[_b];
 
                 //this happens if the curve is part of a compound path
-                if (_bApplyTransform)
+                if (_transform)
                 {
-                    Mat3f transform = _curve.path().transform();
-                    stp = transform * stp;
-                    sop = transform * sop;
-                    ho = transform * ho;
-                    ht = transform * ht;
+                    stp = *_transform * stp;
+                    sop = *_transform * sop;
+                    ho = *_transform * ho;
+                    ht = *_transform * ht;
                 }
 
                 //relative curve to
@@ -74,25 +71,29 @@ namespace paper
 
         static void addPathToPathData(const Path & _path, String & _currentData, bool _bIsCompoundPath)
         {
-            const auto & curves = _path.curveArray();
-            if (curves.count())
+            const SegmentArray & segs = _path.segmentArray();
+            if (segs.count() > 1)
             {
                 Mat3f transform = _path.transform();
                 //absolute move to
-                Vec2f to = curves[0]->segmentOne().position();
-                bool bApplyTransform = false;
+                Vec2f to = segs.positions[0];
+                const Mat3f * applyTransform = nullptr;
                 //for compound paths we need to transform the segment vertices directly
                 if (transform != Mat3f::identity() && _bIsCompoundPath)
                 {
-                    bApplyTransform = true;
+                    applyTransform = &transform;
                     to = transform * to;
                 }
                 _currentData.append(AppendVariadicFlag(), "M", toSVGPoint(to));
 
-                for (const auto & c : curves)
+                //iterate over the segment data directly instead of going through the curves
+                for (Size i = 1; i < segs.count(); ++i)
                 {
-                    addCurveToPathData(*c, _currentData, bApplyTransform);
+                    addCurveToPathData(segs, i - 1, i, _currentData, applyTransform);
                 }
+
+                if (_path.isClosed())
+                    addCurveToPathData(segs, segs.count() - 1, 0, _currentData, applyTransform);
             }
         }
 
@@ -218,14 +219,14 @@ namespace paper
                 {
                     String type = _path.isClosed() ? "polygon" : "polyline";
                     Shrub pathNode(type);
-                    SegmentArray::ConstIter it = _path.segmentArray().begin();
+                    const auto & positions = _path.segmentArray().positions;
                     String points;
-                    for (; it != _path.segmentArray().end(); ++it)
+                    for (auto it = positions.begin(); it != positions.end(); ++it)
                     {
-                        if (it != _path.segmentArray().end() - 1)
-                            points.append(AppendVariadicFlag(), toSVGPoint((*it)->position()), " ");
+                        if (it != positions.end() - 1)
+                            points.append(AppendVariadicFlag(), toSVGPoint(*it), " ");
                         else
-                            points.append(toSVGPoint((*it)->position()));
+                            points.append(toSVGPoint(*it));
                     }
 
                     pathNode.set("points", points, ValueHint::XMLAttribute);
@@ -236,11 +237,11 @@ namespace paper
                     if (_path.segmentArray().count() == 2)
                     {
                         Shrub pathNode("line");
-                        //pathNode.set("x1", String::concat(toSVGPoint(_path.segmentArray()[0]->position()), " ", toSVGPoint(_path.segmentArray()[1]->position())), ValueHint::XMLAttribute);
-                        pathNode.set("x1", toString(_path.segmentArray()[0]->position().x), ValueHint::XMLAttribute);
-                        pathNode.set("y1", toString(_path.segmentArray()[0]->position().y), ValueHint::XMLAttribute);
-                        pathNode.set("x2", toString(_path.segmentArray()[1]->position().x), ValueHint::XMLAttribute);
-                        pathNode.set("y2", toString(_path.segmentArray()[1]->position().y), ValueHint::XMLAttribute);
+                        const auto & positions = _path.segmentArray().positions;
+                        pathNode.set("x1", toString(positions[0].x), ValueHint::XMLAttribute);
+                        pathNode.set("y1", toString(positions[0].y), ValueHint::XMLAttribute);
+                        pathNode.set("x2", toString(positions[1].x), ValueHint::XMLAttribute);
+                        pathNode.set("y2", toString(positions[1].y), ValueHint::XMLAttribute);
                         _pn = &_parentTreeNode.append(pathNode);
                     }
                 }
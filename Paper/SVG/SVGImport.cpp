@@ -385,9 +385,11 @@ namespace paper
             else if (_name == "fill-opacity")
             {
                 _attr.fillColor.a = toFloat32(_value);
-                if (auto mf = _item.fill().maybe<ColorRGBA>())
+                const Paint & fill = _item.fill();
+                if (fill.is<ColorRGBA>())
                 {
-                    _item.setFill(ColorRGBA((*mf).r, (*mf).g, (*mf).b, (*mf).a));
+                    const ColorRGBA & col = fill.get<ColorRGBA>();
+                    _item.setFill(ColorRGBA(col.r, col.g, col.b, col.a));
                 }
             }
             else if (_name == "fill-rule")
@@ -420,9 +422,11 @@ namespace paper
             else if (_name == "stroke-opacity")
             {
                 _attr.strokeColor.a = toFloat32(_value);
-                if (auto mf = _item.stroke().maybe<ColorRGBA>())
+                const Paint & stroke = _item.stroke();
+                if (stroke.is<ColorRGBA>())
                 {
-                    _item.setStroke(ColorRGBA((*mf).r, (*mf).g, (*mf).b, _attr.strokeColor.a));
+                    const ColorRGBA & col = stroke.get<ColorRGBA>();
+                    _item.setStroke(ColorRGBA(col.r, col.g, col.b, _attr.strokeColor.a));
                 }
             }
             else if (_name == "stroke-width")
@@ -1134,14 +1138,15 @@ namespace paper
                         Float rads = crunch::toRadians(numbers[i + 2]);
                         currentPath.arcTo(last, Vec2f(numbers[i], numbers[i + 1]),
                                           crunch::toRadians(numbers[i + 2]), (bool)numbers[i + 4], (bool)numbers[i + 3]);
-                        lastHandle = currentPath.segmentArray().last()->handleOutAbsolute();
+                        lastHandle = currentPath.segment(currentPath.segmentCount() - 1).handleOutAbsolute();
                     }
                 }
                 else if (cmd == 'Z' || cmd == 'z')
                 {
                     currentPath.closePath();
-                    last = currentPath.segmentArray().last()->position();
-                    lastHandle = currentPath.segmentArray().last()->handleOutAbsolute();
+                    Segment lastSegment = currentPath.segment(currentPath.segmentCount() - 1);
+                    last = lastSegment.position();
+                    lastHandle = lastSegment.handleOutAbsolute();
                 }
                 else
                 {
@@ -1359,9 +1364,12 @@ namespace paper
                 numbers.reserve(64);
                 detail::parseNumbers((*mpoints).valueString().begin(), (*mpoints).valueString().end(), [](char) { return false; }, numbers);
                 Path ret = m_document->createPath();
-                for (Size i = 0; i < numbers.count(); i += 2)
                 {
-                    ret.addPoint(Vec2f(numbers[i], numbers[i + 1]));
+                    Path::Builder builder(ret, numbers.count() / 2);
+                    for (Size i = 0; i + 1 < numbers.count(); i += 2)
+                    {
+                        builder.addPoint(Vec2f(numbers[i], numbers[i + 1]));
+                    }
                 }
 
                 if (_bIsPolygon)
@@ -4,108 +4,86 @@
 
 namespace paper
 {
-    Segment::Segment(const Path & _path,
-                     const Vec2f & _pos,
-                     const Vec2f & _handleIn,
-                     const Vec2f & _handleOut,
-                     stick::Size _idx) :
+    Segment::Segment() :
+        m_index(0)
+    {
+    }
+
+    Segment::Segment(const Path & _path, stick::Size _idx) :
         m_path(_path),
-        m_position(_pos),
-        m_handleIn(_handleIn),
-        m_handleOut(_handleOut),
         m_index(_idx)
     {
     }
 
     void Segment::setPosition(const Vec2f & _pos)
     {
-        m_position = _pos;
-        m_path.segmentChanged(*this);
+        data().positions[m_index] = _pos;
+        m_path.segmentChanged(m_index);
     }
 
     void Segment::setHandleIn(const Vec2f & _pos)
     {
-        m_handleIn = _pos;
-        m_path.segmentChanged(*this);
+        data().handlesIn[m_index] = _pos;
+        m_path.segmentChanged(m_index);
     }
 
     void Segment::setHandleOut(const Vec2f & _pos)
     {
-        m_handleOut = _pos;
-        m_path.segmentChanged(*this);
+        data().handlesOut[m_index] = _pos;
+        m_path.segmentChanged(m_index);
     }
 
-    const Vec2f & Segment::position() const
+    Vec2f Segment::position() const
     {
-        return m_position;
+        return data().positions[m_index];
     }
 
-    const Vec2f & Segment::handleIn() const
+    Vec2f Segment::handleIn() const
     {
-        return m_handleIn;
+        return data().handlesIn[m_index];
     }
 
-    const Vec2f & Segment::handleOut() const
+    Vec2f Segment::handleOut() const
     {
-        return m_handleOut;
+        return data().handlesOut[m_index];
     }
 
     Vec2f Segment::handleInAbsolute() const
     {
-        return m_position + m_handleIn;
+        const SegmentArray & segs = data();
+        return segs.positions[m_index] + segs.handlesIn[m_index];
     }
 
     Vec2f Segment::handleOutAbsolute() const
     {
-        return m_position + m_handleOut;
-    }
-
-    const Curve * Segment::curveIn() const
-    {
-        return const_cast<Segment *>(this)->curveIn();
+        const SegmentArray & segs = data();
+        return segs.positions[m_index] + segs.handlesOut[m_index];
     }
 
-    Curve * Segment::curveIn()
+    Curve Segment::curveIn() const
     {
         if (m_index == 0)
         {
-            if (!m_path.isClosed())
-                return nullptr;
+            if (!m_path.isClosed() || !m_path.curveCount())
+                return Curve();
             else
-                return m_path.curveArray().last().get();
-        }
-        else
-        {
-            return m_path.curveArray()[m_index - 1].get();
+                return Curve(m_path, m_path.curveCount() - 1);
         }
-        return nullptr;
+        return Curve(m_path, m_index - 1);
     }
 
-    const Curve * Segment::curveOut() const
+    Curve Segment::curveOut() const
     {
-        return const_cast<Segment *>(this)->curveOut();
-    }
-
-    Curve * Segment::curveOut()
-    {
-        if (m_index == m_path.segmentArray().count() - 1)
-        {
-            if (!m_path.isClosed())
-                return nullptr;
-            else
-                return m_path.curveArray().last().get();
-        }
-        else
-        {
-            return m_path.curveArray()[m_index].get();
-        }
-        return nullptr;
+        if (m_index == data().count() - 1 && !m_path.isClosed())
+            return Curve();
+        return Curve(m_path, m_index);
     }
 
     bool Segment::isLinear() const
     {
-        if (crunch::isClose(m_handleIn, crunch::Vec2f(0.0), detail::PaperConstants::tolerance()) &&
-                crunch::isClose(m_handleOut, crunch::Vec2f(0.0), detail::PaperConstants::tolerance()))
+        const SegmentArray & segs = data();
+        if (crunch::isClose(segs.handlesIn[m_index], crunch::Vec2f(0.0), detail::PaperConstants::tolerance()) &&
+                crunch::isClose(segs.handlesOut[m_index], crunch::Vec2f(0.0), detail::PaperConstants::tolerance()))
             return true;
 
         return false;
@@ -116,54 +94,33 @@ namespace paper
         m_path.removeSegment(m_index);
     }
 
-    void Segment::transform(const Mat3f & _transform)
-    {
-        //@TODO remove all of these isnan asserts eventually? :D
-        STICK_ASSERT(!std::isnan(m_handleIn.x));
-        STICK_ASSERT(!std::isnan(m_handleIn.y));
-        STICK_ASSERT(!std::isnan(m_handleOut.x));
-        STICK_ASSERT(!std::isnan(m_handleOut.y));
-        STICK_ASSERT(!std::isnan(m_position.x));
-        STICK_ASSERT(!std::isnan(m_position.y));
-
-        STICK_ASSERT(!std::isnan(_transform.element(0, 0)));
-        STICK_ASSERT(!std::isnan(_transform.element(0, 1)));
-        STICK_ASSERT(!std::isnan(_transform.element(0, 2)));
-
-        STICK_ASSERT(!std::isnan(_transform.element(1, 0)));
-        STICK_ASSERT(!std::isnan(_transform.element(1, 1)));
-        STICK_ASSERT(!std::isnan(_transform.element(1, 2)));
-
-        STICK_ASSERT(!std::isnan(_transform.element(2, 0)));
-        STICK_ASSERT(!std::isnan(_transform.element(2, 1)));
-        STICK_ASSERT(!std::isnan(_transform.element(2, 2)));
-
-        m_handleIn = _transform * (m_position + m_handleIn);
-        m_handleOut = _transform * (m_position + m_handleOut);
-
-        STICK_ASSERT(!std::isnan(m_handleIn.x));
-        STICK_ASSERT(!std::isnan(m_handleIn.y));
-        STICK_ASSERT(!std::isnan(m_handleOut.x));
-        STICK_ASSERT(!std::isnan(m_handleOut.y));
-        STICK_ASSERT(!std::isnan(m_position.x));
-        STICK_ASSERT(!std::isnan(m_position.y));
-
-        m_position = _transform * m_position;
-        m_handleIn -= m_position;
-        m_handleOut -= m_position;
-
-        STICK_ASSERT(!std::isnan(m_handleIn.x));
-        STICK_ASSERT(!std::isnan(m_handleIn.y));
-        STICK_ASSERT(!std::isnan(m_handleOut.x));
-        STICK_ASSERT(!std::isnan(m_handleOut.y));
-        STICK_ASSERT(!std::isnan(m_position.x));
-        STICK_ASSERT(!std::isnan(m_position.y));
-
-        Curve * cin = curveIn();
-        Curve * cout = curveOut();
-        if (cin)
-            cin->markDirty();
-        if (cout)
-            cout->markDirty();
+    stick::Size Segment::index() const
+    {
+        return m_index;
+    }
+
+    Path Segment::path() const
+    {
+        return m_path;
+    }
+
+    bool Segment::isValid() const
+    {
+        return m_path.isValid() && m_index < data().count();
+    }
+
+    Segment::operator bool() const
+    {
+        return isValid();
+    }
+
+    const SegmentArray & Segment::data() const
+    {
+        return m_path.segmentArray();
+    }
+
+    SegmentArray & Segment::data()
+    {
+        return m_path.segmentArray();
     }
 }
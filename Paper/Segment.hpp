@@ -8,14 +8,20 @@ namespace paper
     class Path;
     class Curve;
 
+    //Segment is a lightweight view into the segment storage of a path.
+    //It does not own any data and is only valid as long as the path has
+    //at least _idx + 1 segments. Inserting or removing segments shifts
+    //the data a view refers to, just like an index would.
     class STICK_API Segment
     {
         friend class Path;
         friend class Curve;
-        
+
     public:
-        
-        Segment(const Path & _path, const Vec2f & _pos, const Vec2f & _handleIn, const Vec2f & _handleOut, stick::Size _idx);
+
+        Segment();
+
+        Segment(const Path & _path, stick::Size _idx);
 
         void setPosition(const Vec2f & _pos);
 
@@ -23,38 +29,43 @@ namespace paper
 
         void setHandleOut(const Vec2f & _pos);
 
-        const Vec2f & position() const;
+        Vec2f position() const;
 
-        const Vec2f & handleIn() const;
+        Vec2f handleIn() const;
 
-        const Vec2f & handleOut() const;
+        Vec2f handleOut() const;
 
         Vec2f handleInAbsolute() const;
-            
-        Vec2f handleOutAbsolute() const;
-
-        Curve * curveIn();
 
-        const Curve * curveIn() const;
+        Vec2f handleOutAbsolute() const;
 
-        Curve * curveOut();
+        //returns an invalid curve if the segment has no incoming curve
+        Curve curveIn() const;
 
-        const Curve * curveOut() const;
+        //returns an invalid curve if the segment has no outgoing curve
+        Curve curveOut() const;
 
         bool isLinear() const;
 
         void remove();
 
+        stick::Size index() const;
+
+        Path path() const;
+
+        bool isValid() const;
+
+        explicit operator bool() const;
+
 
     private:
 
-        void transform(const Mat3f & _transform);
+        const SegmentArray & data() const;
+
+        SegmentArray & data();
 
 
         Path m_path;
-        Vec2f m_position;
-        Vec2f m_handleIn;
-        Vec2f m_handleOut;
         stick::Size m_index;
     };
 }
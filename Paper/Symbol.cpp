@@ -15,12 +15,13 @@ namespace paper
         STICK_ASSERT(hasComponent<comps::Doc>());
         Document doc = get<comps::Doc>();
         PlacedSymbol ret = brick::reinterpretEntity<PlacedSymbol>(doc.hub().createEntity());
+        ret.set<comps::Doc>(doc);
         ret.set<comps::ReferencedSymbol>(*this);
         ret.set<comps::ItemType>(EntityType::PlacedSymbol);
-        ret.set<comps::StrokeBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
-        ret.set<comps::Bounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
-        ret.set<comps::LocalBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
-        ret.set<comps::HandleBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0)});
+        ret.set<comps::StrokeBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        ret.set<comps::Bounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        ret.set<comps::LocalBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
+        ret.set<comps::HandleBounds>(comps::BoundsData{true, Rect(0, 0, 0, 0), 0});
 
         if (!hasComponent<comps::PlacedSymbols>())
             set<comps::PlacedSymbols>(PlacedSymbolArray());
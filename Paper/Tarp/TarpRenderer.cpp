@@ -23,6 +23,16 @@ namespace paper
                 tpSegmentArray tmpSegmentBuffer;
             };
 
+            struct TarpContour
+            {
+                //the path the contour was built from and the highest geometry and transform
+                //version it depended on
+                Item item;
+                UInt64 version;
+            };
+
+            using TarpContourArray = stick::DynamicArray<TarpContour>;
+
             struct TarpRenderData
             {
                 TarpRenderData()
@@ -36,6 +46,7 @@ namespace paper
                 }
 
                 tpPath path;
+                TarpContourArray contours;
             };
 
             struct TarpGradientData
@@ -120,11 +131,13 @@ namespace paper
 
         void TarpRenderer::setViewport(Float _x, Float _y, Float _widthInPixels, Float _heightInPixels)
         {
+            RenderInterface::setViewport(_x, _y, _widthInPixels, _heightInPixels);
             m_viewport = Rect(_x, _y, _x + _widthInPixels, _y + _heightInPixels);
         }
 
         void TarpRenderer::setProjection(const Mat4f & _projection)
         {
+            RenderInterface::setProjection(_projection);
             tpSetProjection(m_tarp->ctx, (const tpMat4 *)&_projection);
         }
 
@@ -148,16 +161,19 @@ namespace paper
         static void toTarpSegments(tpSegmentArray & _tmpData, Path _path, const Mat3f * _transform)
         {
             _tmpData.clear();
+            const SegmentArray & segs = _path.segmentArray();
+            _tmpData.reserve(segs.count());
             if (!_transform)
             {
-                for (auto & seg : _path.segments())
+                for (Size i = 0; i < segs.count(); ++i)
                 {
-                    Vec2f hi = seg.handleInAbsolute();
-                    Vec2f ho = seg.handleOutAbsolute();
+                    const Vec2f & pos = segs.positions[i];
+                    Vec2f hi = pos + segs.handlesIn[i];
+                    Vec2f ho = pos + segs.handlesOut[i];
                     _tmpData.append((tpSegment)
                     {
                         {hi.x, hi.y},
-                        {seg.position().x, seg.position().y},
+                        {pos.x, pos.y},
                         {ho.x, ho.y}
                     });
                 }
@@ -166,11 +182,12 @@ namespace paper
             {
                 //tarp does not support per contour transforms, so we need to bring child paths segments
                 //to path space before adding it as a contour!
-                for (auto & seg : _path.segments())
+                for (Size i = 0; i < segs.count(); ++i)
                 {
-                    Vec2f hi = *_transform * seg.handleInAbsolute();
-                    Vec2f pos = *_transform * seg.position();
-                    Vec2f ho = *_transform * seg.handleOutAbsolute();
+                    const Vec2f & p = segs.positions[i];
+                    Vec2f hi = *_transform * (p + segs.handlesIn[i]);
+                    Vec2f pos = *_transform * p;
+                    Vec2f ho = *_transform * (p + segs.handlesOut[i]);
                     _tmpData.append((tpSegment)
                     {
                         {hi.x, hi.y},
@@ -181,14 +198,24 @@ namespace paper
             }
         }
 
-        static void recursivelyUpdateTarpPath(tpSegmentArray & _tmpData, Path _path, tpPath _tarpPath, const Mat3f * _transform, UInt32 & _contourIndex)
+        static void recursivelyUpdateTarpPath(tpSegmentArray & _tmpData, Path _path, detail::TarpRenderData & _rd,
+                                              const Mat3f * _transform, UInt64 _transformVersion, UInt32 & _contourIndex)
         {
-            if (_path.hasComponent<paper::comps::FillGeometryDirtyFlag>())
+            //the contours of child paths depend on their transforms, too. Comparing versions
+            //(instead of consuming the dirty flags) leaves the document untouched, so other
+            //caches can observe the same changes.
+            UInt64 version = std::max(_path.geometryVersion(), _transformVersion);
+            if (_contourIndex >= _rd.contours.count())
+                _rd.contours.append((detail::TarpContour) {Item(), 0});
+
+            detail::TarpContour & contour = _rd.contours[_contourIndex];
+            if (contour.item != _path || contour.version != version)
             {
-                _path.removeComponent<paper::comps::FillGeometryDirtyFlag>();
+                contour.item = _path;
+                contour.version = version;
 
                 toTarpSegments(_tmpData, _path, _transform);
-                tpPathSetContour(_tarpPath, _contourIndex, &_tmpData[0], _tmpData.count(), (tpBool)_path.isClosed());
+                tpPathSetContour(_rd.path, _contourIndex, &_tmpData[0], _tmpData.count(), (tpBool)_path.isClosed());
             }
 
             _contourIndex += 1;
@@ -213,23 +240,24 @@ namespace paper
                     }
                 }
 
-                recursivelyUpdateTarpPath(_tmpData, p, _tarpPath, t, _contourIndex);
+                recursivelyUpdateTarpPath(_tmpData, p, _rd, t, std::max(_transformVersion, p.transformVersion()), _contourIndex);
             }
         }
 
-        static void updateTarpPath(tpSegmentArray & _tmpData, Path _path, tpPath _tarpPath, const Mat3f * _transform)
+        static void updateTarpPath(tpSegmentArray & _tmpData, Path _path, detail::TarpRenderData & _rd, const Mat3f * _transform)
         {
             UInt32 contourIndex = 0;
-            recursivelyUpdateTarpPath(_tmpData, _path, _tarpPath, _transform, contourIndex);
+            recursivelyUpdateTarpPath(_tmpData, _path, _rd, _transform, 0, contourIndex);
 
             // remove contours that are not used anymore
-            if (contourIndex < tpPathContourCount(_tarpPath))
+            if (contourIndex < tpPathContourCount(_rd.path))
             {
-                for (Size i = tpPathContourCount(_tarpPath) - 1; i >= contourIndex; --i)
+                for (Size i = tpPathContourCount(_rd.path) - 1; i >= contourIndex; --i)
                 {
-                    tpPathRemoveContour(_tarpPath, i);
+                    tpPathRemoveContour(_rd.path, i);
                 }
             }
+            _rd.contours.resize(contourIndex);
         }
 
         static detail::TarpGradientData & updateTarpGradient(BaseGradient _grad)
@@ -258,19 +286,19 @@ namespace paper
             return gd;
         }
 
-        Error TarpRenderer::drawPath(Path _path, const Mat3f & _transform)
+        Error TarpRenderer::drawPath(Path _path, const Mat3f & _transform, const PathStyle & _style)
         {
             detail::TarpRenderData & rd = ensureRenderData(_path);
 
-            if (_path.fill().is<ColorRGBA>())
+            if (_style.fill.is<ColorRGBA>())
             {
-                ColorRGBA & col = _path.fill().get<ColorRGBA>();
+                const ColorRGBA & col = _style.fill.get<ColorRGBA>();
                 tpStyleSetFillColor(m_tarp->style, col.r, col.g, col.b, col.a);
-                tpStyleSetFillRule(m_tarp->style, _path.windingRule() == WindingRule::NonZero ? kTpFillRuleNonZero : kTpFillRuleEvenOdd);
+                tpStyleSetFillRule(m_tarp->style, _style.windingRule == WindingRule::NonZero ? kTpFillRuleNonZero : kTpFillRuleEvenOdd);
             }
-            else if (_path.fill().is<LinearGradient>())
+            else if (_style.fill.is<LinearGradient>())
             {
-                detail::TarpGradientData & gd = updateTarpGradient(_path.fill().get<LinearGradient>());
+                detail::TarpGradientData & gd = updateTarpGradient(_style.fill.get<LinearGradient>());
                 tpStyleSetFillGradient(m_tarp->style, gd.gradient);
             }
             else
@@ -278,23 +306,23 @@ namespace paper
                 tpStyleRemoveFill(m_tarp->style);
             }
 
-            if (!_path.stroke().is<NoPaint>())
+            if (!_style.stroke.is<NoPaint>())
             {
-                tpStyleSetStrokeWidth(m_tarp->style, _path.strokeWidth());
-                if (_path.stroke().is<ColorRGBA>())
+                tpStyleSetStrokeWidth(m_tarp->style, _style.strokeWidth);
+                if (_style.stroke.is<ColorRGBA>())
                 {
-                    ColorRGBA & col = _path.stroke().get<ColorRGBA>();
+                    const ColorRGBA & col = _style.stroke.get<ColorRGBA>();
                     tpStyleSetStrokeColor(m_tarp->style, col.r, col.g, col.b, col.a);
                 }
-                else if (_path.stroke().is<LinearGradient>())
+                else if (_style.stroke.is<LinearGradient>())
                 {
-                    detail::TarpGradientData & gd = updateTarpGradient(_path.stroke().get<LinearGradient>());
+                    detail::TarpGradientData & gd = updateTarpGradient(_style.stroke.get<LinearGradient>());
                     tpStyleSetStrokeGradient(m_tarp->style, gd.gradient);
                 }
 
-                tpStyleSetMiterLimit(m_tarp->style, _path.miterLimit());
+                tpStyleSetMiterLimit(m_tarp->style, _style.miterLimit);
 
-                switch (_path.strokeJoin())
+                switch (_style.join)
                 {
                     case StrokeJoin::Round:
                         tpStyleSetStrokeJoin(m_tarp->style, kTpStrokeJoinRound);
@@ -308,7 +336,7 @@ namespace paper
                         break;
                 }
 
-                switch (_path.strokeCap())
+                switch (_style.cap)
                 {
                     case StrokeCap::Round:
                         tpStyleSetStrokeCap(m_tarp->style, kTpStrokeCapRound);
@@ -322,11 +350,11 @@ namespace paper
                         break;
                 }
 
-                auto & da = _path.dashArray();
+                auto & da = _style.dashArray;
                 if (da.count())
                 {
                     tpStyleSetDashArray(m_tarp->style, &da[0], da.count());
-                    tpStyleSetDashOffset(m_tarp->style, _path.dashOffset());
+                    tpStyleSetDashOffset(m_tarp->style, _style.dashOffset);
                 }
                 else
                 {
@@ -340,7 +368,7 @@ namespace paper
 
             // tpPathClear(rd.path);
             // recursivelyAddContours(m_tarp->tmpSegmentBuffer, _path, rd.path, nullptr);
-            updateTarpPath(m_tarp->tmpSegmentBuffer, _path, rd.path, nullptr);
+            updateTarpPath(m_tarp->tmpSegmentBuffer, _path, rd, nullptr);
 
             // printf("%f", _transform[0][0]);
 
@@ -358,7 +386,7 @@ namespace paper
         {
             detail::TarpRenderData & rd = ensureRenderData(_clippingPath);
 
-            updateTarpPath(m_tarp->tmpSegmentBuffer, _clippingPath, rd.path, nullptr);
+            updateTarpPath(m_tarp->tmpSegmentBuffer, _clippingPath, rd, nullptr);
 
             tpTransform trans = tpTransformMake(_transform[0][0], _transform[1][0], _transform[2][0],
                                                 _transform[0][1], _transform[1][1], _transform[2][1]);
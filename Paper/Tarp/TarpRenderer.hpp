@@ -29,7 +29,7 @@ namespace paper
 
             void reserveItems(stick::Size _count) final;
 
-            stick::Error drawPath(Path _path, const Mat3f & _transform) final;
+            stick::Error drawPath(Path _path, const Mat3f & _transform, const PathStyle & _style) final;
 
             stick::Error beginClipping(Path _clippingPath, const Mat3f & _transform) final;
 
@@ -1,8 +1,12 @@
 //#include <Paper/Components.hpp>
 #include <Paper/Document.hpp>
+#include <Paper/DisplayList.hpp>
 #include <Paper/Private/Allocator.hpp>
+#include <Paper/Private/BooleanOperations.hpp>
+#include <Paper/Private/ThreadPool.hpp>
 #include <Paper/Path.hpp>
 #include <Paper/CurveLocation.hpp>
+#include <Paper/Raster/RasterRenderer.hpp>
 #include <Stick/Test.hpp>
 #include <Crunch/StringConversion.hpp>
 // #include <Paper/Private/ContainerView.hpp>
@@ -81,22 +85,23 @@ const Suite spec[] =
         p.addPoint(Vec2f(100.0f, 30.0f));
         p.addPoint(Vec2f(200.0f, 30.0f));
         EXPECT(p.segmentArray().count() == 2);
-        EXPECT(p.segmentArray()[0]->position() == Vec2f(100.0f, 30.0f));
-        EXPECT(p.segmentArray()[1]->position() == Vec2f(200.0f, 30.0f));
+        EXPECT(p.segment(0).position() == Vec2f(100.0f, 30.0f));
+        EXPECT(p.segment(1).position() == Vec2f(200.0f, 30.0f));
         EXPECT(p.isPolygon());
 
-        // using SegmentView =  paper::detail::ContainerView<stick::DynamicArray<stick::UniquePtr<Segment>>, Segment>;
-        // SegmentView view(p.segmentArray().begin(), p.segmentArray().end());
-        // for(const Segment & seg : view)
-        // {
-        //     printf("Segment pos: %s\n", crunch::toString(seg.position()).cString());
-        // }
+        Size segIdx = 0;
+        for (const Segment & seg : p.segments())
+        {
+            EXPECT(seg.index() == segIdx);
+            EXPECT(seg.position() == p.segmentArray().positions[segIdx++]);
+        }
+        EXPECT(segIdx == 2);
 
         p.addSegment(Vec2f(150.0f, 150.0f), Vec2f(-5.0f, -3.0f), Vec2f(5.0f, 3.0f));
         EXPECT(p.segmentArray().count() == 3);
-        EXPECT(p.segmentArray()[2]->position() == Vec2f(150.0f, 150.0f));
-        EXPECT(p.segmentArray()[2]->handleIn() == Vec2f(-5.0f, -3.0f));
-        EXPECT(p.segmentArray()[2]->handleOut() == Vec2f(5.0f, 3.0f));
+        EXPECT(p.segment(2).position() == Vec2f(150.0f, 150.0f));
+        EXPECT(p.segment(2).handleIn() == Vec2f(-5.0f, -3.0f));
+        EXPECT(p.segment(2).handleOut() == Vec2f(5.0f, 3.0f));
 
         EXPECT(p.curveArray().count() == 2);
         EXPECT(!p.isPolygon());
@@ -119,15 +124,15 @@ const Suite spec[] =
         p.closePath();
         EXPECT(p.isClosed());
         EXPECT(p.curveArray().count() == 3);
-        EXPECT(p.curveArray().last()->positionOne() == Vec2f(150.0f, 150.0f));
-        EXPECT(p.curveArray().last()->handleOne() == Vec2f(5.0f, 3.0f));
-        EXPECT(p.curveArray().last()->positionTwo() == Vec2f(100.0f, 30.0f));
+        EXPECT(p.curve(p.curveCount() - 1).positionOne() == Vec2f(150.0f, 150.0f));
+        EXPECT(p.curve(p.curveCount() - 1).handleOne() == Vec2f(5.0f, 3.0f));
+        EXPECT(p.curve(p.curveCount() - 1).positionTwo() == Vec2f(100.0f, 30.0f));
 
         //test insertion
         p.insertSegment(1, Vec2f(100, 75.0));
-        EXPECT(p.segmentArray()[0]->position() == Vec2f(100.0f, 30.0f));
-        EXPECT(p.segmentArray()[1]->position() == Vec2f(100.0f, 75.0f));
-        EXPECT(p.segmentArray()[2]->position() == Vec2f(200.0f, 30.0f));
+        EXPECT(p.segment(0).position() == Vec2f(100.0f, 30.0f));
+        EXPECT(p.segment(1).position() == Vec2f(100.0f, 75.0f));
+        EXPECT(p.segment(2).position() == Vec2f(200.0f, 30.0f));
 
         EXPECT(p.curveArray().count() == 4);
         stick::DynamicArray<Vec2f> expectedCurves2 =
@@ -146,6 +151,64 @@ const Suite spec[] =
             EXPECT(c.positionTwo() == expectedCurves2[i++]);
         }
 
+        //changing a segment through its view updates the adjacent curves
+        Segment seg = p.segment(1);
+        EXPECT(seg.curveIn() == p.curve(0));
+        EXPECT(seg.curveOut() == p.curve(1));
+        EXPECT(p.segment(0).curveIn() == p.curve(3));
+        EXPECT(crunch::isClose(p.curve(0).length(), 45.0f));
+        seg.setPosition(Vec2f(100.0f, 80.0f));
+        EXPECT(crunch::isClose(p.curve(0).length(), 50.0f));
+        seg.setHandleOut(Vec2f(10.0f, 0.0f));
+        EXPECT(p.segmentArray().positions[1] == Vec2f(100.0f, 80.0f));
+        EXPECT(p.curve(0).positionTwo() == Vec2f(100.0f, 80.0f));
+        EXPECT(p.curve(0).bezier().positionTwo() == Vec2f(100.0f, 80.0f));
+        EXPECT(p.curve(1).positionOne() == Vec2f(100.0f, 80.0f));
+        EXPECT(p.curve(1).bezier().handleOne() == Vec2f(110.0f, 80.0f));
+
+        //reversing swaps the handles
+        p.reverse();
+        EXPECT(p.segment(0).position() == Vec2f(150.0f, 150.0f));
+        EXPECT(p.segment(0).handleIn() == Vec2f(5.0f, 3.0f));
+        EXPECT(p.segment(0).handleOut() == Vec2f(-5.0f, -3.0f));
+        EXPECT(p.segment(2).handleIn() == Vec2f(10.0f, 0.0f));
+        EXPECT(p.curveArray().count() == 4);
+
+        //batch construction
+        Vec2f positions[] = {Vec2f(0.0f, 0.0f), Vec2f(100.0f, 0.0f), Vec2f(100.0f, 100.0f)};
+        Vec2f handles[] = {Vec2f(1.0f, 0.0f), Vec2f(2.0f, 0.0f), Vec2f(3.0f, 0.0f)};
+        Path p2 = doc.createPath();
+        p2.addSegments(positions, 3);
+        EXPECT(p2.segmentCount() == 3);
+        EXPECT(p2.curveCount() == 2);
+        EXPECT(p2.segment(2).handleIn() == Vec2f(0.0f));
+        EXPECT(isClose(p2.length(), 200.0f));
+        EXPECT(isClose(p2.bounds().max(), Vec2f(100.0f)));
+        p2.closePath();
+        p2.addSegments(positions, handles, handles, 2);
+        EXPECT(p2.segmentCount() == 5);
+        EXPECT(p2.curveCount() == 5);
+        EXPECT(p2.segment(4).handleOut() == Vec2f(2.0f, 0.0f));
+        EXPECT(p2.curve(2).positionTwo() == Vec2f(0.0f, 0.0f));
+        EXPECT(p2.curve(4).positionTwo() == Vec2f(0.0f, 0.0f));
+        p2.setSegments(positions, 2);
+        EXPECT(p2.segmentCount() == 2);
+        EXPECT(p2.curveCount() == 2);
+        EXPECT(isClose(p2.length(), 200.0f));
+
+        Path p3 = doc.createPath();
+        p3.addPoint(Vec2f(0.0f, 0.0f));
+        EXPECT(isClose(p3.length(), 0.0f));
+        {
+            Path::Builder builder(p3, 2);
+            builder.addPoint(Vec2f(0.0f, 50.0f));
+            builder.addSegment(Vec2f(50.0f, 50.0f), Vec2f(-10.0f, 0.0f), Vec2f(0.0f));
+        }
+        EXPECT(p3.segmentCount() == 3);
+        EXPECT(p3.curveCount() == 2);
+        EXPECT(p3.curve(1).handleTwo() == Vec2f(-10.0f, 0.0f));
+        EXPECT(isClose(p3.length(), 100.0f));
+        EXPECT(isClose(p3.bounds().max(), Vec2f(50.0f)));
     },
     SUITE("Attribute Tests")
     {
@@ -170,6 +233,51 @@ const Suite spec[] =
         grp.removeFill();
         EXPECT(!child.hasFill());
         EXPECT(!grp.hasFill());
+
+        // resolved styles are cached, changes to parents and moving items invalidate them
+        Group outer = doc.createGroup();
+        outer.addChild(grp);
+        outer.setStrokeWidth(5.0f);
+        outer.setStrokeJoin(StrokeJoin::Round);
+        EXPECT(child.strokeWidth() == 5.0f);
+        EXPECT(&child.style() == &child.style());
+        outer.setStrokeWidth(7.0f);
+        EXPECT(child.strokeWidth() == 7.0f);
+        grp.setStrokeWidth(2.0f);
+        EXPECT(child.strokeWidth() == 2.0f);
+        EXPECT(child.strokeJoin() == StrokeJoin::Round);
+        Group other = doc.createGroup();
+        other.setFill(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+        other.addChild(child);
+        EXPECT(child.fill().get<ColorRGBA>() == ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+        EXPECT(child.strokeWidth() == 1.0f);
+        EXPECT(child.strokeJoin() == StrokeJoin::Miter);
+        child.insertAbove(grp);
+        EXPECT(child.strokeWidth() == 7.0f);
+        EXPECT(!child.hasFill());
+
+        // versions change with the data they describe and stay the same when reading it
+        child.addPoint(Vec2f(0, 0));
+        child.addPoint(Vec2f(100, 0));
+        stick::UInt64 geometryVersion = child.geometryVersion();
+        stick::UInt64 styleVersion = child.styleVersion();
+        stick::UInt64 transformVersion = child.transformVersion();
+        EXPECT(geometryVersion != 0);
+        child.bounds();
+        child.strokeWidth();
+        EXPECT(child.geometryVersion() == geometryVersion);
+        EXPECT(child.styleVersion() == styleVersion);
+        child.addPoint(Vec2f(100, 100));
+        EXPECT(child.geometryVersion() > geometryVersion);
+        EXPECT(child.styleVersion() == styleVersion);
+        child.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        EXPECT(child.styleVersion() > styleVersion);
+        styleVersion = child.styleVersion();
+        outer.setStrokeWidth(3.0f);
+        EXPECT(child.styleVersion() > styleVersion);
+        EXPECT(child.transformVersion() == transformVersion);
+        child.translateTransform(Vec2f(10, 0));
+        EXPECT(child.transformVersion() > transformVersion);
     },
     SUITE("Path Length Tests")
     {
@@ -179,6 +287,20 @@ const Suite spec[] =
         p.addPoint(Vec2f(200.0f, 0.0f));
         p.addPoint(Vec2f(200.0f, 200.0f));
         EXPECT(isClose(p.length(), 400.0f));
+        EXPECT(isClose(p.positionAt(100.0f), Vec2f(100.0f, 0.0f)));
+        EXPECT(isClose(p.positionAt(300.0f), Vec2f(200.0f, 100.0f)));
+        EXPECT(isClose(p.curveLocationAt(250.0f).offset(), 250.0f));
+        EXPECT(isClose(p.curve(1).pathOffset(), 200.0f));
+
+        //changing and inserting segments updates the offsets of the following curves
+        p.segment(0).setPosition(Vec2f(100.0f, 0.0f));
+        EXPECT(isClose(p.curve(1).pathOffset(), 100.0f));
+        EXPECT(isClose(p.positionAt(150.0f), Vec2f(200.0f, 50.0f)));
+        p.insertSegment(0, Vec2f(100.0f, -50.0f));
+        EXPECT(isClose(p.curve(2).pathOffset(), 150.0f));
+        p.addPoint(Vec2f(200.0f, 300.0f));
+        EXPECT(isClose(p.length(), 450.0f));
+        EXPECT(isClose(p.positionAt(p.length() - 50.0f), Vec2f(200.0f, 250.0f)));
 
         Float rad = 100;
         Path p2 = doc.createCircle(Vec2f(0.0f, 0.0f), rad);
@@ -197,6 +319,25 @@ const Suite spec[] =
         EXPECT(p.isClockwise());
         p.reverse();
         EXPECT(!p.isClockwise());
+
+        // the cached area of a compound path follows changes to its children
+        Path outer = doc.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(100.0f, 100.0f));
+        outer.setWindingRule(WindingRule::NonZero);
+        Float outerArea = outer.area();
+        EXPECT(isClose(std::abs(outerArea), 10000.0f));
+        Path hole = doc.createRectangle(Vec2f(10.0f, 10.0f), Vec2f(20.0f, 20.0f));
+        outer.addChild(hole);
+        EXPECT(hole.isClockwise() != outer.isClockwise());
+        EXPECT(isClose(outer.area(), outerArea - outerArea / 100.0f));
+        Path hole2 = doc.createRectangle(Vec2f(30.0f, 30.0f), Vec2f(50.0f, 50.0f));
+        outer.addChild(hole2);
+        EXPECT(isClose(outer.area(), outerArea * 0.95f));
+        hole2.segment(2).setPosition(Vec2f(60.0f, 50.0f));
+        EXPECT(isClose(outer.area(), outerArea * 0.94f));
+        outer.setClockwise(!outer.isClockwise());
+        EXPECT(isClose(outer.area(), -outerArea * 0.94f));
+        hole.remove();
+        EXPECT(isClose(outer.area(), -outerArea * 0.95f));
     },
     SUITE("Path Bounds Tests")
     {
@@ -225,6 +366,47 @@ const Suite spec[] =
         EXPECT(isClose(strokeBounds.min(), Vec2f(-10.0f)));
         EXPECT(isClose(strokeBounds.width(), 220.0f));
         EXPECT(isClose(strokeBounds.height(), 220.0f));
+        EXPECT(isClose(p.handleBounds().min(), Vec2f(-10.0f)));
+        p.setStrokeWidth(40.0);
+        EXPECT(isClose(p.handleBounds().min(), Vec2f(-20.0f)));
+
+        //repeated edits without reading the bounds in between still reach all parents
+        Group outer = doc.createGroup();
+        Group inner = doc.createGroup();
+        outer.addChild(inner);
+        Path r = doc.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(10.0f, 10.0f));
+        inner.addChild(r);
+        EXPECT(isClose(outer.bounds().max(), Vec2f(10.0f, 10.0f)));
+        r.segment(2).setPosition(Vec2f(20.0f, 10.0f));
+        r.segment(2).setPosition(Vec2f(30.0f, 10.0f));
+        EXPECT(isClose(inner.localBounds().max(), Vec2f(30.0f, 10.0f)));
+        r.segment(2).setPosition(Vec2f(40.0f, 10.0f));
+        EXPECT(isClose(outer.bounds().max(), Vec2f(40.0f, 10.0f)));
+        EXPECT(isClose(inner.bounds().max(), Vec2f(40.0f, 10.0f)));
+
+        //parent bounds are marked once the outermost batch ends, or when they are read
+        doc.beginBatch();
+        r.segment(2).setPosition(Vec2f(50.0f, 10.0f));
+        doc.beginBatch();
+        r.segment(2).setPosition(Vec2f(60.0f, 10.0f));
+        doc.endBatch();
+        EXPECT(isClose(outer.bounds().max(), Vec2f(60.0f, 10.0f)));
+        r.segment(2).setPosition(Vec2f(70.0f, 20.0f));
+        EXPECT(isClose(r.bounds().max(), Vec2f(70.0f, 20.0f)));
+        doc.endBatch();
+        EXPECT(isClose(outer.bounds().max(), Vec2f(70.0f, 20.0f)));
+        EXPECT(isClose(inner.localBounds().max(), Vec2f(70.0f, 20.0f)));
+
+        //a batch only defers the edits of its own document
+        Document other = createDocument();
+        Group otherGroup = other.createGroup();
+        Path o = other.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(10.0f, 10.0f));
+        otherGroup.addChild(o);
+        EXPECT(isClose(otherGroup.bounds().max(), Vec2f(10.0f, 10.0f)));
+        doc.beginBatch();
+        o.segment(2).setPosition(Vec2f(20.0f, 10.0f));
+        EXPECT(isClose(otherGroup.bounds().max(), Vec2f(20.0f, 10.0f)));
+        EXPECT(doc.endBatch().count() == 0);
     },
     SUITE("Transformed Path Bounds Tests")
     {
@@ -263,6 +445,62 @@ const Suite spec[] =
         const Rect & bounds5 = p.strokeBounds();
         EXPECT(isClose(bounds5.width(), diagonal * 2 + 40.0f));
         EXPECT(isClose(bounds5.height(), diagonal * 2 + 40.0f));
+
+        //transforming a parent is picked up by all of its children
+        Group outer = doc.createGroup();
+        Group inner = doc.createGroup();
+        outer.addChild(inner);
+        Path r = doc.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(10.0f, 10.0f));
+        inner.addChild(r);
+        EXPECT(isClose(r.bounds().min(), Vec2f(0.0f, 0.0f)));
+        EXPECT(r.contains(Vec2f(5.0f, 5.0f)));
+        stick::UInt64 version = r.absoluteTransformVersion();
+        EXPECT(isClose(r.absoluteTranslation(), Vec2f(0.0f, 0.0f)));
+
+        outer.translateTransform(100.0f, 0.0f);
+        inner.translateTransform(0.0f, 50.0f);
+        EXPECT(r.absoluteTransformVersion() != version);
+        EXPECT(isClose(r.absoluteTransform() * Vec2f(0.0f, 0.0f), Vec2f(100.0f, 50.0f)));
+        EXPECT(isClose(r.absoluteTranslation(), Vec2f(100.0f, 50.0f)));
+        EXPECT(isClose(r.bounds().min(), Vec2f(100.0f, 50.0f)));
+        EXPECT(isClose(inner.bounds().min(), Vec2f(100.0f, 50.0f)));
+        EXPECT(r.contains(Vec2f(105.0f, 55.0f)));
+        EXPECT(!r.contains(Vec2f(5.0f, 5.0f)));
+
+        outer.scaleTransform(Vec2f(2.0f), Vec2f(100.0f, 0.0f));
+        EXPECT(isClose(r.bounds().max(), Vec2f(120.0f, 120.0f)));
+        EXPECT(isClose(r.absoluteScaling(), Vec2f(2.0f, 2.0f)));
+
+        //moving an item to a different parent, too
+        version = r.absoluteTransformVersion();
+        EXPECT(r.absoluteTransformVersion() == version);
+        doc.addChild(r);
+        EXPECT(r.absoluteTransformVersion() != version);
+        EXPECT(isClose(r.bounds().min(), Vec2f(0.0f, 0.0f)));
+        EXPECT(r.contains(Vec2f(5.0f, 5.0f)));
+        EXPECT(isClose(inner.bounds().min(), Vec2f(0.0f, 0.0f)));
+
+        //applying a transform bakes it into the segments of all paths in the subtree
+        Group grp = doc.createGroup();
+        Path wave = doc.createPath();
+        for (Size i = 0; i < 7; ++i)
+            wave.addSegment(Vec2f(i * 10.0f, 0.0f), Vec2f(-2.0f, -3.0f), Vec2f(2.0f, 3.0f));
+        grp.addChild(wave);
+        grp.addChild(doc.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(10.0f, 20.0f)));
+        Float length = wave.length();
+        grp.rotate(Constants<Float>::pi() * 0.5, Vec2f(0.0f, 0.0f));
+        grp.translate(Vec2f(5.0f, 0.0f));
+        for (Size i = 0; i < 7; ++i)
+        {
+            EXPECT(isClose(wave.segment(i).position(), Vec2f(5.0f, i * 10.0f)));
+            EXPECT(isClose(wave.segment(i).handleIn(), Vec2f(3.0f, -2.0f)));
+            EXPECT(isClose(wave.segment(i).handleOut(), Vec2f(-3.0f, 2.0f)));
+        }
+        EXPECT(isClose(wave.length(), length));
+        EXPECT(isClose(grp.bounds().min(), Vec2f(-15.0f, 0.0f)));
+        grp.scale(Vec2f(2.0f, 1.0f), Vec2f(0.0f, 0.0f));
+        EXPECT(isClose(wave.segment(6).handleOut(), Vec2f(-6.0f, 2.0f)));
+        EXPECT(isClose(grp.bounds().min(), Vec2f(-30.0f, 0.0f)));
     },
     SUITE("Clone Tests")
     {
@@ -285,8 +523,8 @@ const Suite spec[] =
         EXPECT(p2.parent() == grp);
         EXPECT(p2.segmentArray().count() == 2);
         EXPECT(p2.curveArray().count() == 1);
-        EXPECT(p2.segmentArray()[0]->position() == Vec2f(100.0f, 30.0f));
-        EXPECT(p2.segmentArray()[1]->position() == Vec2f(200.0f, 30.0f));
+        EXPECT(p2.segment(0).position() == Vec2f(100.0f, 30.0f));
+        EXPECT(p2.segment(1).position() == Vec2f(200.0f, 30.0f));
         p2.set<comps::Name>("p2");
 
         Group grp2 = grp.clone();
@@ -299,6 +537,234 @@ const Suite spec[] =
         EXPECT(doc.children().count() == 2);
         EXPECT(doc.children()[0] == grp);
         EXPECT(doc.children()[1] == grp2);
+
+        //cached geometry data carries over to the clone
+        Path c = doc.createCircle(Vec2f(100.0f, 100.0f), 50.0f);
+        Path hole = doc.createCircle(Vec2f(100.0f, 100.0f), 20.0f);
+        c.addChild(hole);
+        c.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        Rect cbounds = c.bounds();
+        Float carea = c.area();
+        Float clength = c.length();
+        Path c2 = c.clone();
+        EXPECT(!c2.get<comps::Bounds>().bDirty);
+        EXPECT(!c2.get<comps::PathArea>().bDirty);
+        EXPECT(c2.bounds() == cbounds);
+        EXPECT(isClose(c2.area(), carea));
+        EXPECT(isClose(c2.length(), clength));
+        EXPECT(c2.children().count() == 1);
+        EXPECT(c2.children()[0] != hole);
+        EXPECT(c2.children()[0].parent() == c2);
+        EXPECT(c2.contains(Vec2f(140.0f, 100.0f)));
+        EXPECT(!c2.contains(Vec2f(100.0f, 100.0f)));
+
+        //the clone is independent of the original
+        c2.translateTransform(200.0f, 0.0f);
+        EXPECT(c.bounds() == cbounds);
+        EXPECT(isClose(c2.bounds().min().x, cbounds.min().x + 200.0f));
+        EXPECT(doc.hitTest(Vec2f(340.0f, 100.0f)) == c2);
+
+        Symbol s = doc.createSymbol(doc.createCircle(Vec2f(0.0f), 10.0f));
+        PlacedSymbol ps = s.place(Vec2f(500.0f, 500.0f));
+        PlacedSymbol ps2 = ps.clone();
+        EXPECT(ps2.isValid());
+        EXPECT(ps2.symbol() == s);
+        EXPECT(ps2.parent() == doc);
+        EXPECT(s.get<comps::PlacedSymbols>().count() == 2);
+        EXPECT(ps2.absoluteTransform() == ps.absoluteTransform());
+
+        Document doc2 = doc.clone();
+        EXPECT(doc2 != doc);
+        EXPECT(!doc2.parent().isValid());
+        EXPECT(doc2.children().count() == doc.children().count());
+        EXPECT(doc2.children()[0].document() == doc2);
+        EXPECT(doc2.children()[0].children()[0].document() == doc2);
+        EXPECT(doc2.children()[0].get<comps::Name>() == "grp");
+        EXPECT(doc.children().count() == 6);
+        EXPECT(doc2.hitTest(Vec2f(340.0f, 100.0f)) != c2);
+        EXPECT(doc2.hitTest(Vec2f(340.0f, 100.0f)).isValid());
+    },
+    SUITE("Hit Test Tests")
+    {
+        Document doc = createDocument();
+        Path a = doc.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(100.0f, 100.0f));
+        a.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        Group grp = doc.createGroup();
+        Path b = doc.createRectangle(Vec2f(50.0f, 50.0f), Vec2f(150.0f, 150.0f));
+        b.setFill(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+        grp.addChild(b);
+        Path line = doc.createPath();
+        line.addPoint(Vec2f(300.0f, 0.0f));
+        line.addPoint(Vec2f(300.0f, 100.0f));
+        line.setStroke(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+        line.setStrokeWidth(4.0f);
+
+        EXPECT(doc.hitTest(Vec2f(25.0f, 25.0f)) == a);
+        EXPECT(doc.hitTest(Vec2f(75.0f, 75.0f)) == b);
+        EXPECT(doc.hitTest(Vec2f(125.0f, 125.0f)) == b);
+        EXPECT(!doc.hitTest(Vec2f(200.0f, 50.0f)).isValid());
+        EXPECT(doc.hitTest(Vec2f(301.0f, 50.0f)) == line);
+        EXPECT(!doc.hitTest(Vec2f(305.0f, 50.0f)).isValid());
+        EXPECT(doc.hitTest(Vec2f(305.0f, 50.0f), 5.0f) == line);
+
+        // changes have to be picked up by the index
+        a.sendToFront();
+        EXPECT(doc.hitTest(Vec2f(75.0f, 75.0f)) == a);
+        a.sendToBack();
+        EXPECT(doc.hitTest(Vec2f(75.0f, 75.0f)) == b);
+        a.sendToFront();
+        EXPECT(doc.hitTest(Vec2f(75.0f, 75.0f)) == a);
+        grp.translateTransform(1000.0f, 0.0f);
+        EXPECT(doc.hitTest(Vec2f(125.0f, 125.0f)) != b);
+        EXPECT(doc.hitTest(Vec2f(1125.0f, 125.0f)) == b);
+        a.setVisible(false);
+        EXPECT(!doc.hitTest(Vec2f(75.0f, 75.0f)).isValid());
+        a.setVisible(true);
+        b.segment(2).setPosition(Vec2f(250.0f, 250.0f));
+        EXPECT(doc.hitTest(Vec2f(1240.0f, 240.0f)) == b);
+
+        EXPECT(doc.itemsIntersecting(Rect(90.0f, 0.0f, 310.0f, 10.0f)).count() == 2);
+        EXPECT(doc.itemsContainedIn(Rect(-10.0f, -10.0f, 310.0f, 310.0f)).count() == 2);
+        EXPECT(doc.itemsContainedIn(Rect(-10.0f, -10.0f, 200.0f, 200.0f)).count() == 1);
+
+        grp.removeChild(b);
+        EXPECT(!doc.hitTest(Vec2f(1125.0f, 125.0f)).isValid());
+        line.remove();
+        EXPECT(!doc.hitTest(Vec2f(301.0f, 50.0f)).isValid());
+        EXPECT(doc.itemsIntersecting(Rect(-1000.0f, -1000.0f, 5000.0f, 5000.0f)).count() == 1);
+
+        // a larger set of items to exercise tree rebalancing
+        DynamicArray<Path> grid;
+        for (Int32 y = 0; y < 20; ++y)
+        {
+            for (Int32 x = 0; x < 20; ++x)
+            {
+                Path p = doc.createRectangle(Vec2f(x * 10.0f, 500.0f + y * 10.0f), Vec2f(x * 10.0f + 8.0f, 508.0f + y * 10.0f));
+                p.setFill(ColorRGBA(0.0f, 0.0f, 1.0f, 1.0f));
+                grid.append(p);
+            }
+        }
+        EXPECT(doc.hitTest(Vec2f(74.0f, 634.0f)) == grid[13 * 20 + 7]);
+        EXPECT(!doc.hitTest(Vec2f(79.0f, 634.0f)).isValid());
+        EXPECT(doc.itemsContainedIn(Rect(0.0f, 500.0f, 49.0f, 549.0f)).count() == 25);
+        for (Size i = 0; i < grid.count(); i += 2)
+            grid[i].remove();
+        EXPECT(doc.itemsIntersecting(Rect(0.0f, 500.0f, 200.0f, 700.0f)).count() == 200);
+        EXPECT(!doc.hitTest(Vec2f(4.0f, 504.0f)).isValid());
+        EXPECT(doc.hitTest(Vec2f(14.0f, 504.0f)) == grid[1]);
+
+        // placed symbols are only hit where their item is drawn
+        Path disc = doc.createCircle(Vec2f(5.0f, 0.0f), 10.0f);
+        disc.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        Symbol symbol = doc.createSymbol(disc);
+        PlacedSymbol placed = symbol.place(Vec2f(2000.0f, 2000.0f));
+        EXPECT(doc.hitTest(Vec2f(2005.0f, 2000.0f)) == placed);
+        EXPECT(!doc.hitTest(Vec2f(1996.0f, 1991.0f)).isValid());
+        placed.scaleTransform(Vec2f(2.0f), Vec2f(2000.0f, 2000.0f));
+        EXPECT(doc.hitTest(Vec2f(2025.0f, 2000.0f)) == placed);
+        EXPECT(!doc.hitTest(Vec2f(1992.0f, 1982.0f)).isValid());
+    },
+    SUITE("Contains Tests")
+    {
+        Document doc = createDocument();
+
+        //a star with enough edges for the mono curves to be indexed
+        DynamicArray<Vec2f> star;
+        Size count = 301;
+        for (Size i = 0; i < count; ++i)
+        {
+            Float a = Constants<Float>::twoPi() * i / count;
+            Float r = i % 2 ? 60.0f : 100.0f;
+            star.append(Vec2f(std::cos(a), std::sin(a)) * r);
+        }
+        Path p = doc.createPath();
+        p.addSegments(&star[0], star.count());
+        p.closePath();
+
+        //even odd crossing number as the reference
+        auto reference = [&](const Vec2f & _pt)
+        {
+            bool bInside = false;
+            for (Size i = 0, j = count - 1; i < count; j = i++)
+            {
+                const Vec2f & a = star[i];
+                const Vec2f & b = star[j];
+                if ((a.y > _pt.y) != (b.y > _pt.y) &&
+                        _pt.x < (b.x - a.x) * (_pt.y - a.y) / (b.y - a.y) + a.x)
+                    bInside = !bInside;
+            }
+            return bInside;
+        };
+
+        Size mismatches = 0;
+        for (Float y = -110.0f; y < 110.0f; y += 3.37f)
+        {
+            for (Float x = -110.0f; x < 110.0f; x += 3.71f)
+            {
+                if (p.contains(Vec2f(x, y)) != reference(Vec2f(x, y)))
+                    ++mismatches;
+            }
+        }
+        EXPECT(mismatches == 0);
+        EXPECT(paper::detail::monoCurves(p)[0].bPolygon);
+        EXPECT(p.contains(Vec2f(0.0f, 0.0f)));
+        EXPECT(p.contains(Vec2f(0.0f, -99.0f)) == reference(Vec2f(0.0f, -99.0f)));
+        EXPECT(!p.contains(Vec2f(0.0f, 101.0f)));
+
+        //the index is rebuilt when the path changes
+        p.translateTransform(500.0f, 0.0f);
+        EXPECT(p.contains(Vec2f(500.0f, 0.0f)));
+        EXPECT(!p.contains(Vec2f(0.0f, 0.0f)));
+        p.segment(0).setPosition(Vec2f(200.0f, 0.0f));
+        EXPECT(p.contains(Vec2f(680.0f, 0.0f)));
+
+        //curved loops and compound paths
+        Path c = doc.createCircle(Vec2f(0.0f, 0.0f), 100.0f);
+        c.flatten(0.5f);
+        Path bez = doc.createPath();
+        for (Size i = 0; i < 64; ++i)
+        {
+            Float a = Constants<Float>::twoPi() * i / 64;
+            bez.addSegment(Vec2f(std::cos(a), std::sin(a)) * 40.0f, Vec2f(3.0f, -5.0f), Vec2f(-3.0f, 5.0f));
+        }
+        bez.closePath();
+        c.addChild(bez);
+        EXPECT(paper::detail::monoCurves(c).count() == 2);
+        EXPECT(paper::detail::monoCurves(c)[0].bPolygon);
+        EXPECT(!paper::detail::monoCurves(c)[1].bPolygon);
+        EXPECT(c.contains(Vec2f(70.0f, 0.0f)));
+        EXPECT(c.contains(Vec2f(0.0f, -70.0f)));
+        EXPECT(!c.contains(Vec2f(0.0f, 0.0f)));
+        EXPECT(!c.contains(Vec2f(10.0f, 20.0f)));
+        EXPECT(!c.contains(Vec2f(110.0f, 0.0f)));
+
+        //batched queries give the same results as single ones
+        DynamicArray<Vec2f> points;
+        for (Float y = -120.0f; y < 120.0f; y += 4.13f)
+        {
+            for (Float x = -120.0f; x < 800.0f; x += 5.29f)
+                points.append(Vec2f(x, y));
+        }
+        points.append(Vec2f(70.0f, 0.0f));
+        for (Path q : {p, c})
+        {
+            DynamicArray<bool> results = q.contains(points);
+            EXPECT(results.count() == points.count());
+            mismatches = 0;
+            Size insideCount = 0;
+            for (Size i = 0; i < points.count(); ++i)
+            {
+                if (results[i] != q.contains(points[i]))
+                    ++mismatches;
+                insideCount += results[i];
+            }
+            EXPECT(mismatches == 0);
+            EXPECT(insideCount > 0);
+        }
+        bool single;
+        c.contains(&points.last(), 1, &single);
+        EXPECT(single);
+        EXPECT(!doc.createPath().contains(points)[0]);
     },
     SUITE("SVG Export Tests")
     {
@@ -325,9 +791,9 @@ const Suite spec[] =
             EXPECT(Item(svgdata.group().children()[0]).itemType() == EntityType::Path);
             Path p = reinterpretEntity<Path>(svgdata.group().children()[0]);
             EXPECT(p.segmentArray().count() == 3);
-            EXPECT(isClose(p.segmentArray()[0]->position(), Vec2f(10, 20)));
-            EXPECT(isClose(p.segmentArray()[1]->position(), Vec2f(100, 20)));
-            EXPECT(isClose(p.segmentArray()[2]->position(), Vec2f(100, 120)));
+            EXPECT(isClose(p.segment(0).position(), Vec2f(10, 20)));
+            EXPECT(isClose(p.segment(1).position(), Vec2f(100, 20)));
+            EXPECT(isClose(p.segment(2).position(), Vec2f(100, 120)));
             EXPECT(p.isClosed());
         }
         {
@@ -424,6 +890,656 @@ const Suite spec[] =
         EXPECT(isecs6.count() == 2);
         EXPECT(crunch::isClose(isecs6[0].position, Vec2f(200, 100)));
         EXPECT(crunch::isClose(isecs6[1].position, Vec2f(150, 50)));
+
+        //many curves, only few of them overlap
+        Path zigZag = doc.createPath();
+        for (Size i = 0; i <= 100; ++i)
+            zigZag.addPoint(Vec2f(i * 10, i % 2 ? 10 : -10));
+        Path horizontal = doc.createPath();
+        horizontal.addPoint(Vec2f(-10, 0));
+        horizontal.addPoint(Vec2f(1010, 0));
+        auto isecs7 = zigZag.intersections(horizontal);
+        EXPECT(isecs7.count() == 100);
+        EXPECT(crunch::isClose(isecs7[0].position, Vec2f(5, 0)));
+        EXPECT(crunch::isClose(isecs7[99].position, Vec2f(995, 0)));
+
+        //the curves are intersected in the local space of each path, so transforms must not
+        //make the bounds check skip them
+        Path localA = doc.createRectangle(Vec2f(0, 0), Vec2f(10, 10));
+        Path localB = doc.createRectangle(Vec2f(5, 5), Vec2f(15, 15));
+        localB.translateTransform(100, 0);
+        EXPECT(localA.intersections(localB).count() == 2);
+        EXPECT(localA.intersections(doc.createRectangle(Vec2f(20, 0), Vec2f(30, 10))).count() == 0);
+    },
+    SUITE("Boolean Operation Tests")
+    {
+        Document doc = createDocument();
+        Path a = doc.createRectangle(Vec2f(0, 0), Vec2f(100, 100));
+        Path b = doc.createRectangle(Vec2f(50, 50), Vec2f(150, 150));
+        a.setFill(ColorRGBA(1, 0, 0, 1));
+
+        Path u = a.unite(b);
+        EXPECT(crunch::isClose(std::abs(u.area()), 17500.0f, 0.1f));
+        EXPECT(u.children().count() == 0);
+        EXPECT(u.contains(Vec2f(25, 25)));
+        EXPECT(u.contains(Vec2f(125, 125)));
+        EXPECT(!u.contains(Vec2f(125, 25)));
+        EXPECT(u.fill().get<ColorRGBA>() == ColorRGBA(1, 0, 0, 1));
+        //the result is inserted above the path it was created from
+        EXPECT(u.parent() == doc);
+        EXPECT(doc.children()[1] == u);
+
+        Path i = a.intersect(b);
+        EXPECT(crunch::isClose(std::abs(i.area()), 2500.0f, 0.1f));
+        EXPECT(i.contains(Vec2f(75, 75)));
+        EXPECT(!i.contains(Vec2f(25, 25)));
+
+        Path s = a.subtract(b);
+        EXPECT(crunch::isClose(std::abs(s.area()), 7500.0f, 0.1f));
+        EXPECT(s.contains(Vec2f(25, 25)));
+        EXPECT(!s.contains(Vec2f(75, 75)));
+
+        Path x = a.exclude(b);
+        EXPECT(crunch::isClose(std::abs(x.area()), 15000.0f, 0.1f));
+        EXPECT(x.contains(Vec2f(25, 25)));
+        EXPECT(x.contains(Vec2f(125, 125)));
+        EXPECT(!x.contains(Vec2f(75, 75)));
+
+        //subtracting a shape inside of the path results in a hole
+        Path circle = doc.createCircle(Vec2f(50, 50), 20);
+        Path hole = a.subtract(circle);
+        EXPECT(hole.children().count() == 1);
+        EXPECT(crunch::isClose(std::abs(hole.area()), 10000.0f - Constants<Float>::pi() * 400.0f, 1.0f));
+        EXPECT(!hole.contains(Vec2f(50, 50)));
+        EXPECT(hole.contains(Vec2f(10, 10)));
+
+        //curves crossing curves
+        Path lens = circle.intersect(doc.createCircle(Vec2f(70, 50), 20));
+        EXPECT(lens.contains(Vec2f(60, 50)));
+        EXPECT(!lens.contains(Vec2f(35, 50)));
+        EXPECT(!lens.contains(Vec2f(85, 50)));
+
+        //a crossing close to the end of a long curve stays where it is
+        Path small = doc.createCircle(Vec2f(50, 50), 12.310461f);
+        Path large = doc.createCircle(Vec2f(38.1908493f, 33.9232712f), 19.6084671f);
+        Float overlap = std::abs(small.intersect(large).area());
+        EXPECT(crunch::isClose(overlap, 198.2f, 1.0f));
+        Path merged = small.unite(large);
+        EXPECT(crunch::isClose(std::abs(merged.area()), std::abs(small.area()) + std::abs(large.area()) - overlap, 1.0f));
+        EXPECT(merged.contains(Vec2f(50, 50)));
+
+        //disjoint and touching shapes
+        Path far = doc.createRectangle(Vec2f(200, 0), Vec2f(300, 100));
+        Path both = a.unite(far);
+        EXPECT(both.children().count() == 1);
+        EXPECT(crunch::isClose(std::abs(both.area()), 20000.0f, 0.1f));
+        EXPECT(a.intersect(far).segmentCount() == 0);
+        Path next = doc.createRectangle(Vec2f(100, 0), Vec2f(200, 100));
+        Path joined = a.unite(next);
+        EXPECT(joined.children().count() == 0);
+        EXPECT(crunch::isClose(std::abs(joined.area()), 20000.0f, 0.1f));
+        EXPECT(joined.contains(Vec2f(100, 50)));
+        EXPECT(a.subtract(a.clone()).segmentCount() == 0);
+
+        //the operands are combined in the space of the first one
+        Path moved = doc.createRectangle(Vec2f(0, 0), Vec2f(100, 100));
+        moved.translateTransform(50, 50);
+        Path t = a.intersect(moved);
+        EXPECT(crunch::isClose(std::abs(t.area()), 2500.0f, 0.1f));
+        EXPECT(t.contains(Vec2f(75, 75)));
+
+        Group d = a.divide(b);
+        EXPECT(d.children().count() == 2);
+        EXPECT(crunch::isClose(std::abs(brick::reinterpretEntity<Path>(d.children()[0]).area()), 2500.0f, 0.1f));
+        EXPECT(crunch::isClose(std::abs(brick::reinterpretEntity<Path>(d.children()[1]).area()), 7500.0f, 0.1f));
+
+        //overlapping squares in a grid merge into one square, the ones of the
+        //second grid are transformed by their group.
+        Document doc2 = createDocument();
+        Group grid = doc2.createGroup();
+        Group moved2 = doc2.createGroup();
+        moved2.translateTransform(500, 0);
+        for (Size y = 0; y < 10; ++y)
+        {
+            for (Size x = 0; x < 10; ++x)
+            {
+                Vec2f pos(x * 10, y * 10);
+                grid.addChild(doc2.createRectangle(pos, pos + Vec2f(15, 15)));
+                moved2.addChild(doc2.createRectangle(pos, pos + Vec2f(15, 15)));
+            }
+        }
+        brick::reinterpretEntity<Path>(grid.children()[0]).setFill(ColorRGBA(0, 1, 0, 1));
+        Size childCount = doc2.children().count();
+
+        Path all = grid.uniteAll(4);
+        EXPECT(doc2.children().count() == childCount + 1);
+        EXPECT(all.children().count() == 0);
+        EXPECT(crunch::isClose(std::abs(all.area()), 105.0f * 105.0f, 1.0f));
+        EXPECT(all.contains(Vec2f(52, 52)));
+        EXPECT(!all.contains(Vec2f(106, 52)));
+        EXPECT(all.fill().get<ColorRGBA>() == ColorRGBA(0, 1, 0, 1));
+
+        ItemArray items;
+        items.append(grid);
+        items.append(moved2);
+        Path both2 = doc2.uniteAll(items, 2);
+        EXPECT(both2.children().count() == 1);
+        EXPECT(crunch::isClose(std::abs(both2.area()), 2.0f * 105.0f * 105.0f, 1.0f));
+        EXPECT(both2.contains(Vec2f(552, 52)));
+        EXPECT(!both2.contains(Vec2f(252, 52)));
+
+        //a ring of circles leaves a hole in the middle
+        Group ring = doc2.createGroup();
+        for (Size i = 0; i < 16; ++i)
+        {
+            Float a = Constants<Float>::twoPi() * i / 16;
+            ring.addChild(doc2.createCircle(Vec2f(std::cos(a), std::sin(a)) * 100.0f, 30.0f));
+        }
+        Path ringUnion = ring.uniteAll();
+        EXPECT(ringUnion.children().count() == 1);
+        EXPECT(!ringUnion.contains(Vec2f(0, 0)));
+        EXPECT(ringUnion.contains(Vec2f(100, 0)));
+        EXPECT(ringUnion.contains(Vec2f(std::cos(0.2f), std::sin(0.2f)) * 100.0f));
+
+        //without any paths nothing gets added to the document
+        Group empty = doc2.createGroup();
+        childCount = doc2.children().count();
+        EXPECT(!doc2.uniteAll(ItemArray()).isValid());
+        EXPECT(!empty.uniteAll().isValid());
+        EXPECT(doc2.children().count() == childCount);
+    },
+    SUITE("Stroke Outline Tests")
+    {
+        Document doc = createDocument();
+        Path line = doc.createPath();
+        line.addPoint(Vec2f(0, 0));
+        line.addPoint(Vec2f(100, 0));
+        line.setStroke(ColorRGBA(1, 0, 0, 1));
+        line.setStrokeWidth(10);
+        line.setStrokeCap(StrokeCap::Butt);
+
+        Path butt = line.strokeToPath();
+        EXPECT(butt.parent() == doc);
+        EXPECT(doc.children()[1] == butt);
+        EXPECT(butt.fill().get<ColorRGBA>() == ColorRGBA(1, 0, 0, 1));
+        EXPECT(!butt.hasStroke());
+        EXPECT(butt.windingRule() == WindingRule::NonZero);
+        EXPECT(crunch::isClose(std::abs(butt.area()), 1000.0f, 0.1f));
+        EXPECT(butt.contains(Vec2f(50, 4)));
+        EXPECT(!butt.contains(Vec2f(50, 6)));
+        EXPECT(!butt.contains(Vec2f(-2, 0)));
+
+        line.setStrokeCap(StrokeCap::Square);
+        Path square = line.strokeToPath();
+        EXPECT(crunch::isClose(std::abs(square.area()), 1100.0f, 0.1f));
+        EXPECT(square.contains(Vec2f(-4, 4)));
+        EXPECT(square.contains(Vec2f(104, -4)));
+
+        line.setStrokeCap(StrokeCap::Round);
+        Path round = line.strokeToPath();
+        EXPECT(crunch::isClose(std::abs(round.area()), 1000.0f + Constants<Float>::pi() * 25.0f, 0.5f));
+        EXPECT(round.contains(Vec2f(-4, 0)));
+        EXPECT(!round.contains(Vec2f(-4, 4)));
+
+        //dashes become separate loops, dashes without length become dots
+        line.setStrokeCap(StrokeCap::Butt);
+        DashArray dashes;
+        dashes.append(10);
+        dashes.append(10);
+        line.setDashArray(dashes);
+        Path dashed = line.strokeToPath();
+        EXPECT(dashed.children().count() == 4);
+        EXPECT(crunch::isClose(std::abs(dashed.area()), 500.0f, 0.1f));
+        EXPECT(dashed.contains(Vec2f(5, 0)));
+        EXPECT(!dashed.contains(Vec2f(15, 0)));
+        line.setDashOffset(5);
+        Path offsetDashed = line.strokeToPath();
+        EXPECT(offsetDashed.children().count() == 5);
+        EXPECT(offsetDashed.contains(Vec2f(2, 0)));
+        EXPECT(!offsetDashed.contains(Vec2f(7, 0)));
+        EXPECT(offsetDashed.contains(Vec2f(17, 0)));
+        dashes[0] = 0;
+        dashes[1] = 20;
+        line.setDashArray(dashes);
+        line.setDashOffset(0);
+        line.setStrokeCap(StrokeCap::Round);
+        Path dots = line.strokeToPath();
+        EXPECT(dots.children().count() == 5);
+        EXPECT(dots.contains(Vec2f(103, 0)));
+        EXPECT(dots.contains(Vec2f(20, 4)));
+        EXPECT(!dots.contains(Vec2f(10, 0)));
+
+        //closed paths have an outline on each side, the corners get joins
+        Path rect = doc.createRectangle(Vec2f(0, 0), Vec2f(100, 100));
+        rect.setStroke(ColorRGBA(0, 0, 1, 1));
+        rect.setStrokeWidth(10);
+        rect.setStrokeJoin(StrokeJoin::Miter);
+        Path miter = rect.strokeToPath();
+        EXPECT(miter.children().count() == 1);
+        EXPECT(miter.contains(Vec2f(50, 3)));
+        EXPECT(miter.contains(Vec2f(-4, -4)));
+        EXPECT(!miter.contains(Vec2f(50, 50)));
+        EXPECT(!miter.contains(Vec2f(50, 106)));
+        rect.setStrokeJoin(StrokeJoin::Bevel);
+        Path bevel = rect.strokeToPath();
+        EXPECT(!bevel.contains(Vec2f(-4, -4)));
+        EXPECT(bevel.contains(Vec2f(-1, -1)));
+        rect.setStrokeJoin(StrokeJoin::Round);
+        Path roundJoin = rect.strokeToPath();
+        EXPECT(roundJoin.contains(Vec2f(-3, -3)));
+        EXPECT(!roundJoin.contains(Vec2f(-4, -4)));
+
+        //curves are offset by curves instead of being flattened
+        Path circle = doc.createCircle(Vec2f(0, 0), 50);
+        circle.setStroke(ColorRGBA(0, 0, 1, 1));
+        circle.setStrokeWidth(10);
+        Path ring = circle.strokeToPath();
+        EXPECT(ring.children().count() == 1);
+        EXPECT(ring.segmentCount() < 20);
+        EXPECT(ring.contains(Vec2f(0, 54)));
+        EXPECT(ring.contains(Vec2f(std::cos(0.3f), std::sin(0.3f)) * 46.0f));
+        EXPECT(!ring.contains(Vec2f(0, 0)));
+        EXPECT(!ring.contains(Vec2f(std::cos(0.3f), std::sin(0.3f)) * 56.0f));
+
+        //the width of non scaling strokes is in document space
+        Path scaled = doc.createPath();
+        scaled.addPoint(Vec2f(0, 0));
+        scaled.addPoint(Vec2f(100, 0));
+        scaled.setStroke(ColorRGBA(1, 0, 0, 1));
+        scaled.setStrokeWidth(10);
+        scaled.scaleTransform(2);
+        EXPECT(scaled.strokeToPath().contains(Vec2f(100, 9)));
+        scaled.setStrokeScaling(false);
+        Path notScaled = scaled.strokeToPath();
+        EXPECT(notScaled.contains(Vec2f(100, 4)));
+        EXPECT(!notScaled.contains(Vec2f(100, 6)));
+
+        Path noStroke = doc.createRectangle(Vec2f(0, 0), Vec2f(100, 100));
+        noStroke.setNoStroke();
+        EXPECT(noStroke.strokeToPath().segmentCount() == 0);
+    },
+    SUITE("Raster Renderer Tests")
+    {
+        Document doc = createDocument();
+        Path rect = doc.createRectangle(Vec2f(10.0f, 10.5f), Vec2f(40.0f, 40.0f));
+        rect.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+
+        Path evenOdd = doc.createRectangle(Vec2f(50.0f, 10.0f), Vec2f(90.0f, 50.0f));
+        evenOdd.addChild(doc.createRectangle(Vec2f(60.0f, 20.0f), Vec2f(80.0f, 40.0f)));
+        evenOdd.setFill(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+
+        Path nonZero = doc.createRectangle(Vec2f(10.0f, 50.0f), Vec2f(40.0f, 80.0f));
+        nonZero.addChild(doc.createRectangle(Vec2f(20.0f, 60.0f), Vec2f(30.0f, 70.0f)));
+        nonZero.setWindingRule(WindingRule::NonZero);
+        nonZero.setFill(ColorRGBA(0.0f, 0.0f, 1.0f, 0.5f));
+
+        ColorStopArray stops;
+        stops.append({ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f), 0.0f});
+        stops.append({ColorRGBA(0.0f, 0.0f, 1.0f, 1.0f), 1.0f});
+        Path grad = doc.createRectangle(Vec2f(0.0f, 90.0f), Vec2f(100.0f, 100.0f));
+        grad.setFill(doc.createLinearGradient(Vec2f(0.0f, 0.0f), Vec2f(100.0f, 0.0f), stops));
+
+        Path radial = doc.createRectangle(Vec2f(0.0f, 0.0f), Vec2f(8.0f, 8.0f));
+        radial.translateTransform(91.0f, 1.0f);
+        radial.setFill(doc.createRadialGradient(Vec2f(3.5f, 3.5f), Vec2f(7.5f, 3.5f), stops));
+
+        Path line = doc.createPath();
+        line.addPoint(Vec2f(50.0f, 85.0f));
+        line.addPoint(Vec2f(90.0f, 85.0f));
+        line.setStroke(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+        line.setStrokeWidth(4.0f);
+
+        Group clipGroup = doc.createGroup();
+        clipGroup.addChild(doc.createRectangle(Vec2f(50.0f, 60.0f), Vec2f(70.0f, 80.0f)));
+        Path clipped = doc.createRectangle(Vec2f(40.0f, 55.0f), Vec2f(100.0f, 80.0f));
+        clipped.setFill(ColorRGBA(1.0f, 1.0f, 0.0f, 1.0f));
+        clipGroup.addChild(clipped);
+        clipGroup.setClipped(true);
+
+        raster::RasterRenderer renderer;
+        EXPECT(!renderer.init(doc));
+        EXPECT(renderer.draw());
+        renderer.setViewport(0, 0, 100, 100);
+        renderer.setProjection(Mat4f::ortho(0, 100, 100, 0, -1, 1));
+        renderer.setClearColor(ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+        EXPECT(!renderer.draw());
+        EXPECT(renderer.width() == 100 && renderer.height() == 100);
+
+        auto pixel = [&](Size _x, Size _y)
+        {
+            const UInt8 * p = renderer.pixels() + (_y * 100 + _x) * 4;
+            return ColorRGBA(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f);
+        };
+
+        auto isPixel = [&](Size _x, Size _y, const ColorRGBA & _expected, Float _tolerance)
+        {
+            ColorRGBA c = pixel(_x, _y);
+            return std::abs(c.r - _expected.r) <= _tolerance && std::abs(c.g - _expected.g) <= _tolerance &&
+                   std::abs(c.b - _expected.b) <= _tolerance && std::abs(c.a - _expected.a) <= _tolerance;
+        };
+
+        EXPECT(isPixel(25, 25, ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(5, 5, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f), 0.005f));
+        // the radial gradient is centered in pixel (94, 4) with a radius of 4
+        EXPECT(isPixel(94, 4, ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(96, 4, ColorRGBA(0.5f, 0.0f, 0.5f, 1.0f), 0.01f));
+        EXPECT(isPixel(91, 1, ColorRGBA(0.0f, 0.0f, 1.0f, 1.0f), 0.005f));
+        // the top edge of the rectangle covers half of the pixel row
+        EXPECT(isPixel(25, 10, ColorRGBA(1.0f, 0.5f, 0.5f, 1.0f), 0.01f));
+
+        EXPECT(isPixel(55, 15, ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(70, 30, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(15, 55, ColorRGBA(0.5f, 0.5f, 1.0f, 1.0f), 0.01f));
+        EXPECT(isPixel(25, 65, ColorRGBA(0.5f, 0.5f, 1.0f, 1.0f), 0.01f));
+
+        ColorRGBA left = pixel(2, 95);
+        ColorRGBA right = pixel(97, 95);
+        EXPECT(left.r > 0.9f && left.b < 0.1f);
+        EXPECT(right.b > 0.9f && right.r < 0.1f);
+        EXPECT(isPixel(50, 95, ColorRGBA(0.5f, 0.0f, 0.5f, 1.0f), 0.02f));
+
+        EXPECT(isPixel(70, 85, ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(70, 88, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f), 0.005f));
+
+        EXPECT(isPixel(60, 70, ColorRGBA(1.0f, 1.0f, 0.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(45, 70, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f), 0.005f));
+        EXPECT(isPixel(80, 70, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f), 0.005f));
+    },
+    SUITE("Tiled Raster Renderer Tests")
+    {
+        // a viewport that is not a multiple of the tile size, with shapes and clipping across tile borders
+        Document doc = createDocument();
+        Path rect = doc.createRectangle(Vec2f(20.0f, 20.0f), Vec2f(250.0f, 150.0f));
+        rect.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+
+        Path circle = doc.createCircle(Vec2f(150.0f, 100.0f), 70.0f);
+        circle.setFill(ColorRGBA(0.0f, 0.0f, 1.0f, 0.5f));
+        circle.setStroke(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+        circle.setStrokeWidth(3.0f);
+
+        Group clipGroup = doc.createGroup();
+        clipGroup.addChild(doc.createCircle(Vec2f(260.0f, 170.0f), 40.0f));
+        Path clipped = doc.createRectangle(Vec2f(200.0f, 100.0f), Vec2f(300.0f, 200.0f));
+        clipped.setFill(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+        clipGroup.addChild(clipped);
+        clipGroup.setClipped(true);
+
+        raster::RasterRenderer single;
+        single.init(doc);
+        single.setViewport(0, 0, 301, 203);
+        single.setThreadCount(1);
+        EXPECT(!single.draw());
+
+        raster::RasterRenderer multi;
+        multi.init(doc);
+        multi.setViewport(0, 0, 301, 203);
+        multi.setThreadCount(4);
+        EXPECT(!multi.draw());
+        // drawing again reuses the tiles and the threads
+        EXPECT(!multi.draw());
+
+        Size byteCount = 301 * 203 * 4;
+        EXPECT(std::equal(single.pixels(), single.pixels() + byteCount, multi.pixels()));
+
+        auto pixel = [&](Size _x, Size _y)
+        {
+            const UInt8 * p = multi.pixels() + (_y * 301 + _x) * 4;
+            return ColorRGBA(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f);
+        };
+
+        // the pixels on both sides of tile borders
+        EXPECT(pixel(30, 31) == ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        EXPECT(pixel(30, 32) == ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        EXPECT(pixel(30, 63) == ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        EXPECT(pixel(30, 64) == ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+        EXPECT(pixel(150, 100).b > 0.45f && pixel(150, 100).r > 0.45f);
+        EXPECT(pixel(260, 170) == ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+        EXPECT(pixel(300, 202) == ColorRGBA(0.0f, 0.0f, 0.0f, 0.0f));
+        EXPECT(pixel(296, 196).a == 0.0f);
+
+        multi.setClearColor(ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+        EXPECT(!multi.draw());
+        EXPECT(pixel(300, 202) == ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+    },
+    SUITE("Viewport Culling Tests")
+    {
+        Document doc = createDocument();
+        Path visible = doc.createRectangle(Vec2f(10.0f, 10.0f), Vec2f(40.0f, 40.0f));
+        visible.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+
+        // partially visible paths are drawn
+        Path partial = doc.createRectangle(Vec2f(90.0f, 10.0f), Vec2f(140.0f, 40.0f));
+        partial.setFill(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+
+        for (Size i = 0; i < 10; ++i)
+        {
+            Path p = doc.createRectangle(Vec2f(200.0f + i * 20.0f, 10.0f), Vec2f(210.0f + i * 20.0f, 20.0f));
+            p.setFill(ColorRGBA(0.0f, 0.0f, 1.0f, 1.0f));
+        }
+
+        // a thick stroke reaches into the viewport even though the path does not
+        Path stroked = doc.createPath();
+        stroked.addPoint(Vec2f(-5.0f, 50.0f));
+        stroked.addPoint(Vec2f(-5.0f, 60.0f));
+        stroked.setStroke(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+        stroked.setStrokeWidth(20.0f);
+
+        // the whole group is culled as one
+        Group outside = doc.createGroup();
+        for (Size i = 0; i < 5; ++i)
+            outside.addChild(doc.createRectangle(Vec2f(10.0f + i * 10.0f, 300.0f), Vec2f(15.0f + i * 10.0f, 305.0f)));
+
+        // only the invisible child of this group is culled
+        Group mixed = doc.createGroup();
+        mixed.addChild(doc.createRectangle(Vec2f(50.0f, 50.0f), Vec2f(60.0f, 60.0f)));
+        mixed.addChild(doc.createRectangle(Vec2f(-50.0f, 50.0f), Vec2f(-40.0f, 60.0f)));
+
+        Symbol s = doc.createSymbol(doc.createCircle(Vec2f(0.0f, 0.0f), 5.0f));
+        PlacedSymbol inside = s.place(Vec2f(70.0f, 70.0f));
+        PlacedSymbol far = s.place(Vec2f(500.0f, 500.0f));
+
+        raster::RasterRenderer renderer;
+        renderer.init(doc);
+        renderer.setViewport(0, 0, 100, 100);
+        renderer.setProjection(Mat4f::ortho(0, 100, 100, 0, -1, 1));
+        EXPECT(!renderer.draw());
+        EXPECT(renderer.culledItemCount() == 13);
+        EXPECT(renderer.drawnPathCount() == 5);
+        EXPECT(renderer.pixels()[(25 * 100 + 25) * 4] == 255);
+        EXPECT(renderer.pixels()[(25 * 100 + 95) * 4 + 1] == 255);
+        EXPECT(renderer.pixels()[(55 * 100 + 2) * 4 + 3] == 255);
+
+        // zooming in culls more, the counters only cover the last frame
+        renderer.setProjection(Mat4f::ortho(0, 50, 50, 0, -1, 1));
+        EXPECT(!renderer.draw());
+        EXPECT(renderer.culledItemCount() == 15);
+        EXPECT(renderer.drawnPathCount() == 3);
+
+        // moving an item updates its cached bounds
+        visible.translateTransform(Vec2f(500.0f, 0.0f));
+        EXPECT(!renderer.draw());
+        EXPECT(renderer.culledItemCount() == 16);
+        EXPECT(renderer.drawnPathCount() == 2);
+    },
+    SUITE("Display List Tests")
+    {
+        Document doc = createDocument();
+        Path rect = doc.createRectangle(Vec2f(10.0f, 10.0f), Vec2f(40.0f, 40.0f));
+        rect.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+
+        // children inherit the style of the group
+        Group grp = doc.createGroup();
+        grp.setStroke(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f));
+        grp.setStrokeWidth(4.0f);
+        Path circle = doc.createCircle(Vec2f(70.0f, 30.0f), 15.0f);
+        grp.addChild(circle);
+
+        Group clipGroup = doc.createGroup();
+        clipGroup.addChild(doc.createCircle(Vec2f(30.0f, 70.0f), 20.0f));
+        Path clipped = doc.createRectangle(Vec2f(0.0f, 50.0f), Vec2f(60.0f, 100.0f));
+        clipped.setFill(ColorRGBA(0.0f, 1.0f, 0.0f, 1.0f));
+        clipGroup.addChild(clipped);
+        clipGroup.setClipped(true);
+
+        Path triangle = doc.createPath();
+        triangle.addPoint(Vec2f(60.0f, 60.0f));
+        triangle.setFill(ColorRGBA(0.0f, 0.0f, 1.0f, 1.0f));
+
+        DisplayList list;
+        list.record(doc);
+        EXPECT(list.recordCount() == 1);
+        EXPECT(list.commands().count() == 6);
+        EXPECT(list.commands()[2].type == DisplayList::CommandType::BeginClipping);
+        EXPECT(list.commands()[2].scopeEnd == 4);
+        EXPECT(list.commands()[1].style.strokeWidth == 4.0f);
+        EXPECT(!list.commands()[5].bDrawable);
+
+        raster::RasterRenderer traversed;
+        traversed.init(doc);
+        traversed.setViewport(0, 0, 100, 100);
+        raster::RasterRenderer replayed;
+        replayed.init(doc);
+        replayed.setViewport(0, 0, 100, 100);
+
+        Size byteCount = 100 * 100 * 4;
+        auto drawBoth = [&]()
+        {
+            list.update();
+            bool bOk = !traversed.draw() && !replayed.draw(list);
+            return bOk && traversed.drawnPathCount() == replayed.drawnPathCount() &&
+                   std::equal(traversed.pixels(), traversed.pixels() + byteCount, replayed.pixels());
+        };
+        EXPECT(drawBoth());
+        EXPECT(replayed.drawnPathCount() == 3);
+
+        // style, transform and geometry changes are patched into the list
+        grp.setStroke(ColorRGBA(1.0f, 0.0f, 1.0f, 1.0f));
+        rect.translateTransform(Vec2f(5.0f, 5.0f));
+        triangle.addPoint(Vec2f(90.0f, 60.0f));
+        triangle.addPoint(Vec2f(75.0f, 90.0f));
+        Item mask = clipGroup.children().first();
+        mask.translateTransform(Vec2f(10.0f, 0.0f));
+        EXPECT(drawBoth());
+        EXPECT(list.recordCount() == 1);
+        EXPECT(replayed.drawnPathCount() == 4);
+        EXPECT(list.commands()[1].style.stroke.get<ColorRGBA>() == ColorRGBA(1.0f, 0.0f, 1.0f, 1.0f));
+        EXPECT(replayed.pixels()[(70 * 100 + 75) * 4 + 2] == 255);
+
+        // hierarchy changes record the list again
+        Path added = doc.createRectangle(Vec2f(80.0f, 80.0f), Vec2f(95.0f, 95.0f));
+        added.setFill(ColorRGBA(1.0f, 1.0f, 0.0f, 1.0f));
+        EXPECT(drawBoth());
+        EXPECT(list.recordCount() == 2);
+        EXPECT(list.commands().count() == 7);
+
+        grp.setVisible(false);
+        EXPECT(drawBoth());
+        EXPECT(list.recordCount() == 3);
+        EXPECT(list.commands().count() == 6);
+
+        // symbol contents are not tracked, changing them records the list again
+        Path symbolPath = doc.createCircle(Vec2f(0.0f, 0.0f), 5.0f);
+        symbolPath.setFill(ColorRGBA(0.0f, 1.0f, 1.0f, 1.0f));
+        Symbol s = doc.createSymbol(symbolPath);
+        s.place(Vec2f(50.0f, 10.0f));
+        s.place(Vec2f(250.0f, 10.0f));
+        EXPECT(drawBoth());
+        Size recordCount = list.recordCount();
+        symbolPath.setFill(ColorRGBA(0.5f, 0.5f, 0.5f, 1.0f));
+        EXPECT(drawBoth());
+        EXPECT(list.recordCount() == recordCount + 1);
+
+        // replayed lists are culled per command
+        EXPECT(replayed.culledItemCount() == 1);
+
+        // a list can be replayed on a different thread
+        raster::RasterRenderer threaded;
+        threaded.init(doc);
+        threaded.setViewport(0, 0, 100, 100);
+        bool bThreadOk = false;
+        std::thread t([&]() { bThreadOk = !threaded.draw(list); });
+        t.join();
+        EXPECT(bThreadOk);
+        EXPECT(std::equal(traversed.pixels(), traversed.pixels() + byteCount, threaded.pixels()));
+
+        // removing items and destroying lists keeps the document consistent
+        {
+            DisplayList other;
+            other.record(doc);
+            added.remove();
+            other.update();
+            EXPECT(other.commands().count() == list.commands().count() - 1);
+        }
+        EXPECT(drawBoth());
+
+        // batched edits are journaled once per item and reach the list when the batch ends
+        recordCount = list.recordCount();
+        {
+            DocumentBatch batch(doc);
+            for (Size i = 0; i < 10; ++i)
+                rect.translateTransform(Vec2f(1.0f, 0.0f));
+            doc.beginBatch();
+            triangle.setFill(ColorRGBA(1.0f, 0.0f, 0.0f, 1.0f));
+            EXPECT(doc.endBatch().count() == 0);
+
+            // queries of the document see the changes right away
+            EXPECT(doc.hitTest(Vec2f(50.0f, 20.0f)) == rect);
+
+            ItemChangeArray changes = batch.end();
+            EXPECT(changes.count() == 2);
+            EXPECT(changes[0].item == rect);
+            EXPECT(changes[0].flags == (ItemChange::Transform | ItemChange::Bounds));
+            EXPECT(changes[1].item == triangle);
+            EXPECT(changes[1].flags == ItemChange::Style);
+        }
+        EXPECT(drawBoth());
+        EXPECT(list.recordCount() == recordCount);
+
+        // the hierarchy changes of a batch record the list once
+        {
+            DocumentBatch batch(doc);
+            for (Size i = 0; i < 10; ++i)
+                doc.createRectangle(Vec2f(i * 10.0f, 0.0f), Vec2f(i * 10.0f + 5.0f, 5.0f));
+            triangle.remove();
+        }
+        EXPECT(drawBoth());
+        EXPECT(list.recordCount() == recordCount + 1);
+    },
+    SUITE("Thread Pool Tests")
+    {
+        paper::detail::ThreadPool pool(4);
+        EXPECT(pool.threadCount() == 4);
+
+        // uneven work per index, every index has to be processed exactly once
+        DynamicArray<Size> counts;
+        DynamicArray<Size> workers;
+        counts.resize(1000);
+        workers.resize(1000);
+        for (auto & c : counts)
+            c = 0;
+        pool.parallelFor(counts.count(), [&](Size _index, Size _worker)
+        {
+            volatile Size spin = 0;
+            for (Size i = 0; i < (_index % 10) * 1000; ++i)
+                spin = spin + 1;
+            counts[_index] += 1;
+            workers[_index] = _worker;
+        });
+
+        bool bAllOnce = true;
+        bool bValidWorkers = true;
+        for (Size i = 0; i < counts.count(); ++i)
+        {
+            bAllOnce = bAllOnce && counts[i] == 1;
+            bValidWorkers = bValidWorkers && workers[i] < 4;
+        }
+        EXPECT(bAllOnce);
+        EXPECT(bValidWorkers);
+
+        Size calls = 0;
+        pool.parallelFor(1, [&](Size _index, Size _worker) { ++calls; });
+        pool.parallelFor(0, [&](Size _index, Size _worker) { ++calls; });
+        EXPECT(calls == 1);
     }
 };
 